@@ -0,0 +1,159 @@
+// Bvh.cpp
+#include "Bvh.h"
+#include <algorithm>
+
+void TriangleBvh::Build(const Vec3* positions, const uint32_t* indices, uint32_t triangleCount)
+{
+    mNodes.clear();
+    mOrder.resize(triangleCount);
+    mV0.resize(triangleCount);
+    mE1.resize(triangleCount);
+    mE2.resize(triangleCount);
+
+    std::vector<Vec3> centroids(triangleCount);
+    for (uint32_t t = 0; t < triangleCount; ++t)
+    {
+        const Vec3& a = positions[indices[t * 3 + 0]];
+        const Vec3& b = positions[indices[t * 3 + 1]];
+        const Vec3& c = positions[indices[t * 3 + 2]];
+
+        mV0[t] = a;
+        mE1[t] = b - a;
+        mE2[t] = c - a;
+        centroids[t] = (a + b + c) * (1.0f / 3.0f);
+        mOrder[t] = t;
+    }
+
+    if (triangleCount == 0)
+        return;
+
+    mNodes.reserve(triangleCount * 2 / LeafSize + 1);
+    BuildRecursive(0, triangleCount, centroids);
+}
+
+uint32_t TriangleBvh::BuildRecursive(uint32_t begin, uint32_t end, const std::vector<Vec3>& centroids)
+{
+    uint32_t index = (uint32_t)mNodes.size();
+    mNodes.push_back({});
+
+    Aabb box = Aabb::Empty();
+    Aabb centroidBox = Aabb::Empty();
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        uint32_t t = mOrder[i];
+        box.Grow(mV0[t]);
+        box.Grow(mV0[t] + mE1[t]);
+        box.Grow(mV0[t] + mE2[t]);
+        centroidBox.Grow(centroids[t]);
+    }
+    mNodes[index].Box = box;
+
+    if (end - begin <= LeafSize)
+    {
+        mNodes[index].First = begin;
+        mNodes[index].Count = end - begin;
+        return index;
+    }
+
+    Vec3 ext = centroidBox.Max - centroidBox.Min;
+    int axis = (ext.x >= ext.y && ext.x >= ext.z) ? 0 : (ext.y >= ext.z ? 1 : 2);
+    auto key = [&](uint32_t t)
+        {
+            const Vec3& c = centroids[t];
+            return axis == 0 ? c.x : (axis == 1 ? c.y : c.z);
+        };
+
+    uint32_t mid = begin + (end - begin) / 2;
+    std::nth_element(mOrder.begin() + begin, mOrder.begin() + mid, mOrder.begin() + end,
+        [&](uint32_t a, uint32_t b)
+        {
+            float ka = key(a), kb = key(b);
+            return ka < kb || (ka == kb && a < b);
+        });
+
+    BuildRecursive(begin, mid, centroids);
+    uint32_t right = BuildRecursive(mid, end, centroids);
+
+    mNodes[index].First = right;
+    mNodes[index].Count = 0;
+    return index;
+}
+
+static bool RayBox(const Aabb& b, const Vec3& o, const Vec3& invDir, float tMax)
+{
+    float tx0 = (b.Min.x - o.x) * invDir.x, tx1 = (b.Max.x - o.x) * invDir.x;
+    float ty0 = (b.Min.y - o.y) * invDir.y, ty1 = (b.Max.y - o.y) * invDir.y;
+    float tz0 = (b.Min.z - o.z) * invDir.z, tz1 = (b.Max.z - o.z) * invDir.z;
+
+    float tNear = (std::max)((std::max)((std::min)(tx0, tx1), (std::min)(ty0, ty1)), (std::min)(tz0, tz1));
+    float tFar  = (std::min)((std::min)((std::max)(tx0, tx1), (std::max)(ty0, ty1)), (std::max)(tz0, tz1));
+
+    return tNear <= tFar && tFar >= 0.0f && tNear <= tMax;
+}
+
+bool TriangleBvh::Intersect(const Vec3& origin, const Vec3& dir, float tMax, RayHit& hit) const
+{
+    if (mNodes.empty())
+        return false;
+
+    const float big = 1e30f;
+    Vec3 invDir = {
+        dir.x != 0.0f ? 1.0f / dir.x : big,
+        dir.y != 0.0f ? 1.0f / dir.y : big,
+        dir.z != 0.0f ? 1.0f / dir.z : big };
+
+    bool found = false;
+    float closest = tMax;
+
+    uint32_t stack[64];
+    uint32_t sp = 0;
+    stack[sp++] = 0;
+
+    while (sp > 0)
+    {
+        const Node& n = mNodes[stack[--sp]];
+        if (!RayBox(n.Box, origin, invDir, closest))
+            continue;
+
+        if (n.Count == 0)
+        {
+            uint32_t self = (uint32_t)(&n - mNodes.data());
+            stack[sp++] = n.First;
+            stack[sp++] = self + 1;
+            continue;
+        }
+
+        for (uint32_t i = n.First; i < n.First + n.Count; ++i)
+        {
+            // Moller-Trumbore, both faces
+            uint32_t t = mOrder[i];
+            Vec3 p = Cross(dir, mE2[t]);
+            float det = Dot(mE1[t], p);
+            if (std::fabs(det) < 1e-12f)
+                continue;
+
+            float invDet = 1.0f / det;
+            Vec3 s = origin - mV0[t];
+            float u = Dot(s, p) * invDet;
+            if (u < 0.0f || u > 1.0f)
+                continue;
+
+            Vec3 q = Cross(s, mE1[t]);
+            float v = Dot(dir, q) * invDet;
+            if (v < 0.0f || u + v > 1.0f)
+                continue;
+
+            float dist = Dot(mE2[t], q) * invDet;
+            if (dist > 1e-4f && dist < closest)
+            {
+                closest = dist;
+                hit.T = dist;
+                hit.Triangle = t;
+                hit.BackFace = Dot(Cross(mE1[t], mE2[t]), dir) > 0.0f;
+                found = true;
+            }
+        }
+    }
+
+    return found;
+}
@@ -0,0 +1,46 @@
+// Bvh.h
+#pragma once
+#include "SceneMath.h"
+#include <vector>
+
+struct RayHit
+{
+    float    T;
+    uint32_t Triangle;
+    bool     BackFace; // ray travels along the triangle's geometric normal
+};
+
+// Static triangle BVH for offline ray queries. Build splits at the centroid
+// median of the widest axis with ties broken by triangle index, so the
+// tree is identical on every run and platform.
+class TriangleBvh
+{
+public:
+    void Build(const Vec3* positions, const uint32_t* indices, uint32_t triangleCount);
+
+    bool Intersect(const Vec3& origin, const Vec3& dir, float tMax, RayHit& hit) const;
+
+    const Aabb& Bounds() const { return mNodes.empty() ? mEmpty : mNodes[0].Box; }
+    uint32_t    TriangleCount() const { return (uint32_t)mV0.size(); }
+
+private:
+    struct Node
+    {
+        Aabb     Box;
+        uint32_t First;  // leaf: first entry in mOrder, inner: right child
+        uint32_t Count;  // 0 for inner nodes; left child is the next node
+    };
+
+    uint32_t BuildRecursive(uint32_t begin, uint32_t end, const std::vector<Vec3>& centroids);
+
+private:
+    static const uint32_t LeafSize = 4;
+
+    std::vector<Node>     mNodes;
+    std::vector<uint32_t> mOrder;
+
+    // Triangles stored as v0 + edges for the intersection test
+    std::vector<Vec3> mV0, mE1, mE2;
+
+    Aabb mEmpty = {};
+};
@@ -0,0 +1,268 @@
+// ClusteredLighting.cpp
+#include "ClusteredLighting.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <chrono>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define CLUSTER_USE_SSE 1
+#endif
+
+static const uint32_t NoSlices = 0xFFFFFFFFu;
+
+void LightClusterer::SetGrid(const ClusterGridSettings& grid)
+{
+    mGrid = grid;
+    mBoundsDirty = true;
+}
+
+void LightClusterer::SetProjection(float fovY, float aspect, float nearZ, float farZ)
+{
+    mTanY = std::tan(fovY * 0.5f);
+    mTanX = mTanY * aspect;
+    mNearZ = nearZ;
+    mFarZ = farZ;
+    mBoundsDirty = true;
+}
+
+float LightClusterer::SliceDepth(uint32_t z) const
+{
+    return mNearZ * std::pow(mFarZ / mNearZ, (float)z / (float)mGrid.SlicesZ);
+}
+
+void LightClusterer::BuildClusterBounds()
+{
+    const uint32_t rows = mGrid.TilesY * mGrid.SlicesZ;
+    mRowStride = (mGrid.TilesX + 3u) & ~3u;
+
+    const size_t size = (size_t)rows * mRowStride;
+    mMinX.assign(size, 3.4e38f); mMinY.assign(size, 3.4e38f); mMinZ.assign(size, 3.4e38f);
+    mMaxX.assign(size, -3.4e38f); mMaxY.assign(size, -3.4e38f); mMaxZ.assign(size, -3.4e38f);
+
+    for (uint32_t z = 0; z < mGrid.SlicesZ; ++z)
+    {
+        const float zn = SliceDepth(z);
+        const float zf = SliceDepth(z + 1);
+
+        for (uint32_t y = 0; y < mGrid.TilesY; ++y)
+        {
+            const float y0 = (-1.0f + 2.0f * y / mGrid.TilesY) * mTanY;
+            const float y1 = (-1.0f + 2.0f * (y + 1) / mGrid.TilesY) * mTanY;
+
+            for (uint32_t x = 0; x < mGrid.TilesX; ++x)
+            {
+                const float x0 = (-1.0f + 2.0f * x / mGrid.TilesX) * mTanX;
+                const float x1 = (-1.0f + 2.0f * (x + 1) / mGrid.TilesX) * mTanX;
+
+                size_t i = (size_t)(z * mGrid.TilesY + y) * mRowStride + x;
+                mMinX[i] = (std::min)(x0 * zn, x0 * zf);
+                mMaxX[i] = (std::max)(x1 * zn, x1 * zf);
+                mMinY[i] = (std::min)(y0 * zn, y0 * zf);
+                mMaxY[i] = (std::max)(y1 * zn, y1 * zf);
+                mMinZ[i] = zn;
+                mMaxZ[i] = zf;
+            }
+        }
+    }
+
+    mClusterLists.resize(ClusterCount());
+    mBoundsDirty = false;
+}
+
+void LightClusterer::Build(const Mat4& view, const SceneLight* lights, uint32_t count)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    if (mBoundsDirty)
+        BuildClusterBounds();
+
+    mViewLights.resize(count);
+    mLightSliceRange.resize(count);
+
+    const float logDepth = 1.0f / std::log(mFarZ / mNearZ);
+    auto sliceOf = [&](float d)
+        {
+            if (d <= mNearZ) return 0u;
+            float s = std::log(d / mNearZ) * logDepth * (float)mGrid.SlicesZ;
+            return (std::min)((uint32_t)s, mGrid.SlicesZ - 1);
+        };
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        SceneLight l = lights[i];
+        l.Position = TransformPoint(l.Position, view);
+        l.Direction = {
+            l.Direction.x * view.m[0][0] + l.Direction.y * view.m[1][0] + l.Direction.z * view.m[2][0],
+            l.Direction.x * view.m[0][1] + l.Direction.y * view.m[1][1] + l.Direction.z * view.m[2][1],
+            l.Direction.x * view.m[0][2] + l.Direction.y * view.m[1][2] + l.Direction.z * view.m[2][2] };
+        mViewLights[i] = l;
+
+        float zMin = l.Position.z - l.Range;
+        float zMax = l.Position.z + l.Range;
+        if (zMax < mNearZ || zMin > mFarZ)
+            mLightSliceRange[i] = NoSlices;
+        else
+            mLightSliceRange[i] = sliceOf(zMin) | (sliceOf(zMax) << 16);
+    }
+
+    ParallelFor(mGrid.SlicesZ, 1, [&](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t z = begin; z < end; ++z)
+                BinSlice(z);
+        });
+
+    // Compact into one upload-ready index list, cluster order, light order within a cluster.
+    const uint32_t clusters = ClusterCount();
+    mRanges.resize(clusters);
+
+    uint32_t total = 0;
+    uint32_t maxCount = 0;
+    for (uint32_t c = 0; c < clusters; ++c)
+    {
+        uint32_t n = (uint32_t)mClusterLists[c].size();
+        mRanges[c] = { total, n };
+        total += n;
+        maxCount = (std::max)(maxCount, n);
+    }
+
+    mIndices.resize(total);
+    for (uint32_t c = 0; c < clusters; ++c)
+    {
+        if (!mClusterLists[c].empty())
+            memcpy(&mIndices[mRanges[c].Offset], mClusterLists[c].data(), mClusterLists[c].size() * sizeof(uint32_t));
+    }
+
+    mStats.Lights = count;
+    mStats.References = total;
+    mStats.MaxPerCluster = maxCount;
+    mStats.BuildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void LightClusterer::BinSlice(uint32_t z)
+{
+    const uint32_t tx = mGrid.TilesX;
+    const uint32_t ty = mGrid.TilesY;
+    const float zn = SliceDepth(z);
+    const float zf = SliceDepth(z + 1);
+
+    for (uint32_t y = 0; y < ty; ++y)
+    {
+        for (uint32_t x = 0; x < tx; ++x)
+            mClusterLists[(z * ty + y) * tx + x].clear();
+    }
+
+    const uint32_t count = (uint32_t)mViewLights.size();
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t range = mLightSliceRange[i];
+        if (range == NoSlices || z < (range & 0xFFFF) || z > (range >> 16))
+            continue;
+
+        const SceneLight& l = mViewLights[i];
+        const Vec3 c = l.Position;
+        const float r = l.Range;
+
+        // Tile rectangle covered by the sphere over this slice's depth range.
+        float dLo = (std::max)(zn, c.z - r);
+        float dHi = (std::min)(zf, c.z + r);
+        if (dLo > dHi)
+            continue;
+
+        auto tileRange = [](float lo, float hi, float dA, float dB, float tanHalf, uint32_t tiles, uint32_t& t0, uint32_t& t1)
+            {
+                float nMin = (std::min)(lo / (dA * tanHalf), lo / (dB * tanHalf));
+                float nMax = (std::max)(hi / (dA * tanHalf), hi / (dB * tanHalf));
+                float f0 = std::floor((nMin + 1.0f) * 0.5f * tiles);
+                float f1 = std::floor((nMax + 1.0f) * 0.5f * tiles);
+                if (f1 < 0.0f || f0 >= (float)tiles)
+                    return false;
+                t0 = (uint32_t)(std::max)(f0, 0.0f);
+                t1 = (uint32_t)(std::min)(f1, (float)(tiles - 1));
+                return true;
+            };
+
+        uint32_t x0, x1, y0, y1;
+        if (!tileRange(c.x - r, c.x + r, dLo, dHi, mTanX, tx, x0, x1) ||
+            !tileRange(c.y - r, c.y + r, dLo, dHi, mTanY, ty, y0, y1))
+            continue;
+
+        const bool spot = l.Type == LightType::Spot;
+        const float cosA = std::cos(l.SpotAngle);
+        const float sinA = std::sin(l.SpotAngle);
+
+        for (uint32_t y = y0; y <= y1; ++y)
+        {
+            const size_t row = (size_t)(z * ty + y) * mRowStride;
+            std::vector<uint32_t>* lists = &mClusterLists[(z * ty + y) * tx];
+
+            for (uint32_t xb = x0 & ~3u; xb <= x1; xb += 4)
+            {
+                const size_t b = row + xb;
+                int mask;
+#if CLUSTER_USE_SSE
+                const __m128 zero = _mm_setzero_ps();
+                const __m128 cx = _mm_set1_ps(c.x), cy = _mm_set1_ps(c.y), cz = _mm_set1_ps(c.z);
+                const __m128 mnX = _mm_loadu_ps(&mMinX[b]), mxX = _mm_loadu_ps(&mMaxX[b]);
+                const __m128 mnY = _mm_loadu_ps(&mMinY[b]), mxY = _mm_loadu_ps(&mMaxY[b]);
+                const __m128 mnZ = _mm_loadu_ps(&mMinZ[b]), mxZ = _mm_loadu_ps(&mMaxZ[b]);
+
+                // Sphere vs AABB: squared distance from the center to the box.
+                __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(mnX, cx), _mm_sub_ps(cx, mxX)), zero);
+                __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(mnY, cy), _mm_sub_ps(cy, mxY)), zero);
+                __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(mnZ, cz), _mm_sub_ps(cz, mxZ)), zero);
+                __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+                __m128 hit = _mm_cmple_ps(d2, _mm_set1_ps(r * r));
+
+                if (spot)
+                {
+                    // Cone vs the cluster's bounding sphere.
+                    const __m128 half = _mm_set1_ps(0.5f);
+                    __m128 bx = _mm_mul_ps(_mm_add_ps(mnX, mxX), half);
+                    __m128 by = _mm_mul_ps(_mm_add_ps(mnY, mxY), half);
+                    __m128 bz = _mm_mul_ps(_mm_add_ps(mnZ, mxZ), half);
+                    __m128 ex = _mm_sub_ps(mxX, bx), ey = _mm_sub_ps(mxY, by), ez = _mm_sub_ps(mxZ, bz);
+                    __m128 br = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, ex), _mm_mul_ps(ey, ey)), _mm_mul_ps(ez, ez)));
+
+                    __m128 vx = _mm_sub_ps(bx, cx), vy = _mm_sub_ps(by, cy), vz = _mm_sub_ps(bz, cz);
+                    __m128 lenSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz));
+                    __m128 v1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, _mm_set1_ps(l.Direction.x)),
+                                                      _mm_mul_ps(vy, _mm_set1_ps(l.Direction.y))),
+                                           _mm_mul_ps(vz, _mm_set1_ps(l.Direction.z)));
+                    __m128 perp = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(lenSq, _mm_mul_ps(v1, v1)), zero));
+                    __m128 closest = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(cosA), perp), _mm_mul_ps(v1, _mm_set1_ps(sinA)));
+
+                    __m128 cone = _mm_and_ps(_mm_cmple_ps(closest, br),
+                                  _mm_and_ps(_mm_cmple_ps(v1, _mm_add_ps(br, _mm_set1_ps(r))),
+                                             _mm_cmpge_ps(v1, _mm_sub_ps(zero, br))));
+                    hit = _mm_and_ps(hit, cone);
+                }
+                mask = _mm_movemask_ps(hit);
+#else
+                mask = 0;
+                for (int k = 0; k < 4; ++k)
+                {
+                    Aabb box = { { mMinX[b + k], mMinY[b + k], mMinZ[b + k] }, { mMaxX[b + k], mMaxY[b + k], mMaxZ[b + k] } };
+                    bool hit = Intersects(box, Sphere{ c, r });
+                    if (hit && spot)
+                    {
+                        Vec3 bc = box.Center();
+                        float br = Length(box.Max - bc);
+                        Vec3 v = bc - c;
+                        float v1 = Dot(v, l.Direction);
+                        float closest = cosA * std::sqrt((std::max)(Dot(v, v) - v1 * v1, 0.0f)) - v1 * sinA;
+                        hit = closest <= br && v1 <= br + r && v1 >= -br;
+                    }
+                    mask |= hit ? (1 << k) : 0;
+                }
+#endif
+                for (uint32_t k = 0; k < 4; ++k)
+                {
+                    uint32_t x = xb + k;
+                    if ((mask & (1 << k)) && x >= x0 && x <= x1)
+                        lists[x].push_back(i);
+                }
+            }
+        }
+    }
+}
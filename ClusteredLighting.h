@@ -0,0 +1,88 @@
+// ClusteredLighting.h
+#pragma once
+#include "SceneMath.h"
+#include <vector>
+
+enum class LightType : uint32_t
+{
+    Point,
+    Spot
+};
+
+struct SceneLight
+{
+    Vec3      Position;
+    float     Range;
+    Vec3      Direction;   // spot only, normalized
+    float     SpotAngle;   // spot only, half angle in radians
+    LightType Type;
+};
+
+struct ClusterGridSettings
+{
+    uint32_t TilesX = 16;
+    uint32_t TilesY = 9;
+    uint32_t SlicesZ = 24;   // exponential in view depth
+};
+
+// Offset/count into the light index list, laid out for a structured buffer.
+struct ClusterRange
+{
+    uint32_t Offset;
+    uint32_t Count;
+};
+
+struct ClusterStats
+{
+    double   BuildMs = 0.0;
+    uint32_t Lights = 0;
+    uint32_t References = 0;
+    uint32_t MaxPerCluster = 0;
+};
+
+// Bins point and spot lights into a view-space froxel grid. Slices are
+// processed in parallel; within a slice each light only visits the tiles
+// its bounds project to and tests four cluster AABBs per SSE iteration.
+// Cluster index = (z * TilesY + y) * TilesX + x.
+class LightClusterer
+{
+public:
+    void SetGrid(const ClusterGridSettings& grid);
+    void SetProjection(float fovY, float aspect, float nearZ, float farZ);
+
+    void Build(const Mat4& view, const SceneLight* lights, uint32_t count);
+
+    const std::vector<ClusterRange>& Ranges() const { return mRanges; }
+    const std::vector<uint32_t>&     LightIndices() const { return mIndices; }
+    const ClusterStats&              GetStats() const { return mStats; }
+
+    uint32_t ClusterCount() const { return mGrid.TilesX * mGrid.TilesY * mGrid.SlicesZ; }
+
+private:
+    void BuildClusterBounds();
+    void BinSlice(uint32_t z);
+
+    float SliceDepth(uint32_t z) const;
+
+private:
+    ClusterGridSettings mGrid;
+    float mTanX = 1.0f;
+    float mTanY = 1.0f;
+    float mNearZ = 0.1f;
+    float mFarZ = 1000.0f;
+    bool  mBoundsDirty = true;
+
+    // View-space cluster AABBs, SoA, rows padded to a multiple of 4
+    uint32_t mRowStride = 0;
+    std::vector<float> mMinX, mMinY, mMinZ, mMaxX, mMaxY, mMaxZ;
+
+    // Lights in view space for the current build
+    std::vector<SceneLight> mViewLights;
+    std::vector<uint32_t>   mLightSliceRange; // packed first | last << 16
+
+    std::vector<std::vector<uint32_t>> mClusterLists;
+
+    std::vector<ClusterRange> mRanges;
+    std::vector<uint32_t>     mIndices;
+    ClusterStats              mStats;
+};
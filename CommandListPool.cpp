@@ -0,0 +1,51 @@
+// CommandListPool.cpp
+#include "CommandListPool.h"
+
+CommandListPool::CommandListPool(ID3D12Device* device, uint32_t frameSlots)
+    : mDevice(device)
+    , mFrameSlots(frameSlots)
+{
+}
+
+void CommandListPool::BeginFrame(uint32_t slot, uint32_t count)
+{
+    mSlot = slot;
+
+    while (mEntries.size() < count)
+    {
+        Entry e;
+        e.Allocators.resize(mFrameSlots);
+        for (auto& alloc : e.Allocators)
+        {
+            ThrowIfFailed(mDevice->CreateCommandAllocator(
+                D3D12_COMMAND_LIST_TYPE_DIRECT,
+                IID_PPV_ARGS(&alloc)));
+        }
+
+        ThrowIfFailed(mDevice->CreateCommandList(
+            0,
+            D3D12_COMMAND_LIST_TYPE_DIRECT,
+            e.Allocators[0].Get(),
+            nullptr,
+            IID_PPV_ARGS(&e.List)));
+        e.List->Close();
+
+        mEntries.push_back(std::move(e));
+    }
+}
+
+ID3D12GraphicsCommandList* CommandListPool::Acquire(uint32_t index, ID3D12PipelineState* pso)
+{
+    Entry& e = mEntries[index];
+    ID3D12CommandAllocator* alloc = e.Allocators[mSlot].Get();
+
+    ThrowIfFailed(alloc->Reset());
+    ThrowIfFailed(e.List->Reset(alloc, pso));
+    return e.List.Get();
+}
+
+void CommandListPool::Collect(uint32_t count, std::vector<ID3D12CommandList*>& out) const
+{
+    for (uint32_t i = 0; i < count; ++i)
+        out.push_back(mEntries[i].List.Get());
+}
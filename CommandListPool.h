@@ -0,0 +1,39 @@
+// CommandListPool.h
+#pragma once
+#include "Common.h"
+
+// Command lists for parallel recording. Each list index has one allocator
+// per frame slot, so a slot's allocators are only reset once FrameRing has
+// seen that slot's previous frame retire. Lists themselves are reusable as
+// soon as they have been submitted.
+class CommandListPool
+{
+public:
+    CommandListPool(ID3D12Device* device, uint32_t frameSlots);
+
+    // Main thread: makes sure count lists exist for this frame.
+    void BeginFrame(uint32_t slot, uint32_t count);
+
+    // Any thread, distinct indices below the BeginFrame count: resets the
+    // list with the slot's allocator and returns it open for recording.
+    ID3D12GraphicsCommandList* Acquire(uint32_t index, ID3D12PipelineState* pso);
+    ID3D12GraphicsCommandList* Get(uint32_t index) const { return mEntries[index].List.Get(); }
+
+    // Appends lists [0, count) in index order.
+    void Collect(uint32_t count, std::vector<ID3D12CommandList*>& out) const;
+
+    uint32_t Size() const { return (uint32_t)mEntries.size(); }
+
+private:
+    struct Entry
+    {
+        std::vector<ComPtr<ID3D12CommandAllocator>> Allocators; // one per frame slot
+        ComPtr<ID3D12GraphicsCommandList> List;
+    };
+
+    ID3D12Device* mDevice;
+    uint32_t mFrameSlots;
+    uint32_t mSlot = 0;
+
+    std::vector<Entry> mEntries;
+};
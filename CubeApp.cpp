@@ -1,13 +1,84 @@
 // CubeApp.cpp
 #include "CubeApp.h"
+#include <sstream>
+#include <iomanip>
+
+namespace
+{
+    // Records a range of the renderer's draws into a pooled list with the
+    // frame's targets bound.
+    class SceneRecorder : public ICommandRecorder
+    {
+    public:
+        SceneRecorder(CommandListPool& pool, const CubeRenderer& cube, ID3D12DescriptorHeap* srvHeap,
+            D3D12_CPU_DESCRIPTOR_HANDLE rtv, D3D12_CPU_DESCRIPTOR_HANDLE dsv,
+            const D3D12_VIEWPORT& viewport, const D3D12_RECT& scissor)
+            : mPool(pool), mCube(cube), mSrvHeap(srvHeap), mRtv(rtv), mDsv(dsv), mViewport(viewport), mScissor(scissor)
+        {
+        }
+
+        virtual void BeginList(uint32_t list) override
+        {
+            ID3D12GraphicsCommandList* cmdList = mPool.Acquire(list, mCube.GetPSO());
+            cmdList->RSSetViewports(1, &mViewport);
+            cmdList->RSSetScissorRects(1, &mScissor);
+            cmdList->OMSetRenderTargets(1, &mRtv, TRUE, &mDsv);
+            cmdList->SetDescriptorHeaps(1, &mSrvHeap);
+            cmdList->SetGraphicsRootSignature(mCube.GetRootSignature());
+        }
+
+        virtual void RecordDraws(uint32_t list, uint32_t first, uint32_t count) override
+        {
+            mCube.RecordDraws(mPool.Get(list), first, count);
+        }
+
+        virtual void EndList(uint32_t list) override
+        {
+            mPool.Get(list)->Close();
+        }
+
+    private:
+        CommandListPool& mPool;
+        const CubeRenderer& mCube;
+        ID3D12DescriptorHeap* mSrvHeap;
+        D3D12_CPU_DESCRIPTOR_HANDLE mRtv;
+        D3D12_CPU_DESCRIPTOR_HANDLE mDsv;
+        D3D12_VIEWPORT mViewport;
+        D3D12_RECT mScissor;
+    };
+
+    // A fixed grid of lights across the middle of the scene bounds, every
+    // fourth a spot pointing down, so the clusterer has a known load.
+    std::vector<SceneLight> MakeLights(const Sphere& bounds, uint32_t count)
+    {
+        std::vector<SceneLight> lights(count);
+        const uint32_t side = (uint32_t)ceilf(sqrtf((float)count));
+        const float cell = 2.0f * bounds.Radius / side;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            SceneLight& l = lights[i];
+            l.Position = { bounds.Center.x - bounds.Radius + ((i % side) + 0.5f) * cell,
+                           bounds.Center.y,
+                           bounds.Center.z - bounds.Radius + ((i / side) + 0.5f) * cell };
+            l.Range = 1.5f * cell;
+            l.Direction = { 0.0f, -1.0f, 0.0f };
+            l.SpotAngle = 0.6f;
+            l.Type = (i % 4 == 3) ? LightType::Spot : LightType::Point;
+        }
+        return lights;
+    }
+}
 
 CubeApp::CubeApp(HINSTANCE hInstance)
     : D3DApp(hInstance)
 {
+    mPacer.SetTargetRate(TargetFrameRate);
 }
 
 CubeApp::~CubeApp()
 {
+    // Frames may still be in flight and referencing mCube's resources.
+    FlushCommandQueue();
 }
 
 bool CubeApp::Initialize()
@@ -16,20 +87,26 @@ bool CubeApp::Initialize()
         return false;
 
    
-    mCommandAllocator->Reset();
-    mCommandList->Reset(mCommandAllocator.Get(), nullptr);
-
     mCube = std::make_unique<CubeRenderer>(
         mDevice.Get(),
-        mCommandList.Get(),
-        mCbvSrvUavDescriptorSize);
+        *mUploads,
+        mCbvSrvUavDescriptorSize,
+        mFrameUpload->Ring(),
+        *mBufferHeap,
+        *mPsoCache);
 
+    mCube->SetPropCount(PropCount);
     mCube->BuildResources();
+    mCube->SetLights(MakeLights(mCube->GetMeshBounds(), LightCount));
+    mCube->SetViewport(mScreenViewport);
 
-    mCommandList->Close();
-    ID3D12CommandList* cmdsLists[] = { mCommandList.Get() };
-    mCommandQueue->ExecuteCommandLists(1, cmdsLists);
-    FlushCommandQueue();
+    BuildFrameGraph();
+
+    // Persist pipelines compiled for the material set now, not only at exit.
+    mPsoCache->Save();
+
+    // Geometry copies run on the copy queue; the first frame waits for them on the GPU.
+    mUploads->WaitOnQueue(mCommandQueue.Get(), mUploads->Flush());
 
     return true;
 }
@@ -39,54 +116,190 @@ void CubeApp::OnResize()
     
 }
 
+std::wstring CubeApp::FrameStatsText()
+{
+    uint32_t frames = 0;
+    uint64_t saved = mCube->GetCullPipeline().TakeSavedDraws(frames);
+    const CullStats& cs = mCube->GetCullPipeline().GetStats();
+
+    std::wostringstream outs;
+    outs << L" | draws: " << cs.Visible << L"/" << cs.Candidates
+        << L" | small culled/frame: " << std::fixed << std::setprecision(1)
+        << (frames ? (double)saved / frames : 0.0);
+
+    const CascadeStats& shadow = mCube->GetShadowCascades().GetStats();
+    outs << L" | csm: " << std::setprecision(3) << (shadow.FitMs + shadow.CullMs) << L"ms"
+        << L" fit " << std::setprecision(0) << shadow.AverageEfficiency * 100.0f << L"%";
+
+    const ClusterStats& lights = mCube->GetLightClusterer().GetStats();
+    if (lights.Lights > 0)
+    {
+        outs << L" | lights: " << lights.Lights << L" in " << std::setprecision(3) << lights.BuildMs << L"ms";
+    }
+
+    outs << L" | lists: " << mRecordedLists;
+
+    const FixedStepStats& sim = mSimClock.GetStats();
+    if (sim.Frames > 0)
+    {
+        outs << L" | sim: " << std::setprecision(0) << 1.0 / mSimClock.StepSeconds() << L"Hz, "
+            << std::setprecision(2) << (double)sim.Steps / sim.Frames << L" steps/frame";
+        if (sim.ClampedFrames > 0)
+            outs << L", " << sim.ClampedFrames << L" capped (-" << sim.DroppedSeconds * 1000.0 << L"ms)";
+        mSimClock.ResetStats();
+    }
+
+    if (mLatencySamples > 0)
+    {
+        const double sampled = mInputToSubmitMs / mLatencySamples;
+        const double latched = mLatchToSubmitMs / mLatencySamples;
+        outs << L" | input->submit: " << std::setprecision(2) << sampled << L"ms";
+        if (mLateLatchCamera)
+            outs << L", camera latched " << latched << L"ms (-" << sampled - latched << L")";
+        mInputToSubmitMs = mLatchToSubmitMs = 0.0;
+        mLatencySamples = 0;
+    }
+
+    const RenderGraphStats& graph = mFrameGraph.GetStats();
+    outs << L" | graph: " << graph.Passes << L" passes, " << graph.Barriers << L" barriers in "
+        << graph.BarrierBatches << L" batches";
+
+    const StateTrackerStats& states = mGraphBackend->GetStateStats();
+    outs << L" | transitions: " << states.Emitted << L" issued, " << states.Removed << L" removed";
+
+    const InstanceStats& inst = mCube->GetInstanceStats();
+    outs << L" | instanced: " << inst.Instances << L" in " << inst.Batches << L" draws";
+
+    const SortStats& unsorted = mCube->GetUnsortedStateChanges();
+    const SortStats& sorted = mCube->GetSortedStateChanges();
+    outs << L" | pso/material changes: " << unsorted.PipelineChanges << L"/" << unsorted.MaterialChanges
+        << L" -> " << sorted.PipelineChanges << L"/" << sorted.MaterialChanges;
+
+    const PermutationStats& perms = mCube->GetPermutationStats();
+    outs << L" | variants: " << perms.Variants << L" (" << std::setprecision(1)
+        << perms.BytecodeBytes / 1024.0 << L"KB)";
+
+    PsoCacheStats pso = mPsoCache->GetStats();
+    outs << L" | pso: " << pso.Hits << L" hit " << pso.Misses << L" miss "
+        << std::setprecision(1) << pso.CreateMs << L"ms";
+
+    GpuMemoryStats mem = mBufferHeap->GetStats();
+    outs << L" | vram: " << std::setprecision(1) << mem.Used / (1024.0 * 1024.0) << L"/"
+        << mem.Reserved / (1024.0 * 1024.0) << L"MB in " << mem.Heaps << L" heaps";
+    return outs.str();
+}
+
 void CubeApp::Update(const GameTimer& gt)
 {
     
-    mCube->Update(gt.TotalTime(), gt.DeltaTime(), mInput);
+    // Benchmark runs advance exactly one step per frame, so they replay
+    // identically however long each frame took.
+    const double frameTime = mFixedFrameTime ? mSimClock.StepSeconds() : gt.DeltaTime();
+    const uint32_t steps = mSimClock.Advance(frameTime);
+    mCube->Update(steps, (float)mSimClock.StepSeconds(), (float)mSimClock.Alpha(), mFrameInput, mFrameInputTime);
 }
 
-void CubeApp::Draw(const GameTimer& /*gt*/)
+void CubeApp::PublishUpdate()
 {
-    mCommandAllocator->Reset();
-    mCommandList->Reset(mCommandAllocator.Get(), mCube->GetPSO());
+    mCube->PublishSnapshot();
+}
 
-    mCommandList->RSSetViewports(1, &mScreenViewport);
-    mCommandList->RSSetScissorRects(1, &mScissorRect);
+void CubeApp::BuildFrameGraph()
+{
+    mGraphBackend = std::make_unique<D3D12RenderGraphBackend>(mDevice.Get(), mResourceStates);
 
-    
-    auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(
-        CurrentBackBuffer(),
-        D3D12_RESOURCE_STATE_PRESENT,
-        D3D12_RESOURCE_STATE_RENDER_TARGET);
-    mCommandList->ResourceBarrier(1, &barrier);
-
-    float clearColor[] = { 0.1f, 0.1f, 0.3f, 1.0f };
-    mCommandList->ClearRenderTargetView(CurrentBackBufferView(), clearColor, 0, nullptr);
-    mCommandList->ClearDepthStencilView(
-        DepthStencilView(),
-        D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL,
-        1.0f, 0, 0, nullptr);
-
-    auto rtv = CurrentBackBufferView();
-    auto dsv = DepthStencilView();
-    mCommandList->OMSetRenderTargets(1, &rtv, TRUE, &dsv);
-
-    mCommandList->SetGraphicsRootSignature(mCube->GetRootSignature());
-    mCube->Draw(mCommandList.Get());
+    mBackBufferId = mFrameGraph.ImportTexture("BackBuffer", Access_Present, Access_Present);
+    mDepthId = mFrameGraph.ImportTexture("Depth", Access_DepthWrite, Access_DepthWrite);
 
-    
-    barrier = CD3DX12_RESOURCE_BARRIER::Transition(
-        CurrentBackBuffer(),
-        D3D12_RESOURCE_STATE_RENDER_TARGET,
-        D3D12_RESOURCE_STATE_PRESENT);
-    mCommandList->ResourceBarrier(1, &barrier);
+    mFrameGraph.AddPass("Clear",
+        [this](RenderGraph::PassBuilder& pass)
+        {
+            pass.Write(mBackBufferId, Access_RenderTarget);
+            pass.Write(mDepthId, Access_DepthWrite);
+        },
+        [this]()
+        {
+            float clearColor[] = { 0.1f, 0.1f, 0.3f, 1.0f };
+            mCommandList->ClearRenderTargetView(CurrentBackBufferView(), clearColor, 0, nullptr);
+            mCommandList->ClearDepthStencilView(
+                DepthStencilView(),
+                D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL,
+                1.0f, 0, 0, nullptr);
+        });
 
+    mFrameGraph.AddPass("Scene",
+        [this](RenderGraph::PassBuilder& pass)
+        {
+            pass.Read(mBackBufferId, Access_RenderTarget);
+            pass.Write(mBackBufferId, Access_RenderTarget);
+            pass.Read(mDepthId, Access_DepthWrite);
+            pass.Write(mDepthId, Access_DepthWrite);
+        },
+        [this]() { RecordScene(); });
+
+    mFrameGraph.Compile(*mGraphBackend);
+}
+
+void CubeApp::RecordScene()
+{
+    // Scene draws are split across worker lists; one more list takes the
+    // barriers that close the frame.
     mCommandList->Close();
-    ID3D12CommandList* cmdsLists[] = { mCommandList.Get() };
-    mCommandQueue->ExecuteCommandLists(1, cmdsLists);
+
+    SceneRecorder recorder(*mCommandListPool, *mCube, mSrvHeap->GetHeap(), CurrentBackBufferView(), DepthStencilView(),
+        mScreenViewport, mScissorRect);
+    mRecordedLists = RecordParallel(recorder, mCube->DrawCount(), WorkerCount(), MinDrawsPerList);
+
+    mGraphBackend->SetCommandList(mCommandListPool->Acquire(mRecordedLists, nullptr));
+}
+
+void CubeApp::Draw(const GameTimer& /*gt*/)
+{
+    // Safe to reset: FrameRing::BeginFrame waited for this slot's last frame.
+    ID3D12CommandAllocator* frameAlloc = CurrentFrameAllocator();
+    frameAlloc->Reset();
+    mCommandList->Reset(frameAlloc, nullptr);
+
+    mCube->PrepareFrame();
+
+    // Worker lists, the closing list and the list with entry transitions
+    mCommandListPool->BeginFrame(CurrentFrameIndex(), WorkerCount() + 2);
+
+    // The graph issues every barrier; passes only record work.
+    mGraphBackend->Bind(mBackBufferId, CurrentBackBuffer());
+    mGraphBackend->Bind(mDepthId, mDepthStencilBuffer.Get());
+    mGraphBackend->SetCommandList(mCommandList.Get());
+    mFrameGraph.Execute(*mGraphBackend);
+
+    mCommandListPool->Get(mRecordedLists)->Close();
+
+    // States the frame expects on entry are only known now; they run first.
+    std::vector<ID3D12CommandList*> cmdsLists;
+    ID3D12GraphicsCommandList* entry = mCommandListPool->Acquire(mRecordedLists + 1, nullptr);
+    if (mGraphBackend->RecordPendingTransitions(entry))
+        cmdsLists.push_back(entry);
+    entry->Close();
+
+    // Index order is draw order, so the frame matches single-threaded recording.
+    cmdsLists.push_back(mCommandList.Get());
+    mCommandListPool->Collect(mRecordedLists + 1, cmdsLists);
+
+    // Everything is recorded; bring the camera the draws read up to date.
+    const int64_t latchTime = mPacerClock.Now();
+    if (mLateLatchCamera)
+    {
+        DrainRawInput(GameTimer::Counter());
+        mCube->LatchCamera(mInput, (float)((latchTime - mCube->RenderInputTime()) * 1e-9));
+    }
+
+    mCommandQueue->ExecuteCommandLists((UINT)cmdsLists.size(), cmdsLists.data());
+    mGraphBackend->Commit();
+
+    const int64_t submitTime = mPacerClock.Now();
+    mInputToSubmitMs += (submitTime - mCube->RenderInputTime()) * 1e-6;
+    mLatchToSubmitMs += (submitTime - latchTime) * 1e-6;
+    mLatencySamples++;
 
     ThrowIfFailed(mSwapChain->Present(1, 0));
     mCurrBackBuffer = (mCurrBackBuffer + 1) % SwapChainBufferCount;
-
-    FlushCommandQueue();
 }
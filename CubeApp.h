@@ -2,6 +2,10 @@
 #pragma once
 #include "D3DApp.h"
 #include "CubeRenderer.h"
+#include "ParallelRecord.h"
+#include "Parallel.h"
+#include "RenderGraphD3D12.h"
+#include "FixedStepClock.h"
 
 class CubeApp : public D3DApp
 {
@@ -14,8 +18,40 @@ public:
     virtual void OnResize() override;
     virtual void Update(const GameTimer& gt) override;
     virtual void Draw(const GameTimer& gt) override;
+    virtual void PublishUpdate() override;
+
+protected:
+    virtual std::wstring FrameStatsText() override;
 
 private:
+    void BuildFrameGraph();
+    void RecordScene();
+
     std::unique_ptr<CubeRenderer> mCube;
+
+    // Frame passes and their barriers; compiled once, executed every frame
+    RenderGraph mFrameGraph;
+    std::unique_ptr<D3D12RenderGraphBackend> mGraphBackend;
+    GraphResource mBackBufferId = InvalidGraphResource;
+    GraphResource mDepthId = InvalidGraphResource;
+
+    static const uint32_t PropCount = 4096;
+    static const uint32_t LightCount = 1024;
+    static constexpr double TargetFrameRate = 60.0;
+    static constexpr double SimulationRate = 120.0;
+    static const uint32_t MaxSubsteps = 8;
+    static const uint32_t MinDrawsPerList = 256;
+    uint32_t mRecordedLists = 0;
+
+    // Simulation runs in fixed steps; mFixedFrameTime makes every frame
+    // one step for deterministic benchmark runs
+    FixedStepClock mSimClock{ 1.0 / SimulationRate, MaxSubsteps };
+    bool mFixedFrameTime = false;
+
+    // Camera rewritten from fresh input just before submit
+    bool     mLateLatchCamera = true;
+    double   mInputToSubmitMs = 0.0;   // summed over the stats window
+    double   mLatchToSubmitMs = 0.0;
+    uint32_t mLatencySamples = 0;
 };
 
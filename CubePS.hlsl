@@ -1,13 +1,24 @@
+// Feature switches come from ShaderPermutation.h; each combination is its own variant.
+#ifndef USE_SPECULAR
+#define USE_SPECULAR 1
+#endif
+#ifndef USE_ALPHA_TEST
+#define USE_ALPHA_TEST 0
+#endif
+#ifndef USE_HEMI_AMBIENT
+#define USE_HEMI_AMBIENT 0
+#endif
 
-
-cbuffer ObjectCB : register(b0)
+// The view has its own slot; it is rewritten just before submit.
+cbuffer CameraCB : register(b2)
 {
-    float4x4 gWorldViewProj;
-    float4x4 gWorld;
-
+    float4x4 gViewProj;
     float3 gEyePosW;
     float pad0;
+};
 
+cbuffer ObjectCB : register(b0)
+{
     float4 gLightDir; 
     float4 gDiffuseColor; 
     float4 gSpecularColor;
@@ -41,14 +52,23 @@ float4 PSMain(PSInput pin) : SV_Target
 
     
     float3 specular = 0.0f;
+#if USE_SPECULAR
     if (NdotL > 0.0f)
     {
         float specFactor = pow(saturate(dot(N, H)), gShininess);
         specular = gSpecularColor.rgb * specFactor;
     }
+#endif
 
-    
+#if USE_HEMI_AMBIENT
+    float3 ambient = lerp(0.1f, 0.3f, N.y * 0.5f + 0.5f) * gDiffuseColor.rgb;
+#else
     float3 ambient = 0.2f * gDiffuseColor.rgb;
+#endif
+
+#if USE_ALPHA_TEST
+    clip(gDiffuseColor.a - 0.5f);
+#endif
 
     float3 color = ambient + diffuse + specular;
     return float4(color, 1.0f);
@@ -1,42 +1,110 @@
 // CubeRenderer.cpp
 #include "CubeRenderer.h"
-#include "ObjLoader.h"
+#include <algorithm>
+#include <cfloat>
+#include <fstream>
+
+static Mat4 ToMat4(FXMMATRIX m)
+{
+    XMFLOAT4X4 f;
+    XMStoreFloat4x4(&f, m);
+
+    Mat4 out;
+    memcpy(out.m, f.m, sizeof(out.m));
+    return out;
+}
+
+static const D3D12_INPUT_ELEMENT_DESC InputLayout[] =
+{
+    { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0,  D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+    { "NORMAL",   0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
+};
+
+static std::wstring ExeDirectory()
+{
+    wchar_t exePath[MAX_PATH];
+    GetModuleFileNameW(nullptr, exePath, MAX_PATH);
+
+    wchar_t* lastSlash = wcsrchr(exePath, L'\\');
+    if (lastSlash) *(lastSlash + 1) = 0;
+    return exePath;
+}
+
+static ComPtr<ID3DBlob> CompileFromSource(const wchar_t* file, const char* entry, const char* profile,
+    PermutationKey permutation)
+{
+    std::vector<std::pair<const char*, const char*>> defines;
+    PermutationDefines(permutation, defines);
+
+    std::vector<D3D_SHADER_MACRO> macros;
+    for (const auto& d : defines)
+        macros.push_back({ d.first, d.second });
+    macros.push_back({ nullptr, nullptr });
+
+#if defined(_DEBUG)
+    UINT flags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#else
+    UINT flags = D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#endif
+
+    ComPtr<ID3DBlob> code;
+    ComPtr<ID3DBlob> errors;
+    HRESULT hr = D3DCompileFromFile(file, macros.data(), nullptr, entry, profile, flags, 0, &code, &errors);
+
+    if (FAILED(hr))
+    {
+        if (errors) MessageBoxA(nullptr, (char*)errors->GetBufferPointer(), "Shader compile error", MB_OK);
+        ThrowIfFailed(hr);
+    }
+    return code;
+}
 
 CubeRenderer::CubeRenderer(ID3D12Device* device,
-    ID3D12GraphicsCommandList* cmdList,
-    UINT cbvSrvUavDescriptorSize)
+    UploadManager& uploads,
+    UINT cbvSrvUavDescriptorSize,
+    UploadRing& frameUpload,
+    GpuHeapAllocator& bufferHeap,
+    PsoCache& psoCache)
     : mDevice(device)
-    , mCmdList(cmdList)
+    , mUploads(uploads)
     , mCbvSrvUavDescriptorSize(cbvSrvUavDescriptorSize)
+    , mFrameUpload(frameUpload)
+    , mBufferHeap(bufferHeap)
+    , mPsoCache(psoCache)
 {
     float aspect = 1280.0f / 720.0f;
     XMMATRIX P = XMMatrixPerspectiveFovLH(0.25f * XM_PI, aspect, 0.1f, 5000.0f);
     XMStoreFloat4x4(&mProj, P);
+    mLightClusters.SetProjection(0.25f * XM_PI, aspect, 0.1f, 5000.0f);
 
     
     mCameraPos = XMFLOAT3(0.0f, 2.0f, -5.0f);
+    mPrevPose = CurrentPose();
+}
+
+CubeRenderer::~CubeRenderer()
+{
+    // Placed resources must go before their heap ranges are reused.
+    mVertexBuffer.Reset();
+    mIndexBuffer.Reset();
+    mBufferHeap.Free(mVBAlloc);
+    mBufferHeap.Free(mIBAlloc);
 }
 
 void CubeRenderer::BuildResources()
 {
     BuildCubeGeometry();
-    BuildConstantBuffer();
     BuildRootSignature();
-    BuildPSO();
+    LoadShaderArchive();
+    BuildPSOs();
 }
 
 void CubeRenderer::BuildCubeGeometry()
 {
     ObjMeshData mesh;
 
-    
-    wchar_t exePath[MAX_PATH];
-    GetModuleFileNameW(nullptr, exePath, MAX_PATH);
-
-    wchar_t* lastSlash = wcsrchr(exePath, L'\\');
-    if (lastSlash) *(lastSlash + 1) = 0;
-
-    std::wstring objPath = std::wstring(exePath) + L"Models\\sponza.obj";
+    const std::wstring exePath = ExeDirectory();
+    std::wstring objPath = exePath + L"Models\\sponza.obj";
 
     if (!ObjLoader::LoadObjPosNormal(objPath, mesh, true))
     {
@@ -46,78 +114,46 @@ void CubeRenderer::BuildCubeGeometry()
 
     mIndexCount = (UINT)mesh.Indices.size();
 
+    Aabb meshBox = { { FLT_MAX, FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX } };
+    for (const VertexPosNormal& v : mesh.Vertices)
+    {
+        meshBox.Min = { (std::min)(meshBox.Min.x, v.Pos.x), (std::min)(meshBox.Min.y, v.Pos.y), (std::min)(meshBox.Min.z, v.Pos.z) };
+        meshBox.Max = { (std::max)(meshBox.Max.x, v.Pos.x), (std::max)(meshBox.Max.y, v.Pos.y), (std::max)(meshBox.Max.z, v.Pos.z) };
+    }
+    mMeshLocalBounds.Center = (meshBox.Min + meshBox.Max) * 0.5f;
+    mMeshLocalBounds.Radius = Length(meshBox.Max - mMeshLocalBounds.Center);
+
+    // World region sized so the mesh can rotate freely and props fit around it.
+    float worldHalf = 2.0f * mMeshLocalBounds.Radius;
+    Vec3 worldHalfExtent = { worldHalf, worldHalf, worldHalf };
+    mScene = std::make_unique<SceneOctree>(
+        Aabb{ mMeshLocalBounds.Center - worldHalfExtent, mMeshLocalBounds.Center + worldHalfExtent });
+    mMeshHandle = mScene->Insert(mMeshLocalBounds, 0);
+    mObjectBounds.assign(1, mMeshLocalBounds);
+    mObjectWorld.resize(1);
+    mMeshes.assign(1, { mIndexCount, 0, 0 });
+
+    BuildProps(meshBox, mesh.Vertices, mesh.Indices);
+
+    // Optional bake output from PvsBakeTool; ignored if it was baked from a different mesh.
+    std::wstring pvsPath = exePath + L"Models\\sponza.pvs";
+    std::ifstream pvsFile(pvsPath.c_str(), std::ios::binary);
+    if (!pvsFile || !mPvs.Read(pvsFile) || mPvs.MeshIndexCount() != mIndexCount)
+        mPvs = PvsData();
+
     const UINT vBufferSize = (UINT)(mesh.Vertices.size() * sizeof(VertexPosNormal));
     const UINT iBufferSize = (UINT)(mesh.Indices.size() * sizeof(uint32_t));
 
-   
-    CD3DX12_HEAP_PROPERTIES defaultHeapProps(D3D12_HEAP_TYPE_DEFAULT);
-    CD3DX12_HEAP_PROPERTIES uploadHeapProps(D3D12_HEAP_TYPE_UPLOAD);
-
     CD3DX12_RESOURCE_DESC vbDesc = CD3DX12_RESOURCE_DESC::Buffer(vBufferSize);
     CD3DX12_RESOURCE_DESC ibDesc = CD3DX12_RESOURCE_DESC::Buffer(iBufferSize);
 
-    
-    ThrowIfFailed(mDevice->CreateCommittedResource(
-        &defaultHeapProps,
-        D3D12_HEAP_FLAG_NONE,
-        &vbDesc,
-        D3D12_RESOURCE_STATE_COPY_DEST,
-        nullptr,
-        IID_PPV_ARGS(&mVertexBuffer)));
-
-    
-    ThrowIfFailed(mDevice->CreateCommittedResource(
-        &uploadHeapProps,
-        D3D12_HEAP_FLAG_NONE,
-        &vbDesc,
-        D3D12_RESOURCE_STATE_GENERIC_READ,
-        nullptr,
-        IID_PPV_ARGS(&mVBUpload)));
-
-    void* mapped = nullptr;
-    ThrowIfFailed(mVBUpload->Map(0, nullptr, &mapped));
-    memcpy(mapped, mesh.Vertices.data(), vBufferSize);
-    mVBUpload->Unmap(0, nullptr);
-
-    mCmdList->CopyBufferRegion(mVertexBuffer.Get(), 0, mVBUpload.Get(), 0, vBufferSize);
-    {
-        auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(
-            mVertexBuffer.Get(),
-            D3D12_RESOURCE_STATE_COPY_DEST,
-            D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
-        mCmdList->ResourceBarrier(1, &barrier);
-    }
+    // COMMON so the copy queue can promote them; the graphics queue promotes
+    // them again to vertex/index reads on first use.
+    mVertexBuffer = mBufferHeap.CreateResource(vbDesc, D3D12_RESOURCE_STATE_COMMON, mVBAlloc);
+    mIndexBuffer = mBufferHeap.CreateResource(ibDesc, D3D12_RESOURCE_STATE_COMMON, mIBAlloc);
 
-    
-    ThrowIfFailed(mDevice->CreateCommittedResource(
-        &defaultHeapProps,
-        D3D12_HEAP_FLAG_NONE,
-        &ibDesc,
-        D3D12_RESOURCE_STATE_COPY_DEST,
-        nullptr,
-        IID_PPV_ARGS(&mIndexBuffer)));
-
-    
-    ThrowIfFailed(mDevice->CreateCommittedResource(
-        &uploadHeapProps,
-        D3D12_HEAP_FLAG_NONE,
-        &ibDesc,
-        D3D12_RESOURCE_STATE_GENERIC_READ,
-        nullptr,
-        IID_PPV_ARGS(&mIBUpload)));
-
-    ThrowIfFailed(mIBUpload->Map(0, nullptr, &mapped));
-    memcpy(mapped, mesh.Indices.data(), iBufferSize);
-    mIBUpload->Unmap(0, nullptr);
-
-    mCmdList->CopyBufferRegion(mIndexBuffer.Get(), 0, mIBUpload.Get(), 0, iBufferSize);
-    {
-        auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(
-            mIndexBuffer.Get(),
-            D3D12_RESOURCE_STATE_COPY_DEST,
-            D3D12_RESOURCE_STATE_INDEX_BUFFER);
-        mCmdList->ResourceBarrier(1, &barrier);
-    }
+    mUploads.UploadBuffer(mVertexBuffer.Get(), 0, mesh.Vertices.data(), vBufferSize);
+    mUploads.UploadBuffer(mIndexBuffer.Get(), 0, mesh.Indices.data(), iBufferSize);
 
     mVBV.BufferLocation = mVertexBuffer->GetGPUVirtualAddress();
     mVBV.StrideInBytes = sizeof(VertexPosNormal);
@@ -132,31 +168,78 @@ void CubeRenderer::BuildCubeGeometry()
         MessageBoxW(nullptr, L"Warning: too few indices, is this really Sponza?", L"DBG", MB_OK);
 }
 
-void CubeRenderer::BuildConstantBuffer()
+void CubeRenderer::BuildProps(const Aabb& meshBox, std::vector<VertexPosNormal>& vertices,
+    std::vector<uint32_t>& indices)
 {
-    UINT cbSize = (sizeof(ObjectConstants) + 255) & ~255;
+    // A unit cube appended to the scene buffers; props draw it with BaseVertex.
+    const MeshRange prop = { 36, (UINT)indices.size(), (INT)vertices.size() };
+    mMeshes.push_back(prop);
 
-    CD3DX12_HEAP_PROPERTIES uploadHeapProps(D3D12_HEAP_TYPE_UPLOAD);
-    CD3DX12_RESOURCE_DESC cbDesc = CD3DX12_RESOURCE_DESC::Buffer(cbSize);
+    static const XMFLOAT3 Normals[6] = {
+        { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+    for (const XMFLOAT3& n : Normals)
+    {
+        XMVECTOR N = XMLoadFloat3(&n);
+        XMVECTOR U = XMVectorSet(n.y, n.z, n.x, 0.0f);
+        XMVECTOR V = XMVector3Cross(N, U);
+
+        UINT base = (UINT)vertices.size() - prop.BaseVertex;
+        const float corners[4][2] = { { -1, -1 }, { -1, 1 }, { 1, 1 }, { 1, -1 } };
+        for (const auto& c : corners)
+        {
+            VertexPosNormal v;
+            XMStoreFloat3(&v.Pos, (N + U * c[0] + V * c[1]) * 0.5f);
+            v.Normal = n;
+            vertices.push_back(v);
+        }
+
+        const UINT quad[6] = { 0, 1, 2, 0, 2, 3 };
+        for (UINT q : quad)
+            indices.push_back(base + q);
+    }
+
+    if (mPropCount == 0)
+        return;
 
-    ThrowIfFailed(mDevice->CreateCommittedResource(
-        &uploadHeapProps,
-        D3D12_HEAP_FLAG_NONE,
-        &cbDesc,
-        D3D12_RESOURCE_STATE_GENERIC_READ,
-        nullptr,
-        IID_PPV_ARGS(&mConstantUploadBuffer)));
+    // Props stand on a square grid over the floor of the mesh bounds.
+    const Vec3 extent = meshBox.Max - meshBox.Min;
+    const uint32_t side = (uint32_t)ceilf(sqrtf((float)mPropCount));
+    const float cellX = extent.x / side;
+    const float cellZ = extent.z / side;
+    const float size = 0.25f * (std::min)(cellX, cellZ);
+    const float radius = 0.5f * size * sqrtf(3.0f);
 
-    mConstantBuffer = mConstantUploadBuffer;
+    mObjectWorld.resize(1 + mPropCount);
+    mObjectBounds.resize(1 + mPropCount);
+    for (uint32_t i = 0; i < mPropCount; ++i)
+    {
+        Vec3 center = {
+            meshBox.Min.x + ((i % side) + 0.5f) * cellX,
+            meshBox.Min.y + 0.5f * size,
+            meshBox.Min.z + ((i / side) + 0.5f) * cellZ };
+
+        XMMATRIX world = XMMatrixScaling(size, size, size) *
+            XMMatrixRotationY(0.37f * i) *
+            XMMatrixTranslation(center.x, center.y, center.z);
+        XMStoreFloat4x4(&mObjectWorld[1 + i], XMMatrixTranspose(world));
+
+        mObjectBounds[1 + i] = { center, radius };
+        mScene->Insert(mObjectBounds[1 + i], 1 + i);
+    }
 }
 
 void CubeRenderer::BuildRootSignature()
 {
-    CD3DX12_ROOT_PARAMETER rootParam;
-    rootParam.InitAsConstantBufferView(0);
+    // b0 frame constants, t0 instance transforms, b1 first instance of the draw,
+    // b2 camera constants (kept apart so the late latch rewrites only them)
+    CD3DX12_ROOT_PARAMETER rootParams[4];
+    rootParams[0].InitAsConstantBufferView(0);
+    rootParams[1].InitAsShaderResourceView(0, 0, D3D12_SHADER_VISIBILITY_VERTEX);
+    rootParams[2].InitAsConstants(1, 1, 0, D3D12_SHADER_VISIBILITY_VERTEX);
+    rootParams[3].InitAsConstantBufferView(2);
 
     CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(
-        1, &rootParam,
+        _countof(rootParams), rootParams,
         0, nullptr,
         D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
 
@@ -174,51 +257,84 @@ void CubeRenderer::BuildRootSignature()
         serializedRootSig->GetBufferPointer(),
         serializedRootSig->GetBufferSize(),
         IID_PPV_ARGS(&mRootSignature)));
+
+    mRootSignatureHash = HashBytes(serializedRootSig->GetBufferPointer(), serializedRootSig->GetBufferSize());
 }
 
-void CubeRenderer::BuildPSO()
+void CubeRenderer::LoadShaderArchive()
 {
-    ComPtr<ID3DBlob> vs;
-    ComPtr<ID3DBlob> ps;
-    ComPtr<ID3DBlob> errors;
+    // Built offline by ShaderBuildTool from Shaders.txt.
+    std::wstring path = ExeDirectory() + L"Shaders\\shaders.bin";
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file || !mShaders.Read(file))
+        mShaders = ShaderArchive();
+}
 
-    HRESULT hr = D3DCompileFromFile(
-        L"Shaders/CubeVS.hlsl",
-        nullptr, nullptr,
-        "VSMain", "vs_5_0",
-        D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION,
-        0, &vs, &errors);
+void CubeRenderer::BuildPSOs()
+{
+    // Only variants some material references are loaded and turned into PSOs.
+    mPsos.clear();
+    mPermutationStats = PermutationStats();
 
-    if (FAILED(hr))
+    // Every variant is requested up front so cache loads and driver
+    // compiles overlap; source-compiled blobs live until all are done.
+    std::vector<ComPtr<ID3DBlob>> compiled;
+    std::vector<std::pair<PermutationKey, std::future<ComPtr<ID3D12PipelineState>>>> pending;
+
+    for (const Material& m : mMaterials)
     {
-        if (errors) MessageBoxA(nullptr, (char*)errors->GetBufferPointer(), "VS compile error", MB_OK);
-        ThrowIfFailed(hr);
+        PermutationKey key = MakePermutation(m.Features, PixelFeatureMask);
+        if (mPsos.count(key) != 0)
+            continue;
+
+        mPsos[key] = nullptr;
+        pending.emplace_back(key, RequestPSO(key, compiled));
     }
 
-    hr = D3DCompileFromFile(
-        L"Shaders/CubePS.hlsl",
-        nullptr, nullptr,
-        "PSMain", "ps_5_0",
-        D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION,
-        0, &ps, &errors);
+    for (auto& p : pending)
+        mPsos[p.first] = p.second.get();
+}
 
-    if (FAILED(hr))
+std::future<ComPtr<ID3D12PipelineState>> CubeRenderer::RequestPSO(PermutationKey permutation,
+    std::vector<ComPtr<ID3DBlob>>& compiled)
+{
+    const PermutationKey vsKey = MakePermutation(permutation, VertexFeatureMask);
+    const PermutationKey psKey = MakePermutation(permutation, PixelFeatureMask);
+
+    D3D12_SHADER_BYTECODE vsCode = {};
+    D3D12_SHADER_BYTECODE psCode = {};
+
+    // Precompiled DXIL when the archive is deployed; the source fallback is
+    // only for working on shaders without rerunning the offline build.
+    ShaderBlob vsBlob, psBlob;
+    ComPtr<ID3DBlob> vs, ps;
+    if (mShaders.Find(MakeShaderKey("CubeVS.hlsl", "VSMain", "vs_6_0", vsKey), vsBlob) &&
+        mShaders.Find(MakeShaderKey("CubePS.hlsl", "PSMain", "ps_6_0", psKey), psBlob))
     {
-        if (errors) MessageBoxA(nullptr, (char*)errors->GetBufferPointer(), "PS compile error", MB_OK);
-        ThrowIfFailed(hr);
+        vsCode = { vsBlob.Bytecode, vsBlob.BytecodeSize };
+        psCode = { psBlob.Bytecode, psBlob.BytecodeSize };
     }
-
-    D3D12_INPUT_ELEMENT_DESC inputLayout[] =
+    else
     {
-        { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0,  D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-        { "NORMAL",   0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
-    };
+        vs = CompileFromSource(L"Shaders/CubeVS.hlsl", "VSMain", "vs_5_0", vsKey);
+        ps = CompileFromSource(L"Shaders/CubePS.hlsl", "PSMain", "ps_5_0", psKey);
+        vsCode = { vs->GetBufferPointer(), vs->GetBufferSize() };
+        psCode = { ps->GetBufferPointer(), ps->GetBufferSize() };
+        compiled.push_back(vs);
+        compiled.push_back(ps);
+    }
+
+    // The vertex shader is shared by every variant; count it once.
+    if (mPermutationStats.Variants == 0)
+        mPermutationStats.BytecodeBytes += vsCode.BytecodeLength;
+    mPermutationStats.Variants++;
+    mPermutationStats.BytecodeBytes += psCode.BytecodeLength;
 
     D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
-    psoDesc.InputLayout = { inputLayout, _countof(inputLayout) };
+    psoDesc.InputLayout = { InputLayout, _countof(InputLayout) };
     psoDesc.pRootSignature = mRootSignature.Get();
-    psoDesc.VS = { vs->GetBufferPointer(), vs->GetBufferSize() };
-    psoDesc.PS = { ps->GetBufferPointer(), ps->GetBufferSize() };
+    psoDesc.VS = vsCode;
+    psoDesc.PS = psCode;
 
     CD3DX12_RASTERIZER_DESC rast(D3D12_DEFAULT);
     rast.CullMode = D3D12_CULL_MODE_NONE;
@@ -233,102 +349,388 @@ void CubeRenderer::BuildPSO()
     psoDesc.DSVFormat = DXGI_FORMAT_D24_UNORM_S8_UINT;
     psoDesc.SampleDesc.Count = 1;
 
-    ThrowIfFailed(mDevice->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&mPSO)));
+    return mPsoCache.GetOrCreateAsync(psoDesc, mRootSignatureHash);
 }
 
-void CubeRenderer::UpdateCubeRotation(const InputDevice& input, float)
+ID3D12PipelineState* CubeRenderer::GetPSO(UINT material) const
 {
-   
-    if (input.IsMouseDown(0))
-    {
-        const float rotSpeed = 0.01f;
-        POINT md = input.MouseDelta();
-        mCubeYaw += md.x * rotSpeed;
-        mCubePitch += md.y * rotSpeed;
+    auto it = mPsos.find(MakePermutation(mMaterials[material].Features, PixelFeatureMask));
+    return it != mPsos.end() ? it->second.Get() : nullptr;
+}
 
-        const float limit = XM_PIDIV2 - 0.01f;
-        if (mCubePitch > limit)  mCubePitch = limit;
-        if (mCubePitch < -limit) mCubePitch = -limit;
-    }
+void CubeRenderer::SetViewport(const D3D12_VIEWPORT& viewport)
+{
+    mViewportWidth = viewport.Width;
+    mViewportHeight = viewport.Height;
 }
 
-void CubeRenderer::UpdateCamera(const InputDevice& input, float dt)
+void CubeRenderer::UpdateCubeRotation(POINT drag)
+{
+    const float rotSpeed = 0.01f;
+    mCubeYaw += drag.x * rotSpeed;
+    mCubePitch += drag.y * rotSpeed;
+
+    const float limit = XM_PIDIV2 - 0.01f;
+    if (mCubePitch > limit)  mCubePitch = limit;
+    if (mCubePitch < -limit) mCubePitch = -limit;
+}
+
+// Mouse look, then WASD movement; shared by Update and LatchCamera so the
+// latched camera moves exactly like the simulated one.
+template <typename KeyDown>
+static void StepCamera(XMFLOAT3& cameraPos, float& yaw, float& pitch, POINT look, KeyDown keyDown, float dt)
 {
     const float moveSpeed = 5.0f;
     const float mouseSens = 0.0025f;
 
-    
-    if (input.IsMouseDown(1))
-    {
-        POINT md = input.MouseDelta();
-        mYaw += md.x * mouseSens;
-        mPitch += md.y * mouseSens;
+    yaw += look.x * mouseSens;
+    pitch += look.y * mouseSens;
 
-        const float limit = XM_PIDIV2 - 0.1f;
-        if (mPitch > limit)  mPitch = limit;
-        if (mPitch < -limit) mPitch = -limit;
-    }
+    const float limit = XM_PIDIV2 - 0.1f;
+    if (pitch > limit)  pitch = limit;
+    if (pitch < -limit) pitch = -limit;
 
     XMVECTOR forward = XMVectorSet(
-        cosf(mPitch) * sinf(mYaw),
-        sinf(mPitch),
-        cosf(mPitch) * cosf(mYaw),
+        cosf(pitch) * sinf(yaw),
+        sinf(pitch),
+        cosf(pitch) * cosf(yaw),
         0.0f);
 
     XMVECTOR up = XMVectorSet(0, 1, 0, 0);
     XMVECTOR right = XMVector3Normalize(XMVector3Cross(up, forward));
-    XMVECTOR pos = XMLoadFloat3(&mCameraPos);
+    XMVECTOR pos = XMLoadFloat3(&cameraPos);
+
+    if (keyDown('W')) pos += forward * moveSpeed * dt;
+    if (keyDown('S')) pos -= forward * moveSpeed * dt;
+    if (keyDown('A')) pos -= right * moveSpeed * dt;
+    if (keyDown('D')) pos += right * moveSpeed * dt;
+
+    XMStoreFloat3(&cameraPos, pos);
+}
+
+void CubeRenderer::UpdateCamera(const InputDevice& input, POINT look, float dt)
+{
+    StepCamera(mCameraPos, mYaw, mPitch, look,
+        [&input](uint8_t vk) { return input.IsKeyDown(vk); }, dt);
+}
+
+CameraConstants CubeRenderer::MakeCameraConstants(const XMFLOAT3& cameraPos, float yaw, float pitch) const
+{
+    XMVECTOR pos = XMLoadFloat3(&cameraPos);
+    XMVECTOR forward = XMVectorSet(
+        cosf(pitch) * sinf(yaw),
+        sinf(pitch),
+        cosf(pitch) * cosf(yaw),
+        0.0f);
 
-    if (input.IsKeyDown('W')) pos += forward * moveSpeed * dt;
-    if (input.IsKeyDown('S')) pos -= forward * moveSpeed * dt;
-    if (input.IsKeyDown('A')) pos -= right * moveSpeed * dt;
-    if (input.IsKeyDown('D')) pos += right * moveSpeed * dt;
+    XMMATRIX view = XMMatrixLookAtLH(pos, pos + forward, XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+    XMMATRIX viewProj = view * XMLoadFloat4x4(&mProj);
 
-    XMStoreFloat3(&mCameraPos, pos);
+    CameraConstants camera = {};
+    XMStoreFloat4x4(&camera.ViewProj, XMMatrixTranspose(viewProj));
+    camera.EyePosW = cameraPos;
+    return camera;
 }
 
-void CubeRenderer::Update(float, float deltaTime, const InputDevice& input)
+CubeRenderer::SimPose CubeRenderer::Interpolate(const SimPose& a, const SimPose& b, float t)
 {
-    UpdateCubeRotation(input, deltaTime);
-    UpdateCamera(input, deltaTime);
+    auto lerp = [t](float x, float y) { return x + (y - x) * t; };
+    SimPose p;
+    p.CameraPos = XMFLOAT3(lerp(a.CameraPos.x, b.CameraPos.x), lerp(a.CameraPos.y, b.CameraPos.y),
+        lerp(a.CameraPos.z, b.CameraPos.z));
+    p.Yaw = lerp(a.Yaw, b.Yaw);   // angles are not wrapped, so a plain lerp is the short way
+    p.Pitch = lerp(a.Pitch, b.Pitch);
+    p.CubeYaw = lerp(a.CubeYaw, b.CubeYaw);
+    p.CubePitch = lerp(a.CubePitch, b.CubePitch);
+    return p;
+}
+
+void CubeRenderer::Update(uint32_t substeps, float stepSeconds, float alpha, const InputDevice& input,
+                          int64_t inputTime)
+{
+    // Drags are distances, not rates: they wait for the next step instead
+    // of being scaled by a step length, so none is lost on frames without one.
+    if (input.IsMouseDown(0))
+    {
+        POINT md = input.MouseDelta();
+        mPendingDrag.x += md.x;
+        mPendingDrag.y += md.y;
+    }
+    if (input.IsMouseDown(1))
+    {
+        POINT look = input.LookDelta();
+        mPendingLook.x += look.x;
+        mPendingLook.y += look.y;
+    }
+
+    for (uint32_t step = 0; step < substeps; ++step)
+    {
+        mPrevPose = CurrentPose();
+        UpdateCubeRotation(mPendingDrag);
+        UpdateCamera(input, mPendingLook, stepSeconds);
+        mPendingDrag = {};
+        mPendingLook = {};
+    }
+
+    // Everything below sees the interpolated pose, never the raw step state.
+    const SimPose pose = Interpolate(mPrevPose, CurrentPose(), alpha);
 
     XMMATRIX world =
-        XMMatrixRotationX(mCubePitch) *
-        XMMatrixRotationY(mCubeYaw);
+        XMMatrixRotationX(pose.CubePitch) *
+        XMMatrixRotationY(pose.CubeYaw);
 
-    XMVECTOR pos = XMLoadFloat3(&mCameraPos);
+    XMVECTOR pos = XMLoadFloat3(&pose.CameraPos);
     XMVECTOR forward = XMVectorSet(
-        cosf(mPitch) * sinf(mYaw),
-        sinf(mPitch),
-        cosf(mPitch) * cosf(mYaw),
+        cosf(pose.Pitch) * sinf(pose.Yaw),
+        sinf(pose.Pitch),
+        cosf(pose.Pitch) * cosf(pose.Yaw),
         0.0f);
 
     XMMATRIX view = XMMatrixLookAtLH(pos, pos + forward, XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
     XMMATRIX proj = XMLoadFloat4x4(&mProj);
-    XMMATRIX wvp = world * view * proj;
 
-    XMStoreFloat4x4(&mConstants.WorldViewProj, XMMatrixTranspose(wvp));
-    XMStoreFloat4x4(&mConstants.World, XMMatrixTranspose(world));
+    // The PVS is baked in mesh space; it runs before any other culling.
+    mPvsBits = nullptr;
+    if (!mPvs.Empty())
+    {
+        XMFLOAT3 localCam;
+        XMStoreFloat3(&localCam, XMVector3TransformCoord(pos, XMMatrixInverse(nullptr, world)));
+        mPvsBits = mPvs.Lookup(Vec3{ localCam.x, localCam.y, localCam.z });
+    }
+
+    mScene->ResetFrameStats();
+    Sphere meshBounds = { TransformPoint(mMeshLocalBounds.Center, ToMat4(world)), mMeshLocalBounds.Radius };
+    mScene->Move(mMeshHandle, meshBounds);
+    mObjectBounds[0] = meshBounds;
+
+    CullView cullView = { ToMat4(view), ToMat4(proj), mViewportWidth, mViewportHeight };
+    mCull.Run(*mScene, cullView, mObjectBounds.data(), mVisible);
+    mWorldToView = ToMat4(view);
+    mSceneToView = ToMat4(world * view);
+
+    const Vec3 lightDir = Normalize(Vec3{ 0.5f, -1.0f, -0.3f });
+    XMFLOAT3 fwd;
+    XMStoreFloat3(&fwd, forward);
+
+    CascadeCamera cascadeCam = {
+        Vec3{ pose.CameraPos.x, pose.CameraPos.y, pose.CameraPos.z },
+        Vec3{ fwd.x, fwd.y, fwd.z },
+        Vec3{ 0.0f, 1.0f, 0.0f },
+        0.25f * XM_PI, mViewportWidth / mViewportHeight, 0.1f, 5000.0f };
+
+    Vec3 ext = { meshBounds.Radius, meshBounds.Radius, meshBounds.Radius };
+    mShadows.Fit(cascadeCam, lightDir, Aabb{ meshBounds.Center - ext, meshBounds.Center + ext });
+    mShadows.CullCasters(mCull, *mScene, mObjectBounds.data());
+
+    if (!mLights.empty())
+        mLightClusters.Build(ToMat4(view), mLights.data(), (uint32_t)mLights.size());
+
+    XMStoreFloat4x4(&mObjectWorld[0], XMMatrixTranspose(world));
+
+    mConstants.LightDir = XMFLOAT4(lightDir.x, lightDir.y, lightDir.z, 0.0f);
+    const Material& material = mMaterials[MeshMaterial];
+    mConstants.DiffuseColor = material.DiffuseColor;
+    mConstants.SpecularColor = material.SpecularColor;
+    mConstants.Shininess = material.Shininess;
+
+    BuildInstances();
+    BuildDrawList();
+    SortDraws();
+
+    RenderSnapshot& snapshot = mSnapshots[mUpdateSnapshot];
+    snapshot.Constants = mConstants;
+    snapshot.Camera = MakeCameraConstants(pose.CameraPos, pose.Yaw, pose.Pitch);
+    snapshot.CameraPos = pose.CameraPos;
+    snapshot.Yaw = pose.Yaw;
+    snapshot.Pitch = pose.Pitch;
+    snapshot.SampledMouse = input.LookPosition();
+    snapshot.PendingLook = mPendingLook;
+    snapshot.InputTime = inputTime;
+    snapshot.Draws.swap(mDraws);
+}
+
+void CubeRenderer::PrepareFrame()
+{
+    // The ring belongs to the render stage; Update never allocates from it.
+    const RenderSnapshot& snapshot = RenderState();
+
+    UploadAllocation cb = mFrameUpload.Allocate(sizeof(ObjectConstants));
+    memcpy(cb.Cpu, &snapshot.Constants, sizeof(ObjectConstants));
+    mObjectCB = cb.Gpu;
+
+    // Holds the update's camera unless LatchCamera replaces it before submit.
+    UploadAllocation camera = mFrameUpload.Allocate(sizeof(CameraConstants));
+    memcpy(camera.Cpu, &snapshot.Camera, sizeof(CameraConstants));
+    mCameraCB = camera.Gpu;
+    mCameraCpu = (CameraConstants*)camera.Cpu;
+
+    const size_t instanceBytes = snapshot.Instances.size() * sizeof(InstanceData);
+    UploadAllocation instances = mFrameUpload.Allocate(instanceBytes);
+    memcpy(instances.Cpu, snapshot.Instances.data(), instanceBytes);
+    mInstanceBuffer = instances.Gpu;
+}
+
+void CubeRenderer::LatchCamera(const InputDevice& input, float secondsSinceInput)
+{
+    const RenderSnapshot& snapshot = RenderState();
+
+    // Continue from the pose the update produced with what the user has
+    // done since its input was sampled, plus look input the update took in
+    // but no step has applied yet (frames that ran no step). The simulation
+    // never sees this pose; the next update integrates the same input itself.
+    XMFLOAT3 pos = snapshot.CameraPos;
+    float yaw = snapshot.Yaw;
+    float pitch = snapshot.Pitch;
+
+    POINT look = snapshot.PendingLook;
+    if (input.PollKeyDown(VK_RBUTTON))
+    {
+        POINT mouse = input.PollLookPosition();
+        look.x += mouse.x - snapshot.SampledMouse.x;
+        look.y += mouse.y - snapshot.SampledMouse.y;
+    }
+    StepCamera(pos, yaw, pitch, look,
+        [&input](uint8_t vk) { return input.PollKeyDown(vk); }, (std::max)(secondsSinceInput, 0.0f));
+
+    // Upload memory stays mapped and the GPU reads it only after submit.
+    *mCameraCpu = MakeCameraConstants(pos, yaw, pitch);
+}
 
-    mConstants.EyePosW = mCameraPos;
+void CubeRenderer::BuildInstances()
+{
+    mSceneVisible = false;
+    mInstanceItems.clear();
+    for (const VisibleItem& v : mVisible)
+    {
+        if (v.Id == 0)
+            mSceneVisible = true;
+        else
+            mInstanceItems.push_back({ PropMesh, MeshMaterial, v.Id });
+    }
 
-    mConstants.LightDir = XMFLOAT4(0.5f, -1.0f, -0.3f, 0.0f);
-    mConstants.DiffuseColor = XMFLOAT4(0.0f, 0.8f, 0.2f, 1.0f);
-    mConstants.SpecularColor = XMFLOAT4(1, 1, 1, 1);
-    mConstants.Shininess = 16.0f;
+    mBatcher.Build(mInstanceItems.data(), (uint32_t)mInstanceItems.size());
 
-    void* mapped = nullptr;
-    ThrowIfFailed(mConstantUploadBuffer->Map(0, nullptr, &mapped));
-    memcpy(mapped, &mConstants, sizeof(ObjectConstants));
-    mConstantUploadBuffer->Unmap(0, nullptr);
+    // Instance 0 is the scene mesh; batch instances follow in batcher order.
+    const std::vector<uint32_t>& order = mBatcher.Order();
+    std::vector<InstanceData>& out = mSnapshots[mUpdateSnapshot].Instances;
+    out.resize(1 + order.size());
+
+    out[0].World = mObjectWorld[0];
+    for (size_t i = 0; i < order.size(); ++i)
+        out[1 + i].World = mObjectWorld[order[i]];
 }
 
-void CubeRenderer::Draw(ID3D12GraphicsCommandList* cmdList)
+void CubeRenderer::BuildDrawList()
 {
+    mDraws.clear();
+    mDrawDepth.clear();
+
+    // A batch sorts by its nearest instance.
+    const std::vector<uint32_t>& order = mBatcher.Order();
+    for (const InstanceBatch& b : mBatcher.Batches())
+    {
+        float nearest = FLT_MAX;
+        for (uint32_t i = b.FirstInstance; i < b.FirstInstance + b.InstanceCount; ++i)
+            nearest = (std::min)(nearest, TransformPoint(mObjectBounds[order[i]].Center, mWorldToView).z);
+
+        const MeshRange& mesh = mMeshes[b.Mesh];
+        mDraws.push_back({ mesh.IndexCount, mesh.FirstIndex, mesh.BaseVertex, b.Material,
+            1 + b.FirstInstance, b.InstanceCount });
+        mDrawDepth.push_back(nearest);
+    }
+
+    if (!mSceneVisible)
+        return;
+
+    if (!mPvsBits)
+    {
+        mDraws.push_back({ mIndexCount, 0, 0, MeshMaterial, 0, 1 });
+        mDrawDepth.push_back(TransformPoint(mMeshLocalBounds.Center, mSceneToView).z);
+        return;
+    }
+
+    // Clusters are consecutive index ranges; merge neighbours into one draw.
+    const size_t firstClusterDraw = mDraws.size();
+    const std::vector<PvsCluster>& clusters = mPvs.Clusters();
+    for (size_t c = 0; c < clusters.size(); ++c)
+    {
+        if (!(mPvsBits[c >> 6] & (1ULL << (c & 63))))
+            continue;
+
+        const Aabb& box = clusters[c].Bounds;
+        float depth = TransformPoint((box.Min + box.Max) * 0.5f, mSceneToView).z;
+
+        if (mDraws.size() > firstClusterDraw && mDraws.back().FirstIndex + mDraws.back().IndexCount == clusters[c].FirstIndex)
+        {
+            mDraws.back().IndexCount += clusters[c].IndexCount;
+            mDrawDepth.back() = (std::min)(mDrawDepth.back(), depth);
+            continue;
+        }
+        mDraws.push_back({ clusters[c].IndexCount, clusters[c].FirstIndex, 0, MeshMaterial, 0, 1 });
+        mDrawDepth.push_back(depth);
+    }
+}
+
+void CubeRenderer::SortDraws()
+{
+    const uint32_t count = (uint32_t)mDraws.size();
+    mDrawKeys.resize(count);
+    mDrawStates.resize(count);
+
+    // Materials with alpha below one go to the transparent pass, back-to-front.
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const DrawRange& d = mDraws[i];
+        const Material& m = mMaterials[d.Material];
+        const uint32_t pipeline = MakePermutation(m.Features, PixelFeatureMask);
+
+        mDrawStates[i] = { pipeline, d.Material };
+        mDrawKeys[i] = m.DiffuseColor.w < 1.0f ?
+            DrawKey::Transparent(1, pipeline, d.Material, mDrawDepth[i]) :
+            DrawKey::Opaque(0, pipeline, d.Material, mDrawDepth[i]);
+    }
+
+    mUnsortedChanges = CountStateChanges(mDrawStates.data(), nullptr, count);
+    mSorter.Sort(mDrawKeys.data(), count);
+    mSortedChanges = CountStateChanges(mDrawStates.data(), mSorter.Order().data(), count);
+
+    mSortedDraws.clear();
+    for (uint32_t index : mSorter.Order())
+        mSortedDraws.push_back(mDraws[index]);
+    mDraws.swap(mSortedDraws);
+}
+
+void CubeRenderer::RecordDraws(ID3D12GraphicsCommandList* cmdList, uint32_t first, uint32_t count) const
+{
+    if (count == 0)
+        return;
+
     cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
     cmdList->IASetVertexBuffers(0, 1, &mVBV);
     cmdList->IASetIndexBuffer(&mIBV);
 
-    cmdList->SetGraphicsRootConstantBufferView(0, mConstantUploadBuffer->GetGPUVirtualAddress());
-    cmdList->DrawIndexedInstanced(mIndexCount, 1, 0, 0, 0);
+    cmdList->SetGraphicsRootConstantBufferView(0, mObjectCB);
+    cmdList->SetGraphicsRootShaderResourceView(1, mInstanceBuffer);
+    cmdList->SetGraphicsRootConstantBufferView(3, mCameraCB);
+
+    const std::vector<DrawRange>& draws = RenderState().Draws;
+    UINT boundMaterial = UINT_MAX;
+    for (uint32_t i = first; i < first + count; ++i)
+    {
+        if (draws[i].Material != boundMaterial)
+        {
+            boundMaterial = draws[i].Material;
+            cmdList->SetPipelineState(GetPSO(boundMaterial));
+        }
+        // SV_InstanceID does not include StartInstanceLocation, so the
+        // offset into the instance buffer travels as a root constant.
+        const DrawRange& d = draws[i];
+        cmdList->SetGraphicsRoot32BitConstant(2, d.FirstInstance, 0);
+        cmdList->DrawIndexedInstanced(d.IndexCount, d.InstanceCount, d.FirstIndex, d.BaseVertex, 0);
+    }
+}
+
+void CubeRenderer::Draw(ID3D12GraphicsCommandList* cmdList)
+{
+    RecordDraws(cmdList, 0, DrawCount());
 }
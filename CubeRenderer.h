@@ -2,15 +2,22 @@
 #pragma once
 #include "Common.h"
 #include "InputDevice.h"
+#include "ObjLoader.h"
+#include "UploadRing.h"
+#include "GpuMemory.h"
+#include "UploadManager.h"
+#include "ShadowCascades.h"
+#include "ClusteredLighting.h"
+#include "PvsData.h"
+#include "ShaderArchive.h"
+#include "ShaderPermutation.h"
+#include "PsoCache.h"
+#include "InstanceBatcher.h"
+#include "DrawSort.h"
+#include <unordered_map>
 
 struct ObjectConstants
 {
-    XMFLOAT4X4 WorldViewProj;
-    XMFLOAT4X4 World;
-
-    XMFLOAT3   EyePosW;
-    float      pad0;
-
     XMFLOAT4   LightDir;
     XMFLOAT4   DiffuseColor;
 
@@ -19,57 +26,221 @@ struct ObjectConstants
     XMFLOAT3   pad1;
 };
 
+// The view in its own slot (b2), so LatchCamera can rewrite it after the
+// draws that read it have been recorded.
+struct CameraConstants
+{
+    XMFLOAT4X4 ViewProj;
+    XMFLOAT3   EyePosW;
+    float      pad0;
+};
+
+// Per-instance data read by the vertex shader through SV_InstanceID
+struct InstanceData
+{
+    XMFLOAT4X4 World;
+};
+
+// Surface parameters plus the shader features they need; materials that
+// share a feature mask share a PSO.
+struct Material
+{
+    XMFLOAT4 DiffuseColor;
+    XMFLOAT4 SpecularColor;
+    float    Shininess;
+    uint32_t Features;
+};
+
+struct PermutationStats
+{
+    uint32_t Variants = 0;
+    uint64_t BytecodeBytes = 0;
+};
+
 class CubeRenderer
 {
 public:
     CubeRenderer(ID3D12Device* device,
-        ID3D12GraphicsCommandList* cmdList,
-        UINT cbvSrvUavDescriptorSize);
+        UploadManager& uploads,
+        UINT cbvSrvUavDescriptorSize,
+        UploadRing& frameUpload,
+        GpuHeapAllocator& bufferHeap,
+        PsoCache& psoCache);
+    ~CubeRenderer();
 
     void BuildResources();
-    void BuildPSO();
 
-    void Update(float totalTime, float deltaTime, const InputDevice& input);
+    void SetViewport(const D3D12_VIEWPORT& viewport);
+    // Update stage: simulates, culls and fills the update snapshot. May run
+    // on a worker while the render stage below works on the other snapshot.
+    // Runs substeps fixed simulation steps of stepSeconds, then builds the
+    // frame from the state alpha of the way from the previous step to the
+    // last one. inputTime is when input was sampled, on the clock
+    // LatchCamera's caller measures with.
+    void Update(uint32_t substeps, float stepSeconds, float alpha, const InputDevice& input,
+                int64_t inputTime = 0);
+
+    // Neither stage running: the update snapshot becomes the render snapshot.
+    void PublishSnapshot() { mUpdateSnapshot ^= 1; }
+
+    // Render stage: uploads the render snapshot's constants and instances.
+    void PrepareFrame();
+
+    // Render stage, after recording and right before submit: polls input
+    // again and moves the render snapshot's camera by what happened in the
+    // secondsSinceInput since its input was sampled. Only the camera slot
+    // changes; culling keeps the update's camera.
+    void LatchCamera(const InputDevice& input, float secondsSinceInput);
+    int64_t RenderInputTime() const { return RenderState().InputTime; }
     void Draw(ID3D12GraphicsCommandList* cmdList);
 
+    // The frame's draws, recordable in ranges from several threads at once
+    uint32_t DrawCount() const { return (uint32_t)RenderState().Draws.size(); }
+    void RecordDraws(ID3D12GraphicsCommandList* cmdList, uint32_t first, uint32_t count) const;
+
+    CullPipeline& GetCullPipeline() { return mCull; }
+    const ShadowCascades& GetShadowCascades() const { return mShadows; }
+    const LightClusterer& GetLightClusterer() const { return mLightClusters; }
+
+    // Lights binned into view clusters every update; positions in world space.
+    void SetLights(std::vector<SceneLight> lights) { mLights = std::move(lights); }
+    // Bounds of the scene mesh at rest, valid after BuildResources.
+    const Sphere& GetMeshBounds() const { return mMeshLocalBounds; }
+
+    // Copies of a small prop mesh scattered over the scene; set before BuildResources.
+    void SetPropCount(uint32_t count) { mPropCount = count; }
+    const InstanceStats& GetInstanceStats() const { return mBatcher.GetStats(); }
+
+    // State changes of this frame's draws in build order and in sorted order
+    const SortStats& GetUnsortedStateChanges() const { return mUnsortedChanges; }
+    const SortStats& GetSortedStateChanges() const { return mSortedChanges; }
+
     ID3D12RootSignature* GetRootSignature() const { return mRootSignature.Get(); }
-    ID3D12PipelineState* GetPSO() const { return mPSO.Get(); }
+    ID3D12PipelineState* GetPSO(UINT material = 0) const;
+    const PermutationStats& GetPermutationStats() const { return mPermutationStats; }
 
 private:
     void BuildCubeGeometry();     
-    void BuildConstantBuffer();
+    void BuildProps(const Aabb& meshBox, std::vector<VertexPosNormal>& vertices,
+        std::vector<uint32_t>& indices);
     void BuildRootSignature();
+    void BuildInstances();
+    void BuildDrawList();
+    void SortDraws();
+    void LoadShaderArchive();
+    void BuildPSOs();
+    std::future<ComPtr<ID3D12PipelineState>> RequestPSO(PermutationKey permutation,
+        std::vector<ComPtr<ID3DBlob>>& compiled);
 
-    void UpdateCamera(const InputDevice& input, float dt);
-    void UpdateCubeRotation(const InputDevice& input, float dt);
+    void UpdateCamera(const InputDevice& input, POINT look, float dt);
+    CameraConstants MakeCameraConstants(const XMFLOAT3& pos, float yaw, float pitch) const;
+    void UpdateCubeRotation(POINT drag);
 
 private:
     ID3D12Device* mDevice;
-    ID3D12GraphicsCommandList* mCmdList;
+    UploadManager& mUploads;
 
     UINT mCbvSrvUavDescriptorSize;
 
+    // Constant blocks are bump-allocated per frame
+    UploadRing& mFrameUpload;
+    D3D12_GPU_VIRTUAL_ADDRESS mObjectCB = 0;
+    D3D12_GPU_VIRTUAL_ADDRESS mCameraCB = 0;
+    CameraConstants* mCameraCpu = nullptr;   // mapped, written until submit
+
+    // Static geometry is placed into the shared buffer heaps
+    GpuHeapAllocator& mBufferHeap;
     ComPtr<ID3D12Resource> mVertexBuffer;
     ComPtr<ID3D12Resource> mIndexBuffer;
-
-    
-    ComPtr<ID3D12Resource> mVBUpload;
-    ComPtr<ID3D12Resource> mIBUpload;
-
-    ComPtr<ID3D12Resource> mConstantBuffer;
-    ComPtr<ID3D12Resource> mConstantUploadBuffer;
+    GpuAllocation mVBAlloc;
+    GpuAllocation mIBAlloc;
 
     D3D12_VERTEX_BUFFER_VIEW mVBV = {};
     D3D12_INDEX_BUFFER_VIEW  mIBV = {};
 
     UINT mIndexCount = 0;
 
+    // Index ranges in the shared vertex/index buffers
+    struct MeshRange
+    {
+        UINT IndexCount;
+        UINT FirstIndex;
+        INT  BaseVertex;
+    };
+    std::vector<MeshRange> mMeshes;
+    static const UINT SceneMesh = 0;
+    static const UINT PropMesh = 1;
+
+    struct DrawRange
+    {
+        UINT IndexCount;
+        UINT FirstIndex;
+        INT  BaseVertex;
+        UINT Material;
+        UINT FirstInstance;
+        UINT InstanceCount;
+    };
+    std::vector<DrawRange> mDraws;
+
+    // What the render stage needs from one update. Update fills one while
+    // the render stage reads the other; PublishSnapshot flips them.
+    struct RenderSnapshot
+    {
+        ObjectConstants Constants;
+        CameraConstants Camera;
+        XMFLOAT3 CameraPos{};    // pose and cursor the camera came from
+        float    Yaw = 0.0f;
+        float    Pitch = 0.0f;
+        POINT    SampledMouse{};     // InputDevice::LookPosition
+        POINT    PendingLook{};      // look input no step has consumed yet
+        int64_t  InputTime = 0;
+        std::vector<InstanceData> Instances;   // instance 0 is the scene mesh
+        std::vector<DrawRange> Draws;
+    };
+    RenderSnapshot mSnapshots[2];
+    uint32_t mUpdateSnapshot = 0;
+    const RenderSnapshot& RenderState() const { return mSnapshots[mUpdateSnapshot ^ 1]; }
+
+    // Sort keys are rebuilt each frame from view depth and draw state;
+    // mDrawDepth runs parallel to mDraws until SortDraws reorders them.
+    std::vector<float>     mDrawDepth;
+    std::vector<uint64_t>  mDrawKeys;
+    std::vector<DrawState> mDrawStates;
+    std::vector<DrawRange> mSortedDraws;
+    DrawSorter mSorter;
+    SortStats  mUnsortedChanges;
+    SortStats  mSortedChanges;
+    Mat4 mWorldToView = {};
+    Mat4 mSceneToView = {};
+
+    // Object 0 is the scene mesh, 1..mPropCount are props. Visible props are
+    // batched by mesh and material; their transforms go into a per-frame
+    // structured buffer, instance 0 of which is the scene mesh.
+    uint32_t mPropCount = 0;
+    std::vector<XMFLOAT4X4> mObjectWorld;
+    std::vector<InstanceItem> mInstanceItems;
+    InstanceBatcher mBatcher;
+    D3D12_GPU_VIRTUAL_ADDRESS mInstanceBuffer = 0;
+    bool mSceneVisible = false;
+
     ObjectConstants mConstants;
 
+    ShaderArchive mShaders;
+    PsoCache& mPsoCache;
+
     ComPtr<ID3D12RootSignature> mRootSignature;
-    ComPtr<ID3D12PipelineState> mPSO;
+    uint64_t mRootSignatureHash = 0;
+    // One PSO per permutation referenced by mMaterials
+    std::vector<Material> mMaterials = {
+        { XMFLOAT4(0.0f, 0.8f, 0.2f, 1.0f), XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f), 16.0f, Feature_Specular },
+    };
+    static const UINT MeshMaterial = 0;
+    std::unordered_map<PermutationKey, ComPtr<ID3D12PipelineState>> mPsos;
+    PermutationStats mPermutationStats;
 
     XMFLOAT4X4 mProj;
+    float mViewportWidth = 1280.0f;
+    float mViewportHeight = 720.0f;
 
     // Camera
     XMFLOAT3 mCameraPos = { 0.0f, 2.0f, -5.0f };
@@ -79,4 +250,41 @@ private:
     // Object rotation
     float mCubeYaw = 0.0f;
     float mCubePitch = 0.0f;
+
+    // The simulated pose above as of the step before the last one, for
+    // interpolation, and mouse motion waiting for the next step.
+    struct SimPose
+    {
+        XMFLOAT3 CameraPos;
+        float Yaw;
+        float Pitch;
+        float CubeYaw;
+        float CubePitch;
+    };
+    SimPose CurrentPose() const { return { mCameraPos, mYaw, mPitch, mCubeYaw, mCubePitch }; }
+    static SimPose Interpolate(const SimPose& a, const SimPose& b, float t);
+
+    SimPose mPrevPose = {};
+    POINT   mPendingLook = {};
+    POINT   mPendingDrag = {};
+
+    // Scene index
+    std::unique_ptr<SceneOctree> mScene;
+    SceneOctree::Handle mMeshHandle = SceneOctree::InvalidHandle;
+    Sphere mMeshLocalBounds = {};
+    std::vector<Sphere> mObjectBounds;
+
+    CullPipeline mCull;
+    std::vector<VisibleItem> mVisible;
+
+    // Shadow cascades are fitted and culled on the CPU ahead of a shadow pass
+    ShadowCascades mShadows;
+
+    // Point/spot lights binned into view-space clusters for forward shading
+    std::vector<SceneLight> mLights;
+    LightClusterer mLightClusters;
+
+    // Precomputed visibility for the static mesh, looked up by camera cell
+    PvsData mPvs;
+    const uint64_t* mPvsBits = nullptr;
 };
@@ -1,11 +1,13 @@
-cbuffer ObjectCB : register(b0)
+// The view has its own slot; it is rewritten just before submit.
+cbuffer CameraCB : register(b2)
 {
-    float4x4 gWorldViewProj;
-    float4x4 gWorld;
-
+    float4x4 gViewProj;
     float3 gEyePosW;
     float pad0;
+};
 
+cbuffer ObjectCB : register(b0)
+{
     float4 gLightDir; // (xyz)  
     float4 gDiffuseColor; //  
     float4 gSpecularColor; //  
@@ -13,6 +15,18 @@ cbuffer ObjectCB : register(b0)
     float3 pad1;
 };
 
+struct InstanceData
+{
+    float4x4 World;
+};
+StructuredBuffer<InstanceData> gInstances : register(t0);
+
+// SV_InstanceID starts at 0 for every draw; this is the draw's offset into gInstances.
+cbuffer DrawCB : register(b1)
+{
+    uint gFirstInstance;
+};
+
 struct VSInput
 {
     float3 Pos : POSITION;
@@ -26,15 +40,17 @@ struct VSOutput
     float3 NormalW : NORMAL;
 };
 
-VSOutput VSMain(VSInput vin)
+VSOutput VSMain(VSInput vin, uint instanceId : SV_InstanceID)
 {
     VSOutput vout;
 
-    float4 posW = mul(float4(vin.Pos, 1.0f), gWorld);
+    float4x4 world = gInstances[gFirstInstance + instanceId].World;
+
+    float4 posW = mul(float4(vin.Pos, 1.0f), world);
     vout.PosW = posW.xyz;
-    vout.PosH = mul(posW, gWorldViewProj);
+    vout.PosH = mul(posW, gViewProj);
 
-    float3 nW = mul(float4(vin.Normal, 0.0f), gWorld).xyz;
+    float3 nW = mul(float4(vin.Normal, 0.0f), world).xyz;
     vout.NormalW = normalize(nW);
 
     return vout;
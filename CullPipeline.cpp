@@ -0,0 +1,243 @@
+// CullPipeline.cpp
+#include "CullPipeline.h"
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define CULL_USE_SSE 1
+#endif
+
+void ClassifyFrustum(const float* cx, const float* cy, const float* cz, const float* r,
+                     uint32_t count, const Frustum& frustum, uint8_t* outInside)
+{
+#if CULL_USE_SSE
+    __m128 pn[6][4];
+    for (int p = 0; p < 6; ++p)
+    {
+        pn[p][0] = _mm_set1_ps(frustum.Planes[p].N.x);
+        pn[p][1] = _mm_set1_ps(frustum.Planes[p].N.y);
+        pn[p][2] = _mm_set1_ps(frustum.Planes[p].N.z);
+        pn[p][3] = _mm_set1_ps(frustum.Planes[p].D);
+    }
+    const __m128 zero = _mm_setzero_ps();
+
+    for (uint32_t i = 0; i < count; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(cx + i);
+        __m128 y = _mm_loadu_ps(cy + i);
+        __m128 z = _mm_loadu_ps(cz + i);
+        __m128 negR = _mm_sub_ps(zero, _mm_loadu_ps(r + i));
+
+        __m128 inside = _mm_cmpeq_ps(zero, zero);
+        for (int p = 0; p < 6; ++p)
+        {
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, pn[p][0]), _mm_mul_ps(y, pn[p][1])),
+                                  _mm_add_ps(_mm_mul_ps(z, pn[p][2]), pn[p][3]));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(d, negR));
+        }
+
+        int mask = _mm_movemask_ps(inside);
+        outInside[i + 0] = (uint8_t)(mask & 1);
+        outInside[i + 1] = (uint8_t)((mask >> 1) & 1);
+        outInside[i + 2] = (uint8_t)((mask >> 2) & 1);
+        outInside[i + 3] = (uint8_t)((mask >> 3) & 1);
+    }
+#else
+    for (uint32_t i = 0; i < count; ++i)
+        outInside[i] = (uint8_t)frustum.Intersects({ { cx[i], cy[i], cz[i] }, r[i] });
+#endif
+}
+
+void ClassifyScreenSize(const float* cx, const float* cy, const float* cz, const float* r,
+                        uint32_t count, const Mat4& view, float pixelScale, float minPixels,
+                        uint8_t* outSmall)
+{
+    // Only view-space z is needed: the third column of the view matrix.
+    const float vx = view.m[0][2];
+    const float vy = view.m[1][2];
+    const float vz = view.m[2][2];
+    const float vw = view.m[3][2];
+
+#if CULL_USE_SSE
+    const __m128 mx = _mm_set1_ps(vx);
+    const __m128 my = _mm_set1_ps(vy);
+    const __m128 mz = _mm_set1_ps(vz);
+    const __m128 mw = _mm_set1_ps(vw);
+    const __m128 scale = _mm_set1_ps(pixelScale);
+    const __m128 minPx = _mm_set1_ps(minPixels);
+    const __m128 eps = _mm_set1_ps(1e-12f);
+
+    for (uint32_t i = 0; i < count; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(cx + i);
+        __m128 y = _mm_loadu_ps(cy + i);
+        __m128 z = _mm_loadu_ps(cz + i);
+        __m128 rad = _mm_loadu_ps(r + i);
+
+        __m128 depth = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, mx), _mm_mul_ps(y, my)),
+                                  _mm_add_ps(_mm_mul_ps(z, mz), mw));
+
+        // Angular radius of a sphere: r / sqrt(z^2 - r^2).
+        __m128 d2 = _mm_sub_ps(_mm_mul_ps(depth, depth), _mm_mul_ps(rad, rad));
+        __m128 px = _mm_div_ps(_mm_mul_ps(rad, scale), _mm_sqrt_ps(_mm_max_ps(d2, eps)));
+
+        __m128 inFront = _mm_cmpgt_ps(depth, rad);
+        __m128 isSmall = _mm_and_ps(inFront, _mm_cmplt_ps(px, minPx));
+
+        int mask = _mm_movemask_ps(isSmall);
+        outSmall[i + 0] = (uint8_t)(mask & 1);
+        outSmall[i + 1] = (uint8_t)((mask >> 1) & 1);
+        outSmall[i + 2] = (uint8_t)((mask >> 2) & 1);
+        outSmall[i + 3] = (uint8_t)((mask >> 3) & 1);
+    }
+#else
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        float depth = cx[i] * vx + cy[i] * vy + cz[i] * vz + vw;
+        float d2 = (std::max)(depth * depth - r[i] * r[i], 1e-12f);
+        float px = r[i] * pixelScale / std::sqrt(d2);
+        outSmall[i] = (uint8_t)(depth > r[i] && px < minPixels);
+    }
+#endif
+}
+
+void CullPipeline::GatherCandidates(const Sphere* bounds)
+{
+    const uint32_t count = (uint32_t)mCandidates.size();
+    const uint32_t padded = (count + 3u) & ~3u;
+
+    mCx.resize(padded);
+    mCy.resize(padded);
+    mCz.resize(padded);
+    mR.resize(padded);
+    mInside.resize(padded);
+    mSmall.resize(padded);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const Sphere& s = bounds[mCandidates[i]];
+        mCx[i] = s.Center.x;
+        mCy[i] = s.Center.y;
+        mCz[i] = s.Center.z;
+        mR[i] = s.Radius;
+    }
+
+    // Padding lanes are zero-radius points at the origin; their results are ignored.
+    for (uint32_t i = count; i < padded; ++i)
+        mCx[i] = mCy[i] = mCz[i] = mR[i] = 0.0f;
+}
+
+void CullPipeline::FrustumStage(const Frustum& frustum)
+{
+    const uint32_t count = (uint32_t)mCandidates.size();
+    ClassifyFrustum(mCx.data(), mCy.data(), mCz.data(), mR.data(), (uint32_t)mCx.size(),
+        frustum, mInside.data());
+
+    // Compact survivors in place so the next stage only sees them.
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (!mInside[i])
+            continue;
+        mCandidates[kept] = mCandidates[i];
+        mCx[kept] = mCx[i];
+        mCy[kept] = mCy[i];
+        mCz[kept] = mCz[i];
+        mR[kept] = mR[i];
+        ++kept;
+    }
+
+    const uint32_t padded = (kept + 3u) & ~3u;
+    for (uint32_t i = kept; i < padded; ++i)
+        mCx[i] = mCy[i] = mCz[i] = mR[i] = 0.0f;
+
+    mCandidates.resize(kept);
+    mCx.resize(padded);
+    mCy.resize(padded);
+    mCz.resize(padded);
+    mR.resize(padded);
+    mSmall.resize(padded);
+}
+
+void CullPipeline::CullFrustum(const SceneOctree& scene, const Frustum& frustum, const Sphere* bounds,
+                               std::vector<uint32_t>& out)
+{
+    mCandidates.clear();
+    scene.QueryFrustum(frustum, mCandidates, false);
+
+    GatherCandidates(bounds);
+    FrustumStage(frustum);
+
+    out.assign(mCandidates.begin(), mCandidates.end());
+}
+
+void CullPipeline::ScreenSizeStage(const CullView& view)
+{
+    const uint32_t padded = (uint32_t)mCx.size();
+
+    // Pixels per unit of tan(angle), taking the larger of the two axes so a
+    // sphere is only called small if it is small in both.
+    float pixelScale = (std::max)(
+        view.Proj.m[0][0] * 0.5f * view.ViewportWidth,
+        view.Proj.m[1][1] * 0.5f * view.ViewportHeight);
+
+    ClassifyScreenSize(mCx.data(), mCy.data(), mCz.data(), mR.data(), padded,
+        view.View, pixelScale, mScreenCull.MinPixelRadius, mSmall.data());
+}
+
+void CullPipeline::Run(const SceneOctree& scene, const CullView& view, const Sphere* bounds,
+                       std::vector<VisibleItem>& out)
+{
+    out.clear();
+    mStats = CullStats();
+
+    const Frustum frustum = Frustum::FromViewProj(Mul(view.View, view.Proj));
+
+    mCandidates.clear();
+    scene.QueryFrustum(frustum, mCandidates, false);
+
+    GatherCandidates(bounds);
+    FrustumStage(frustum);
+    mStats.Candidates = (uint32_t)mCandidates.size();
+
+    if (!mScreenCull.Enabled)
+    {
+        for (uint32_t id : mCandidates)
+            out.push_back({ id, 0 });
+        mStats.Visible = (uint32_t)out.size();
+        mFramesAccum++;
+        return;
+    }
+
+    ScreenSizeStage(view);
+
+    for (uint32_t i = 0; i < mStats.Candidates; ++i)
+    {
+        if (!mSmall[i])
+        {
+            out.push_back({ mCandidates[i], 0 });
+        }
+        else if (mScreenCull.DemoteToLowestLod)
+        {
+            out.push_back({ mCandidates[i], mScreenCull.LowestLod });
+            mStats.SmallDemoted++;
+        }
+        else
+        {
+            mStats.SmallDropped++;
+        }
+    }
+
+    mStats.Visible = (uint32_t)out.size();
+    mSavedAccum += mStats.SmallDropped;
+    mFramesAccum++;
+}
+
+uint64_t CullPipeline::TakeSavedDraws(uint32_t& frames)
+{
+    uint64_t saved = mSavedAccum;
+    frames = mFramesAccum;
+    mSavedAccum = 0;
+    mFramesAccum = 0;
+    return saved;
+}
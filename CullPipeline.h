@@ -0,0 +1,88 @@
+// CullPipeline.h
+#pragma once
+#include "SceneOctree.h"
+#include <vector>
+
+struct CullView
+{
+    Mat4  View;
+    Mat4  Proj;
+    float ViewportWidth;
+    float ViewportHeight;
+};
+
+struct ScreenCullSettings
+{
+    bool    Enabled = true;
+    float   MinPixelRadius = 2.0f;    // projected radius below this counts as small
+    bool    DemoteToLowestLod = false; // false: drop the draw, true: keep it at LowestLod
+    uint8_t LowestLod = 0;
+};
+
+struct VisibleItem
+{
+    uint32_t Id;
+    uint8_t  Lod;
+};
+
+struct CullStats
+{
+    uint32_t Candidates = 0;   // survivors of the octree and frustum stages
+    uint32_t SmallDropped = 0;
+    uint32_t SmallDemoted = 0;
+    uint32_t Visible = 0;
+};
+
+// Per-frame visibility: a node-level octree query, then a sphere/frustum
+// stage and a screen-space size stage. Both stages work on SoA copies of
+// the candidate bounds, four spheres per iteration.
+class CullPipeline
+{
+public:
+    void SetScreenCull(const ScreenCullSettings& settings) { mScreenCull = settings; }
+    const ScreenCullSettings& GetScreenCull() const { return mScreenCull; }
+
+    // bounds[id] must be the world sphere of the object whose user data is id.
+    void Run(const SceneOctree& scene, const CullView& view, const Sphere* bounds,
+             std::vector<VisibleItem>& out);
+
+    // Octree query plus the frustum stage only; used for shadow casters and
+    // other views that have no screen-size criterion.
+    void CullFrustum(const SceneOctree& scene, const Frustum& frustum, const Sphere* bounds,
+                     std::vector<uint32_t>& out);
+
+    const CullStats& GetStats() const { return mStats; }
+
+    // Draws saved by the size stage since the last call, for flythrough reports.
+    uint64_t TakeSavedDraws(uint32_t& frames);
+
+private:
+    void GatherCandidates(const Sphere* bounds);
+    void FrustumStage(const Frustum& frustum);
+    void ScreenSizeStage(const CullView& view);
+
+private:
+    ScreenCullSettings mScreenCull;
+    CullStats mStats;
+
+    uint64_t mSavedAccum = 0;
+    uint32_t mFramesAccum = 0;
+
+    std::vector<uint32_t> mCandidates;
+
+    // SoA, padded to a multiple of 4
+    std::vector<float>   mCx, mCy, mCz, mR;
+    std::vector<uint8_t> mInside;
+    std::vector<uint8_t> mSmall;
+};
+
+// Sets outInside[i] to 1 when sphere i is not fully behind any frustum plane.
+// count must be a multiple of 4.
+void ClassifyFrustum(const float* cx, const float* cy, const float* cz, const float* r,
+                     uint32_t count, const Frustum& frustum, uint8_t* outInside);
+
+// Sets outSmall[i] to 1 when sphere i projects to less than minPixels and the
+// camera is outside it. count must be a multiple of 4.
+void ClassifyScreenSize(const float* cx, const float* cy, const float* cz, const float* r,
+                        uint32_t count, const Mat4& view, float pixelScale, float minPixels,
+                        uint8_t* outSmall);
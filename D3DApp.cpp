@@ -2,6 +2,7 @@
 #include "D3DApp.h"
 #include <sstream>
 #include <iomanip>
+#include <chrono>
 
 D3DApp* D3DApp::mApp = nullptr;
 
@@ -27,6 +28,7 @@ bool D3DApp::Initialize()
         return false;
 
     mInput.Initialize(m_hWnd);
+    mRawMouse = std::make_unique<RawMouseInput>();
 
     if (!InitDirect3D())
         return false;
@@ -117,7 +119,33 @@ ThrowIfFailed(mDevice->CreateCommandList(
 
 mCommandList->Close();
 
-ThrowIfFailed(mDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&mFence)));
+mGpuQueue = std::make_unique<D3D12GpuQueue>(mDevice.Get(), mCommandQueue.Get());
+mFrameRing = std::make_unique<FrameRing>(*mGpuQueue, FrameResourceCount);
+
+for (int i = 0; i < FrameResourceCount; ++i)
+{
+    ThrowIfFailed(mDevice->CreateCommandAllocator(
+        D3D12_COMMAND_LIST_TYPE_DIRECT,
+        IID_PPV_ARGS(&mFrameAllocators[i])));
+}
+
+mCommandListPool = std::make_unique<CommandListPool>(mDevice.Get(), FrameResourceCount);
+
+mFrameUpload = std::make_unique<D3D12UploadRing>(mDevice.Get(), FrameUploadSize);
+mBufferHeap = std::make_unique<GpuHeapAllocator>(mDevice.Get(), D3D12_HEAP_TYPE_DEFAULT,
+    D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS, BufferHeapSize);
+mUploads = std::make_unique<UploadManager>(mDevice.Get(), StagingSize);
+
+mSrvStaging = std::make_unique<StagingDescriptorHeap>(mDevice.Get(),
+    D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, StagingDescriptorCount);
+mSrvHeap = std::make_unique<ShaderVisibleDescriptorHeap>(mDevice.Get(),
+    BindlessDescriptorCount, FrameDescriptorCount);
+
+wchar_t exePath[MAX_PATH];
+GetModuleFileNameW(nullptr, exePath, MAX_PATH);
+wchar_t* lastSlash = wcsrchr(exePath, L'\\');
+if (lastSlash) *(lastSlash + 1) = 0;
+mPsoCache = std::make_unique<PsoCache>(mDevice.Get(), std::wstring(exePath) + L"psocache.bin");
 
 CreateSwapChain();
 CreateRtvAndDsvDescriptorHeaps();
@@ -175,6 +203,7 @@ void D3DApp::CreateRtvAndDsvDescriptorHeaps()
     for (int i = 0; i < SwapChainBufferCount; ++i)
     {
         ThrowIfFailed(mSwapChain->GetBuffer(i, IID_PPV_ARGS(&mSwapChainBuffer[i])));
+        mResourceStates.Register(mSwapChainBuffer[i].Get(), 1, D3D12_RESOURCE_STATE_PRESENT);
         mDevice->CreateRenderTargetView(mSwapChainBuffer[i].Get(), nullptr, rtvHandle);
         rtvHandle.Offset(1, mRtvDescriptorSize);
     }
@@ -209,6 +238,7 @@ void D3DApp::CreateDepthStencilBuffer()
         D3D12_RESOURCE_STATE_DEPTH_WRITE,
         &clearValue,
         IID_PPV_ARGS(&mDepthStencilBuffer)));
+    mResourceStates.Register(mDepthStencilBuffer.Get(), 1, D3D12_RESOURCE_STATE_DEPTH_WRITE);
 
     mDevice->CreateDepthStencilView(
         mDepthStencilBuffer.Get(),
@@ -218,16 +248,8 @@ void D3DApp::CreateDepthStencilBuffer()
 
 void D3DApp::FlushCommandQueue()
 {
-    mCurrentFence++;
-    ThrowIfFailed(mCommandQueue->Signal(mFence.Get(), mCurrentFence));
-
-    if (mFence->GetCompletedValue() < mCurrentFence)
-    {
-        HANDLE eventHandle = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-        ThrowIfFailed(mFence->SetEventOnCompletion(mCurrentFence, eventHandle));
-        WaitForSingleObject(eventHandle, INFINITE);
-        CloseHandle(eventHandle);
-    }
+    if (mFrameRing)
+        mFrameRing->WaitIdle();
 }
 
 void D3DApp::CalculateFrameStats()
@@ -245,12 +267,28 @@ void D3DApp::CalculateFrameStats()
         outs << mMainWndCaption
             << L" | Time: " << std::fixed << std::setprecision(1) << totalTime << L"s"
             << L" | FPS: " << std::setprecision(0) << fps
-            << L" | ms: " << std::setprecision(2) << mspf;
+            << L" | ms: " << std::setprecision(2) << mspf
+            << L" | update/render/frame: " << mUpdateMs / mFrameCount << L"/" << mRenderMs / mFrameCount
+            << L"/" << mFrameMs / mFrameCount << (mPipelineFrames ? L" pipelined" : L" serial")
+            << FrameStatsText();
+
+        PacerStats pace = mPacer.GetStats();
+        outs << L" | pace";
+        if (mPacer.TargetRate() > 0.0)
+            outs << L" " << std::setprecision(0) << mPacer.TargetRate() << L"Hz";
+        outs << L": " << std::setprecision(2) << pace.MeanIntervalMs << L" +/- " << pace.JitterMs
+            << L" ms (max " << pace.MaxIntervalMs << L"), sleep/spin " << pace.SleepMs << L"/" << pace.SpinMs
+            << L" ms, missed " << pace.Missed << L", present predicted within " << pace.PredictionErrorMs << L" ms";
+        mPacer.ResetStats();
+
+        if (mRawMouse && mRawMouse->Dropped() > 0)
+            outs << L" | raw mouse samples dropped: " << mRawMouse->Dropped();
 
         SetWindowTextW(m_hWnd, outs.str().c_str());
 
         mFrameCount = 0;
         mTimeElapsed += 1.0f;
+        mUpdateMs = mRenderMs = mFrameMs = 0.0;
     }
 }
 
@@ -268,19 +306,98 @@ int D3DApp::Run()
         }
         else
         {
+            mPacer.WaitForNextFrame();
             mTimer.Tick();
+            // Motion up to the tick belongs to this frame; later samples wait.
+            DrainRawInput(mTimer.TickCounter());
             mInput.BeginFrame();
 
+            RunFrame();
             CalculateFrameStats(); 
-
-            Update(mTimer);
-            Draw(mTimer);
         }
     }
 
+    // Let a pipelined Draw's frame retire before anything is torn down.
+    FlushCommandQueue();
     return (int)msg.wParam;
 }
 
+void D3DApp::RunFrame()
+{
+    using Clock = std::chrono::steady_clock;
+    auto msSince = [](Clock::time_point t) { return std::chrono::duration<double, std::milli>(Clock::now() - t).count(); };
+    const Clock::time_point frameStart = Clock::now();
+
+    mFrameInput = mInput;
+    mFrameInputTime = mPacerClock.Now();
+    mFrameTimer = mTimer;
+
+    double updateMs = 0.0;
+    JobCounter updateDone;
+    auto update = [this, &updateMs, msSince]()
+        {
+            Clock::time_point start = Clock::now();
+            Update(mFrameTimer);
+            updateMs = msSince(start);
+        };
+
+    // Pipelined, the update has to stay off this thread: on its own deque a
+    // ParallelFor or Wait during Draw would pop it and run it inline, and
+    // the overlap would be gone. Serial, this thread waits for it anyway.
+    if (mPipelineFrames)
+        Jobs().RunOnWorker(update, &updateDone);
+    else
+        Jobs().Run(update, &updateDone);
+
+    // Serial: draw what was just updated. Pipelined: draw the previous
+    // update while this one runs, trading a frame of latency for overlap.
+    if (!mPipelineFrames)
+    {
+        Jobs().Wait(updateDone);
+        PublishUpdate();
+        mHasPublishedUpdate = true;
+    }
+
+    Clock::time_point renderStart = Clock::now();
+    if (mHasPublishedUpdate)
+        RenderFrame();
+    mRenderMs += msSince(renderStart);
+
+    if (mPipelineFrames)
+    {
+        Jobs().Wait(updateDone);
+        PublishUpdate();
+        mHasPublishedUpdate = true;
+    }
+
+    mUpdateMs += updateMs;
+    mFrameMs += msSince(frameStart);
+}
+
+void D3DApp::DrainRawInput(int64_t until)
+{
+    if (mRawMouse && mRawMouse->Active())
+        mRawMouse->Drain(until, mInput);
+}
+
+void D3DApp::RenderFrame()
+{
+    mFrameRing->BeginFrame();
+    mFrameUpload->Ring().Reclaim(mFrameRing->CompletedFence());
+    mUploads->Reclaim();
+    mSrvHeap->Reclaim(mFrameRing->CompletedFence());
+
+    // Anything streamed for this frame must land before it is read.
+    mUploads->WaitOnQueue(mCommandQueue.Get(), mUploads->Flush());
+
+    Draw(mFrameTimer);
+    mPacer.MarkPresented();
+
+    mFrameRing->EndFrame();
+    mFrameUpload->Ring().EndBatch(mFrameRing->LastSubmittedFence());
+    mSrvHeap->EndFrame(mFrameRing->LastSubmittedFence());
+}
+
 ID3D12Resource* D3DApp::CurrentBackBuffer() const
 {
     return mSwapChainBuffer[mCurrBackBuffer].Get();
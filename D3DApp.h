@@ -3,6 +3,17 @@
 #include "Common.h"
 #include "Timer.h"
 #include "InputDevice.h"
+#include "GpuQueue.h"
+#include "UploadBuffer.h"
+#include "GpuMemory.h"
+#include "UploadManager.h"
+#include "CommandListPool.h"
+#include "DescriptorHeaps.h"
+#include "PsoCache.h"
+#include "ResourceStateTracker.h"
+#include "Parallel.h"
+#include "FramePacer.h"
+#include "RawMouseInput.h"
 
 class D3DApp
 {
@@ -16,9 +27,15 @@ public:
 
     //   
     virtual void OnResize();
+    // With pipelining, Update for frame N+1 runs on a worker while Draw
+    // records frame N on the main thread. Update may only touch simulation
+    // state and the snapshot it is filling; it reads input from mFrameInput.
     virtual void Update(const GameTimer& gt) = 0;
     virtual void Draw(const GameTimer& gt) = 0;
 
+    // Main thread, neither stage running: hand the finished update to Draw.
+    virtual void PublishUpdate() {}
+
     HWND GetHwnd() const { return m_hWnd; }
 
 protected:
@@ -31,6 +48,11 @@ protected:
     void FlushCommandQueue();
 
     void CalculateFrameStats(); 
+    void RunFrame();
+    void RenderFrame();
+    // Moves raw mouse samples stamped up to until into mInput.
+    void DrainRawInput(int64_t until);
+    virtual std::wstring FrameStatsText() { return std::wstring(); }
 
 protected:
     static D3DApp* mApp; 
@@ -43,8 +65,19 @@ protected:
 
     GameTimer mTimer;
 
+    // Paces frame starts; unpaced (target 0) unless the app sets a rate
+    SteadyPacerClock mPacerClock;
+    FramePacer       mPacer{ mPacerClock };
+
     
     InputDevice mInput;
+    // Relative mouse motion read on its own thread, drained into mInput
+    std::unique_ptr<RawMouseInput> mRawMouse;
+    // Copies taken at the start of a frame; the message pump keeps changing
+    // mInput and mTimer while Update runs.
+    InputDevice mFrameInput;
+    GameTimer   mFrameTimer;
+    int64_t     mFrameInputTime = 0;   // mPacerClock time of the copy
 
     
     std::wstring mMainWndCaption = L"Dx12 Cube";
@@ -53,22 +86,62 @@ protected:
     int   mFrameCount = 0;
     float mTimeElapsed = 0.0f;
 
+    // Update of the next frame overlaps Draw of the current one
+    bool   mPipelineFrames = true;
+    bool   mHasPublishedUpdate = false;
+    double mUpdateMs = 0.0;   // stage times summed over the stats window
+    double mRenderMs = 0.0;
+    double mFrameMs = 0.0;
+
     
     ComPtr<IDXGIFactory4>       mDxgiFactory;
     ComPtr<ID3D12Device>        mDevice;
-    ComPtr<ID3D12Fence>         mFence;
-    UINT64                      mCurrentFence = 0;
 
     ComPtr<ID3D12CommandQueue>      mCommandQueue;
     ComPtr<ID3D12CommandAllocator>  mCommandAllocator;
     ComPtr<ID3D12GraphicsCommandList> mCommandList;
 
+    // Frames in flight: the CPU only waits for a slot when it comes round again
+    static const int FrameResourceCount = 3;
+    std::unique_ptr<D3D12GpuQueue>  mGpuQueue;
+    std::unique_ptr<FrameRing>      mFrameRing;
+    ComPtr<ID3D12CommandAllocator>  mFrameAllocators[FrameResourceCount];
+
+    // Extra lists for recording a frame on worker threads
+    std::unique_ptr<CommandListPool> mCommandListPool;
+
+    // Per-frame constant data, retired by the frame fences
+    static const UINT64 FrameUploadSize = 8 * 1024 * 1024;
+    std::unique_ptr<D3D12UploadRing> mFrameUpload;
+
+    // Default-heap buffers are placed into shared heaps of this size
+    static const UINT64 BufferHeapSize = 64 * 1024 * 1024;
+    std::unique_ptr<GpuHeapAllocator> mBufferHeap;
+
+    // Resource data is streamed on a copy queue the graphics queue waits on
+    static const UINT64 StagingSize = 32 * 1024 * 1024;
+    std::unique_ptr<UploadManager> mUploads;
+
+    // Persistent CBV/SRV/UAVs are created in staging and copied to the
+    // shader-visible heap as bindless slots or per-frame tables
+    static const uint32_t StagingDescriptorCount = 4096;
+    static const uint32_t BindlessDescriptorCount = 16384;
+    static const uint32_t FrameDescriptorCount = 8192;
+    std::unique_ptr<StagingDescriptorHeap>       mSrvStaging;
+    std::unique_ptr<ShaderVisibleDescriptorHeap> mSrvHeap;
+
+    // Compiled pipelines persisted next to the executable between runs
+    std::unique_ptr<PsoCache> mPsoCache;
+
     static const int SwapChainBufferCount = 2;
     ComPtr<IDXGISwapChain>      mSwapChain;
     int                         mCurrBackBuffer = 0;
     ComPtr<ID3D12Resource>      mSwapChainBuffer[SwapChainBufferCount];
     ComPtr<ID3D12Resource>      mDepthStencilBuffer;
 
+    // States of the swap chain and depth buffers between submissions
+    ResourceStateRegistry       mResourceStates;
+
     ComPtr<ID3D12DescriptorHeap> mRtvHeap;
     ComPtr<ID3D12DescriptorHeap> mDsvHeap;
 
@@ -80,6 +153,9 @@ protected:
     D3D12_RECT     mScissorRect;
 
 protected:
+    UINT CurrentFrameIndex() const { return mFrameRing->CurrentSlot(); }
+    ID3D12CommandAllocator* CurrentFrameAllocator() const { return mFrameAllocators[CurrentFrameIndex()].Get(); }
+
     ID3D12Resource* CurrentBackBuffer() const;
     D3D12_CPU_DESCRIPTOR_HANDLE CurrentBackBufferView() const;
     D3D12_CPU_DESCRIPTOR_HANDLE DepthStencilView() const;
@@ -0,0 +1,101 @@
+// DescriptorAllocator.cpp
+#include "DescriptorAllocator.h"
+#include <iterator>
+#include <stdexcept>
+
+DescriptorFreeList::DescriptorFreeList(uint32_t first, uint32_t capacity)
+    : mCapacity(capacity)
+{
+    if (capacity > 0)
+        mFree[first] = capacity;
+}
+
+uint32_t DescriptorFreeList::Allocate(uint32_t count)
+{
+    for (auto it = mFree.begin(); it != mFree.end(); ++it)
+    {
+        if (it->second < count)
+            continue;
+
+        uint32_t index = it->first;
+        uint32_t rest = it->second - count;
+        mFree.erase(it);
+        if (rest > 0)
+            mFree[index + count] = rest;
+
+        mUsed += count;
+        return index;
+    }
+    return InvalidIndex;
+}
+
+void DescriptorFreeList::Free(uint32_t index, uint32_t count)
+{
+    if (count == 0)
+        return;
+
+    auto next = mFree.lower_bound(index);
+    auto prev = next != mFree.begin() ? std::prev(next) : mFree.end();
+
+    if ((next != mFree.end() && next->first < index + count) ||
+        (prev != mFree.end() && prev->first + prev->second > index))
+        throw std::logic_error("DescriptorFreeList: range freed twice");
+
+    mUsed -= count;
+
+    // Merge with the range starting right after it and the one ending at index.
+    if (next != mFree.end() && next->first == index + count)
+    {
+        count += next->second;
+        mFree.erase(next);
+    }
+    if (prev != mFree.end() && prev->first + prev->second == index)
+    {
+        prev->second += count;
+        return;
+    }
+    mFree[index] = count;
+}
+
+void DescriptorFreeList::FreeDeferred(uint32_t index, uint32_t count, uint64_t fence)
+{
+    mPending.push_back({ index, count, fence });
+}
+
+void DescriptorFreeList::Reclaim(uint64_t completedFence)
+{
+    while (!mPending.empty() && mPending.front().Fence <= completedFence)
+    {
+        Free(mPending.front().Index, mPending.front().Count);
+        mPending.pop_front();
+    }
+}
+
+DescriptorRing::DescriptorRing(uint32_t first, uint32_t capacity)
+    : mFirst(first)
+    , mRing(capacity)
+{
+    mStats.Capacity = capacity;
+}
+
+uint32_t DescriptorRing::Allocate(uint32_t count)
+{
+    const uint64_t offset = mRing.Allocate(count);
+    if (offset == RingAllocator::InvalidOffset)
+        return InvalidIndex;
+
+    mStats.BatchDescriptors += count;
+    mStats.PeakUsed = (uint32_t)mRing.PeakUsed();
+    return mFirst + (uint32_t)offset;
+}
+
+void DescriptorRing::EndBatch(uint64_t fence)
+{
+    mRing.EndBatch(fence);
+    mStats.BatchDescriptors = 0;
+}
+
+void DescriptorRing::Reclaim(uint64_t completedFence)
+{
+    mRing.Reclaim(completedFence);
+}
@@ -0,0 +1,74 @@
+// DescriptorAllocator.h
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <map>
+#include "RingAllocator.h"
+
+// Index bookkeeping for descriptor heaps, kept apart from D3D12 so it can be
+// exercised on any platform. Indices are descriptor slots in a heap.
+
+// Persistent descriptors: first fit over free ranges ordered by index, with
+// neighbours merged on free. Ranges the GPU may still read are handed back
+// with FreeDeferred and only become reusable once their fence completes.
+class DescriptorFreeList
+{
+public:
+    static const uint32_t InvalidIndex = 0xFFFFFFFFu;
+
+    DescriptorFreeList(uint32_t first, uint32_t capacity);
+
+    uint32_t Allocate(uint32_t count = 1);
+    void     Free(uint32_t index, uint32_t count = 1);
+    void     FreeDeferred(uint32_t index, uint32_t count, uint64_t fence);
+    void     Reclaim(uint64_t completedFence);
+
+    uint32_t Capacity() const { return mCapacity; }
+    uint32_t Used() const { return mUsed; }
+    uint32_t FreeRanges() const { return (uint32_t)mFree.size(); }
+
+private:
+    struct Pending
+    {
+        uint32_t Index;
+        uint32_t Count;
+        uint64_t Fence;
+    };
+
+    uint32_t mCapacity;
+    uint32_t mUsed = 0;
+
+    std::map<uint32_t, uint32_t> mFree; // first index -> count
+    std::deque<Pending> mPending;
+};
+
+struct DescriptorRingStats
+{
+    uint32_t BatchDescriptors = 0; // handed out since the last EndBatch
+    uint32_t PeakUsed = 0;
+    uint32_t Capacity = 0;
+};
+
+// Per-frame descriptor tables: the same RingAllocator as UploadRing, counted
+// in descriptors. A table never wraps, so it stays contiguous.
+class DescriptorRing
+{
+public:
+    static const uint32_t InvalidIndex = 0xFFFFFFFFu;
+
+    DescriptorRing(uint32_t first, uint32_t capacity);
+
+    // InvalidIndex when the in-flight batches leave no contiguous room.
+    uint32_t Allocate(uint32_t count);
+
+    void EndBatch(uint64_t fence);
+    void Reclaim(uint64_t completedFence);
+
+    uint32_t Used() const { return (uint32_t)mRing.Used(); }
+    const DescriptorRingStats& GetStats() const { return mStats; }
+
+private:
+    uint32_t            mFirst;
+    RingAllocator       mRing;
+    DescriptorRingStats mStats;
+};
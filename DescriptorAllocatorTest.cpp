@@ -0,0 +1,303 @@
+// DescriptorAllocatorTest.cpp
+// Checks and stress benchmark: DescriptorAllocatorTest [iterations] [seed] [frames]
+// Directed checks for the descriptor free list (first fit, merging, deferred
+// frees, double-free detection) and the descriptor ring (wrap, retire,
+// contiguity), then a random stress of both against a shadow occupancy map
+// with frames retiring a few fences behind, like a GPU would. Last, the
+// same frame pattern without the shadow map is timed for allocations and
+// frames per second.
+// Standard library only; on Linux:
+//   g++ -O2 -std=c++17 DescriptorAllocatorTest.cpp DescriptorAllocator.cpp RingAllocator.cpp -o DescriptorAllocatorTest
+#include "DescriptorAllocator.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    int gFailures = 0;
+
+    void Check(bool ok, const char* what, long long a = 0, long long b = 0)
+    {
+        if (!ok && gFailures++ < 10)
+            printf("FAIL: %s (%lld, %lld)\n", what, a, b);
+    }
+
+    void FreeListChecks()
+    {
+        const uint32_t first = 100;
+        DescriptorFreeList list(first, 64);
+
+        uint32_t a = list.Allocate(8);
+        uint32_t b = list.Allocate(8);
+        uint32_t c = list.Allocate(8);
+        Check(a == first && b == first + 8 && c == first + 16, "first fit order", a, c);
+        Check(list.Used() == 24, "used", list.Used());
+
+        // Freeing the middle then its neighbours merges back into one range.
+        list.Free(b, 8);
+        Check(list.FreeRanges() == 2, "hole plus tail", list.FreeRanges());
+        Check(list.Allocate(8) == b, "hole reused first", b);
+        list.Free(b, 8);
+        list.Free(a, 8);
+        list.Free(c, 8);
+        Check(list.FreeRanges() == 1 && list.Used() == 0, "merged", list.FreeRanges(), list.Used());
+
+        bool threw = false;
+        uint32_t d = list.Allocate(4);
+        list.Free(d, 4);
+        try { list.Free(d, 4); } catch (const std::logic_error&) { threw = true; }
+        Check(threw, "double free detected");
+
+        Check(list.Allocate(65) == DescriptorFreeList::InvalidIndex, "oversized request fails");
+
+        // Deferred frees stay out of circulation until their fence completes.
+        uint32_t all = list.Allocate(64);
+        list.FreeDeferred(all, 32, 5);
+        list.FreeDeferred(all + 32, 32, 6);
+        list.Reclaim(4);
+        Check(list.Allocate(1) == DescriptorFreeList::InvalidIndex, "deferred range reused early");
+        list.Reclaim(5);
+        Check(list.Used() == 32, "reclaimed up to fence", list.Used());
+        list.Reclaim(6);
+        Check(list.Used() == 0 && list.FreeRanges() == 1, "reclaimed all", list.Used(), list.FreeRanges());
+    }
+
+    void RingChecks()
+    {
+        const uint32_t first = 1000;
+        DescriptorRing ring(first, 16);
+
+        // Two frames of 6, the third only fits once the first retired.
+        Check(ring.Allocate(6) == first, "frame 1 at start");
+        ring.EndBatch(1);
+        Check(ring.Allocate(6) == first + 6, "frame 2 follows");
+        ring.EndBatch(2);
+        Check(ring.Allocate(6) == DescriptorRing::InvalidIndex, "no room for frame 3 yet");
+
+        // The tail [12, 16) is too short for 6: the table wraps whole to the
+        // start and the skipped tail counts as used.
+        ring.Reclaim(1);
+        Check(ring.Allocate(6) == first, "frame 3 wraps to start");
+        Check(ring.Used() == 16, "wrap waste counted", ring.Used());
+        ring.EndBatch(3);
+
+        // The skipped tail belongs to frame 3, so it stays used after frame 2.
+        ring.Reclaim(2);
+        Check(ring.Used() == 10, "frame 3 holds the skipped tail", ring.Used());
+        Check(ring.Allocate(7) == DescriptorRing::InvalidIndex, "frame 4 limited to the gap");
+        Check(ring.Allocate(6) == first + 6, "frame 4 fills the gap exactly");
+        ring.EndBatch(4);
+        Check(ring.GetStats().PeakUsed == 16, "peak", ring.GetStats().PeakUsed);
+
+        ring.Reclaim(4);
+        Check(ring.Used() == 0, "all retired", ring.Used());
+
+        // An empty batch does not hold a fence.
+        ring.EndBatch(5);
+        Check(ring.Allocate(16) == first, "empty ring restarts at zero");
+    }
+
+    void Stress(uint32_t iterations, uint32_t seed)
+    {
+        const uint32_t first = 64;
+        const uint32_t capacity = 4096;
+        const uint32_t latency = 3;   // frames the "GPU" lags behind
+
+        DescriptorFreeList list(first, capacity);
+        DescriptorRing ring(first + capacity, capacity);
+        std::vector<uint8_t> owner(capacity * 2, 0);   // 0 free, 1 free list, 2 ring, 3 deferred
+
+        struct Range { uint32_t Index, Count; };
+        struct Deferred { Range R; uint64_t Fence; };
+        std::vector<Range> persistent;
+        std::deque<Deferred> deferred;
+        std::deque<std::vector<Range>> frames(1);
+        std::mt19937 rng(seed);
+        uint64_t fence = 0;
+        uint32_t listFails = 0, ringFails = 0;
+
+        auto mark = [&](Range r, uint8_t from, uint8_t to)
+            {
+                for (uint32_t i = r.Index; i < r.Index + r.Count; ++i)
+                {
+                    Check(owner[i - first] == from, "slot owner", i, owner[i - first]);
+                    owner[i - first] = to;
+                }
+            };
+
+        for (uint32_t i = 0; i < iterations; ++i)
+        {
+            const uint32_t op = rng() % 100;
+            if (op < 30)
+            {
+                uint32_t count = 1 + rng() % 16;
+                uint32_t index = list.Allocate(count);
+                if (index == DescriptorFreeList::InvalidIndex)
+                {
+                    listFails++;
+                    continue;
+                }
+                Check(index >= first && index + count <= first + capacity, "free list bounds", index, count);
+                mark({ index, count }, 0, 1);
+                persistent.push_back({ index, count });
+            }
+            else if (op < 50 && !persistent.empty())
+            {
+                size_t k = rng() % persistent.size();
+                Range r = persistent[k];
+                persistent[k] = persistent.back();
+                persistent.pop_back();
+                if (rng() % 2)
+                {
+                    mark(r, 1, 0);
+                    list.Free(r.Index, r.Count);
+                }
+                else
+                {
+                    // Still read by the frame being recorded.
+                    mark(r, 1, 3);
+                    list.FreeDeferred(r.Index, r.Count, fence + 1);
+                    deferred.push_back({ r, fence + 1 });
+                }
+            }
+            else if (op < 95)
+            {
+                uint32_t count = 1 + rng() % 64;
+                uint32_t index = ring.Allocate(count);
+                if (index == DescriptorRing::InvalidIndex)
+                {
+                    ringFails++;
+                    continue;
+                }
+                Check(index >= first + capacity && index + count <= first + 2 * capacity, "ring bounds", index, count);
+                mark({ index, count }, 0, 2);
+                frames.back().push_back({ index, count });
+            }
+            else
+            {
+                // End the frame; the one submitted `latency` frames ago retires.
+                ring.EndBatch(++fence);
+                frames.emplace_back();
+                if (fence > latency)
+                {
+                    const uint64_t completed = fence - latency;
+                    ring.Reclaim(completed);
+                    list.Reclaim(completed);
+                    for (Range r : frames.front())
+                        mark(r, 2, 0);
+                    frames.pop_front();
+                    while (!deferred.empty() && deferred.front().Fence <= completed)
+                    {
+                        mark(deferred.front().R, 3, 0);
+                        deferred.pop_front();
+                    }
+                }
+            }
+
+            uint32_t ringLive = 0;
+            for (const std::vector<Range>& f : frames)
+                for (Range r : f)
+                    ringLive += r.Count;
+            Check(ring.Used() >= ringLive, "ring used below live tables", ring.Used(), ringLive);
+        }
+
+        printf("stress: %u iterations, %llu frames, %u free list and %u ring allocations refused, ring peak %u of %u\n",
+               iterations, (unsigned long long)fence, listFails, ringFails, ring.GetStats().PeakUsed, capacity);
+    }
+
+    // A frame of a renderer's descriptor traffic: 64 transient tables from
+    // the ring, and 16 persistent ranges created and 16 retired, half of
+    // them deferred. Sizes are drawn up front so only the allocators are timed.
+    void Throughput(uint32_t frameCount, uint32_t seed)
+    {
+        const uint32_t first = 64;
+        const uint32_t capacity = 16384;
+        const uint32_t latency = 3;
+        const uint32_t tablesPerFrame = 64;
+        const uint32_t rangesPerFrame = 16;
+
+        DescriptorFreeList list(first, capacity);
+        DescriptorRing ring(first + capacity, capacity);
+
+        std::mt19937 rng(seed);
+        std::vector<uint32_t> tableSizes(4096), rangeSizes(4096);
+        for (uint32_t& n : tableSizes)
+            n = 1 + rng() % 64;
+        for (uint32_t& n : rangeSizes)
+            n = 1 + rng() % 16;
+
+        struct Range { uint32_t Index, Count; };
+        std::deque<Range> live;
+        uint64_t ringAllocations = 0, listAllocations = 0, refused = 0;
+        uint32_t t = 0, r = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t fence = 1; fence <= frameCount; ++fence)
+        {
+            for (uint32_t i = 0; i < tablesPerFrame; ++i)
+            {
+                if (ring.Allocate(tableSizes[t++ & 4095]) == DescriptorRing::InvalidIndex)
+                    refused++;
+                else
+                    ringAllocations++;
+            }
+
+            for (uint32_t i = 0; i < rangesPerFrame; ++i)
+            {
+                const uint32_t count = rangeSizes[r++ & 4095];
+                const uint32_t index = list.Allocate(count);
+                if (index == DescriptorFreeList::InvalidIndex)
+                {
+                    refused++;
+                    continue;
+                }
+                live.push_back({ index, count });
+                listAllocations++;
+            }
+
+            // Keep a steady population of persistent ranges.
+            for (uint32_t i = 0; i < rangesPerFrame && live.size() > 512; ++i)
+            {
+                const Range old = live.front();
+                live.pop_front();
+                if (i & 1)
+                    list.FreeDeferred(old.Index, old.Count, fence);
+                else
+                    list.Free(old.Index, old.Count);
+            }
+
+            ring.EndBatch(fence);
+            if (fence > latency)
+            {
+                ring.Reclaim(fence - latency);
+                list.Reclaim(fence - latency);
+            }
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        Check(refused == 0, "benchmark frame pattern fits", (long long)refused);
+        printf("throughput: %u frames in %.3f ms, %.0f frames/s, %.1f M ring and %.1f M free list allocations/s\n",
+               frameCount, seconds * 1000.0, frameCount / seconds, ringAllocations / seconds / 1e6,
+               listAllocations / seconds / 1e6);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t iterations = argc > 1 ? (uint32_t)atoi(argv[1]) : 200000;
+    uint32_t seed = argc > 2 ? (uint32_t)atoi(argv[2]) : 1;
+    uint32_t frames = argc > 3 ? (uint32_t)atoi(argv[3]) : 100000;
+
+    FreeListChecks();
+    RingChecks();
+    Stress(iterations, seed);
+    Throughput(frames, seed);
+
+    printf("%s\n", gFailures == 0 ? "passed" : "FAILED");
+    return gFailures == 0 ? 0 : 1;
+}
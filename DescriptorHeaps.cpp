@@ -0,0 +1,91 @@
+// DescriptorHeaps.cpp
+#include "DescriptorHeaps.h"
+
+StagingDescriptorHeap::StagingDescriptorHeap(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t capacity)
+    : mIncrement(device->GetDescriptorHandleIncrementSize(type))
+    , mFreeList(0, capacity)
+{
+    D3D12_DESCRIPTOR_HEAP_DESC desc = {};
+    desc.NumDescriptors = capacity;
+    desc.Type = type;
+    desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+    ThrowIfFailed(device->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&mHeap)));
+}
+
+DescriptorHandle StagingDescriptorHeap::Allocate()
+{
+    DescriptorHandle h;
+    h.Index = mFreeList.Allocate();
+    if (h.Index == DescriptorFreeList::InvalidIndex)
+        throw std::runtime_error("Staging descriptor heap full");
+
+    h.Cpu = CpuHandle(h.Index);
+    return h;
+}
+
+void StagingDescriptorHeap::Free(DescriptorHandle& handle)
+{
+    if (handle.Index == DescriptorFreeList::InvalidIndex)
+        return;
+
+    // Copies into shader-visible heaps were made at copy time, so the slot is free immediately.
+    mFreeList.Free(handle.Index);
+    handle = DescriptorHandle();
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE StagingDescriptorHeap::CpuHandle(uint32_t index) const
+{
+    return CD3DX12_CPU_DESCRIPTOR_HANDLE(mHeap->GetCPUDescriptorHandleForHeapStart(), (INT)index, mIncrement);
+}
+
+ShaderVisibleDescriptorHeap::ShaderVisibleDescriptorHeap(ID3D12Device* device,
+    uint32_t bindlessCapacity, uint32_t ringCapacity)
+    : mDevice(device)
+    , mIncrement(device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV))
+    , mBindless(0, bindlessCapacity)
+    , mRing(bindlessCapacity, ringCapacity)
+{
+    D3D12_DESCRIPTOR_HEAP_DESC desc = {};
+    desc.NumDescriptors = bindlessCapacity + ringCapacity;
+    desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+    ThrowIfFailed(device->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&mHeap)));
+
+    mCpuStart = mHeap->GetCPUDescriptorHandleForHeapStart();
+    mGpuStart = mHeap->GetGPUDescriptorHandleForHeapStart();
+}
+
+uint32_t ShaderVisibleDescriptorHeap::AddBindless(D3D12_CPU_DESCRIPTOR_HANDLE src)
+{
+    uint32_t index = mBindless.Allocate();
+    if (index == DescriptorFreeList::InvalidIndex)
+        throw std::runtime_error("Bindless descriptor table full");
+
+    CD3DX12_CPU_DESCRIPTOR_HANDLE dst(mCpuStart, (INT)index, mIncrement);
+    mDevice->CopyDescriptorsSimple(1, dst, src, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    return index;
+}
+
+void ShaderVisibleDescriptorHeap::RemoveBindless(uint32_t index, uint64_t fence)
+{
+    mBindless.FreeDeferred(index, 1, fence);
+}
+
+D3D12_GPU_DESCRIPTOR_HANDLE ShaderVisibleDescriptorHeap::CopyTable(const D3D12_CPU_DESCRIPTOR_HANDLE* srcs, uint32_t count)
+{
+    uint32_t index = mRing.Allocate(count);
+    if (index == DescriptorRing::InvalidIndex)
+        throw std::runtime_error("Descriptor ring exhausted");
+
+    // Null range sizes: every source is a range of one.
+    D3D12_CPU_DESCRIPTOR_HANDLE dst = CD3DX12_CPU_DESCRIPTOR_HANDLE(mCpuStart, (INT)index, mIncrement);
+    mDevice->CopyDescriptors(1, &dst, &count, count, srcs, nullptr, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+    return CD3DX12_GPU_DESCRIPTOR_HANDLE(mGpuStart, (INT)index, mIncrement);
+}
+
+void ShaderVisibleDescriptorHeap::Reclaim(uint64_t completedFence)
+{
+    mBindless.Reclaim(completedFence);
+    mRing.Reclaim(completedFence);
+}
@@ -0,0 +1,64 @@
+// DescriptorHeaps.h
+#pragma once
+#include "Common.h"
+#include "DescriptorAllocator.h"
+
+struct DescriptorHandle
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE Cpu = {};
+    uint32_t Index = DescriptorFreeList::InvalidIndex;
+};
+
+// CPU-only heap for descriptors that live as long as their resource. Views
+// are created here once and copied into the shader-visible heap on use.
+class StagingDescriptorHeap
+{
+public:
+    StagingDescriptorHeap(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t capacity);
+
+    DescriptorHandle Allocate();
+    void Free(DescriptorHandle& handle);
+
+    D3D12_CPU_DESCRIPTOR_HANDLE CpuHandle(uint32_t index) const;
+
+private:
+    ComPtr<ID3D12DescriptorHeap> mHeap;
+    UINT mIncrement;
+    DescriptorFreeList mFreeList;
+};
+
+// The one CBV/SRV/UAV heap bound while drawing. The front holds bindless
+// descriptors at stable indices, so shaders can index a single large table;
+// the rest is a ring of per-frame tables retired by the frame fences.
+class ShaderVisibleDescriptorHeap
+{
+public:
+    ShaderVisibleDescriptorHeap(ID3D12Device* device, uint32_t bindlessCapacity, uint32_t ringCapacity);
+
+    // Copies src into a persistent slot and returns its index in BindlessTable().
+    uint32_t AddBindless(D3D12_CPU_DESCRIPTOR_HANDLE src);
+    // The slot is reused once fence, the last frame that may read it, completes.
+    void     RemoveBindless(uint32_t index, uint64_t fence);
+
+    // Copies count staging descriptors into this frame's part of the ring.
+    D3D12_GPU_DESCRIPTOR_HANDLE CopyTable(const D3D12_CPU_DESCRIPTOR_HANDLE* srcs, uint32_t count);
+
+    void EndFrame(uint64_t fence) { mRing.EndBatch(fence); }
+    void Reclaim(uint64_t completedFence);
+
+    ID3D12DescriptorHeap*       GetHeap() const { return mHeap.Get(); }
+    D3D12_GPU_DESCRIPTOR_HANDLE BindlessTable() const { return mGpuStart; }
+
+    uint32_t BindlessUsed() const { return mBindless.Used(); }
+    const DescriptorRingStats& GetRingStats() const { return mRing.GetStats(); }
+
+private:
+    ID3D12Device* mDevice;
+    ComPtr<ID3D12DescriptorHeap> mHeap;
+    UINT mIncrement;
+    D3D12_CPU_DESCRIPTOR_HANDLE mCpuStart;
+    D3D12_GPU_DESCRIPTOR_HANDLE mGpuStart;
+
+    DescriptorFreeList mBindless;
+    DescriptorRing     mRing;
+};
@@ -0,0 +1,129 @@
+// DrawSort.cpp
+#include "DrawSort.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cstring>
+
+namespace DrawKey
+{
+    uint32_t QuantizeDepth(float viewDepth)
+    {
+        // Negative and NaN depths (behind the eye) sort first.
+        if (!(viewDepth > 0.0f))
+            return 0;
+
+        uint32_t bits;
+        memcpy(&bits, &viewDepth, sizeof(bits));
+        return bits;
+    }
+
+    static uint64_t Field(uint32_t value, uint32_t bits)
+    {
+        return (uint64_t)(value & ((1u << bits) - 1));
+    }
+
+    uint64_t Opaque(uint32_t pass, uint32_t pipeline, uint32_t material, float viewDepth)
+    {
+        return (Field(pass, PassBits) << 60) |
+            (Field(pipeline, PipelineBits) << 48) |
+            (Field(material, MaterialBits) << 32) |
+            QuantizeDepth(viewDepth);
+    }
+
+    uint64_t Transparent(uint32_t pass, uint32_t pipeline, uint32_t material, float viewDepth)
+    {
+        return (Field(pass, PassBits) << 60) |
+            ((uint64_t)~QuantizeDepth(viewDepth) << 28) |
+            (Field(pipeline, PipelineBits) << 16) |
+            Field(material, MaterialBits);
+    }
+}
+
+SortStats CountStateChanges(const DrawState* states, const uint32_t* order, uint32_t count)
+{
+    SortStats stats;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const DrawState& s = states[order ? order[i] : i];
+        const DrawState* prev = i > 0 ? &states[order ? order[i - 1] : i - 1] : nullptr;
+
+        if (!prev || prev->Pipeline != s.Pipeline) stats.PipelineChanges++;
+        if (!prev || prev->Material != s.Material) stats.MaterialChanges++;
+    }
+    return stats;
+}
+
+void DrawSorter::Sort(const uint64_t* keys, uint32_t count)
+{
+    mKeys.assign(keys, keys + count);
+    mKeysTemp.resize(count);
+    mOrder.resize(count);
+    mOrderTemp.resize(count);
+    for (uint32_t i = 0; i < count; ++i)
+        mOrder[i] = i;
+
+    mPassesRun = 0;
+    if (count < 2)
+        return;
+
+    const uint32_t chunks = (std::min)(WorkerCount(), (count + MinChunk - 1) / MinChunk);
+    const uint32_t chunkSize = (count + chunks - 1) / chunks;
+    mHistograms.resize((size_t)chunks * Buckets);
+
+    for (uint32_t shift = 0; shift < 64; shift += RadixBits)
+    {
+        std::fill(mHistograms.begin(), mHistograms.end(), 0u);
+
+        ParallelFor(chunks, 1, [&](uint32_t begin, uint32_t end)
+            {
+                for (uint32_t c = begin; c < end; ++c)
+                {
+                    uint32_t* hist = &mHistograms[(size_t)c * Buckets];
+                    uint32_t last = (std::min)(count, (c + 1) * chunkSize);
+                    for (uint32_t i = c * chunkSize; i < last; ++i)
+                        hist[(mKeys[i] >> shift) & (Buckets - 1)]++;
+                }
+            });
+
+        // Skip the pass when one digit holds every key.
+        uint32_t digit0 = (mKeys[0] >> shift) & (Buckets - 1);
+        uint32_t total = 0;
+        for (uint32_t c = 0; c < chunks; ++c)
+            total += mHistograms[(size_t)c * Buckets + digit0];
+        if (total == count)
+            continue;
+
+        // Exclusive prefix over (digit, chunk) turns counts into write offsets;
+        // walking chunks in order inside a digit keeps the sort stable.
+        uint32_t offset = 0;
+        for (uint32_t d = 0; d < Buckets; ++d)
+        {
+            for (uint32_t c = 0; c < chunks; ++c)
+            {
+                uint32_t& h = mHistograms[(size_t)c * Buckets + d];
+                uint32_t n = h;
+                h = offset;
+                offset += n;
+            }
+        }
+
+        ParallelFor(chunks, 1, [&](uint32_t begin, uint32_t end)
+            {
+                for (uint32_t c = begin; c < end; ++c)
+                {
+                    uint32_t* dst = &mHistograms[(size_t)c * Buckets];
+                    uint32_t last = (std::min)(count, (c + 1) * chunkSize);
+                    for (uint32_t i = c * chunkSize; i < last; ++i)
+                    {
+                        uint32_t at = dst[(mKeys[i] >> shift) & (Buckets - 1)]++;
+                        mKeysTemp[at] = mKeys[i];
+                        mOrderTemp[at] = mOrder[i];
+                    }
+                }
+            });
+
+        mKeys.swap(mKeysTemp);
+        mOrder.swap(mOrderTemp);
+        mPassesRun++;
+    }
+}
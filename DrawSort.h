@@ -0,0 +1,67 @@
+// DrawSort.h
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// 64-bit draw keys; sorting them ascending gives submission order.
+//
+//   opaque:      pass:4 | pipeline:12 | material:16 | depth:32
+//   transparent: pass:4 | ~depth:32   | pipeline:12 | material:16
+//
+// Opaque draws group by state and go front-to-back inside a group, which
+// keeps early-z effective. Transparent draws must blend back-to-front, so
+// depth outranks state for them. Depth is the bit pattern of a non-negative
+// float, which orders the same as the float itself.
+namespace DrawKey
+{
+    const uint32_t PassBits = 4;
+    const uint32_t PipelineBits = 12;
+    const uint32_t MaterialBits = 16;
+
+    uint32_t QuantizeDepth(float viewDepth);
+
+    uint64_t Opaque(uint32_t pass, uint32_t pipeline, uint32_t material, float viewDepth);
+    uint64_t Transparent(uint32_t pass, uint32_t pipeline, uint32_t material, float viewDepth);
+}
+
+// State a draw sets; only used to count changes between neighbours.
+struct DrawState
+{
+    uint32_t Pipeline;
+    uint32_t Material;
+};
+
+struct SortStats
+{
+    uint32_t PipelineChanges = 0;
+    uint32_t MaterialChanges = 0;
+};
+
+// Changes when submitting states[order[0]], states[order[1]], ...; a null
+// order means submission in array order. The first draw counts as a change.
+SortStats CountStateChanges(const DrawState* states, const uint32_t* order, uint32_t count);
+
+// Stable LSD radix sort of draw indices by key, 8 bits per pass. Each pass
+// builds per-chunk histograms and scatters on worker threads; chunks are
+// fixed by the count, so the result does not depend on thread timing.
+// Passes in which every key has the same digit are skipped.
+class DrawSorter
+{
+public:
+    void Sort(const uint64_t* keys, uint32_t count);
+
+    // Draw indices in ascending key order.
+    const std::vector<uint32_t>& Order() const { return mOrder; }
+
+    uint32_t PassesRun() const { return mPassesRun; }
+
+private:
+    static const uint32_t RadixBits = 8;
+    static const uint32_t Buckets = 1u << RadixBits;
+    static const uint32_t MinChunk = 4096;
+
+    std::vector<uint64_t> mKeys, mKeysTemp;
+    std::vector<uint32_t> mOrder, mOrderTemp;
+    std::vector<uint32_t> mHistograms; // chunk-major: [chunk * Buckets + digit]
+    uint32_t mPassesRun = 0;
+};
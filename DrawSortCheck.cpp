@@ -0,0 +1,145 @@
+// DrawSortCheck.cpp
+// Checks for DrawSorter and the draw keys: DrawSortCheck [seed]
+// Sorts random keys, full-range and with many duplicates, at counts around
+// the chunk size, and compares the order with std::stable_sort of the
+// indices. Also checks skipped passes, counts below two, a sorter reused
+// for a smaller list, and the key layouts' opaque and transparent order.
+// Standard library only; on Linux:
+//   g++ -O2 -std=c++17 -pthread DrawSortCheck.cpp DrawSort.cpp Parallel.cpp JobSystem.cpp -o DrawSortCheck
+#include "DrawSort.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+
+namespace
+{
+    int gFailures = 0;
+
+    void Check(bool ok, const char* what, long long a = 0, long long b = 0)
+    {
+        if (!ok && gFailures++ < 10)
+            printf("FAIL: %s (%lld, %lld)\n", what, a, b);
+    }
+
+    std::vector<uint32_t> StableOrder(const std::vector<uint64_t>& keys)
+    {
+        std::vector<uint32_t> order(keys.size());
+        std::iota(order.begin(), order.end(), 0u);
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+        return order;
+    }
+
+    void MatchesStableSort(uint32_t seed)
+    {
+        // Around one chunk (4096) and several, so single- and multi-chunk
+        // passes and ragged last chunks are all covered.
+        const uint32_t counts[] = { 2, 3, 17, 255, 256, 4095, 4096, 4097, 8191, 8193, 12289, 50000, 100003 };
+        std::mt19937_64 rng(seed);
+        DrawSorter sorter;
+
+        for (uint32_t count : counts)
+        {
+            for (int kind = 0; kind < 3; ++kind)
+            {
+                std::vector<uint64_t> keys(count);
+                for (uint64_t& k : keys)
+                {
+                    if (kind == 0)
+                        k = rng();                                   // every pass runs
+                    else if (kind == 1)
+                        k = (rng() % 16) << 48 | (rng() % 8);        // duplicates: stability shows
+                    else
+                        k = DrawKey::Opaque((uint32_t)(rng() % 3), (uint32_t)(rng() % 40), (uint32_t)(rng() % 200),
+                                            (float)(rng() % 1000) * 0.25f);
+                }
+
+                sorter.Sort(keys.data(), count);
+                Check(sorter.Order() == StableOrder(keys), "matches std::stable_sort", count, kind);
+            }
+        }
+    }
+
+    void SkippedPasses()
+    {
+        DrawSorter sorter;
+
+        // Only the low byte varies: one pass.
+        std::vector<uint64_t> keys = { 0x1234000000000005ull, 0x1234000000000002ull, 0x1234000000000009ull, 0x1234000000000002ull };
+        sorter.Sort(keys.data(), (uint32_t)keys.size());
+        Check(sorter.PassesRun() == 1, "one varying byte, one pass", sorter.PassesRun());
+        Check(sorter.Order() == std::vector<uint32_t>({ 1, 3, 0, 2 }), "order with a skipped pass");
+
+        // Only bits 40..47 vary: still one pass, the others skipped.
+        keys = { 3ull << 40, 1ull << 40, 2ull << 40, 1ull << 40 };
+        sorter.Sort(keys.data(), (uint32_t)keys.size());
+        Check(sorter.PassesRun() == 1 && sorter.Order() == std::vector<uint32_t>({ 1, 3, 2, 0 }), "high byte only",
+              sorter.PassesRun());
+
+        // All equal: no pass, input order kept.
+        keys.assign(10000, 42);
+        sorter.Sort(keys.data(), (uint32_t)keys.size());
+        std::vector<uint32_t> identity(keys.size());
+        std::iota(identity.begin(), identity.end(), 0u);
+        Check(sorter.PassesRun() == 0 && sorter.Order() == identity, "equal keys keep input order", sorter.PassesRun());
+    }
+
+    void SmallCounts()
+    {
+        DrawSorter sorter;
+        sorter.Sort(nullptr, 0);
+        Check(sorter.Order().empty() && sorter.PassesRun() == 0, "empty");
+
+        const uint64_t one = 77;
+        sorter.Sort(&one, 1);
+        Check(sorter.Order().size() == 1 && sorter.Order()[0] == 0 && sorter.PassesRun() == 0, "single key");
+
+        // A big sort followed by a small one leaves nothing behind.
+        std::vector<uint64_t> big(20000);
+        for (uint32_t i = 0; i < big.size(); ++i)
+            big[i] = (uint64_t)(big.size() - i) * 2654435761ull;
+        sorter.Sort(big.data(), (uint32_t)big.size());
+        const uint64_t small[] = { 9, 4, 9, 1 };
+        sorter.Sort(small, 4);
+        Check(sorter.Order() == std::vector<uint32_t>({ 3, 1, 0, 2 }), "reused for a smaller list", (long long)sorter.Order().size());
+    }
+
+    void KeyLayouts()
+    {
+        // Opaque: pipeline, then material, then near to far.
+        Check(DrawKey::Opaque(0, 1, 9, 100.0f) < DrawKey::Opaque(0, 2, 0, 1.0f), "pipeline outranks material");
+        Check(DrawKey::Opaque(0, 1, 1, 100.0f) < DrawKey::Opaque(0, 1, 2, 1.0f), "material outranks depth");
+        Check(DrawKey::Opaque(0, 1, 1, 1.0f) < DrawKey::Opaque(0, 1, 1, 2.0f), "opaque front to back");
+        Check(DrawKey::Opaque(0, 1, 1, -5.0f) == DrawKey::Opaque(0, 1, 1, 0.0f), "behind the eye sorts first");
+
+        // Transparent: far to near across state, state only breaks ties.
+        Check(DrawKey::Transparent(1, 9, 9, 50.0f) < DrawKey::Transparent(1, 0, 0, 10.0f), "transparent back to front");
+        Check(DrawKey::Transparent(1, 0, 3, 10.0f) < DrawKey::Transparent(1, 1, 0, 10.0f), "transparent ties by state");
+
+        // Pass outranks everything.
+        Check(DrawKey::Transparent(0, 0, 0, 1.0f) < DrawKey::Opaque(1, 0, 0, 0.0f), "pass first");
+
+        const DrawState states[] = { { 1, 1 }, { 2, 1 }, { 1, 1 }, { 1, 2 } };
+        const uint32_t order[] = { 0, 2, 3, 1 };
+        SortStats unsorted = CountStateChanges(states, nullptr, 4);
+        SortStats sorted = CountStateChanges(states, order, 4);
+        Check(unsorted.PipelineChanges == 3 && unsorted.MaterialChanges == 2, "changes in array order",
+              unsorted.PipelineChanges, unsorted.MaterialChanges);
+        Check(sorted.PipelineChanges == 2 && sorted.MaterialChanges == 3, "changes in sorted order",
+              sorted.PipelineChanges, sorted.MaterialChanges);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t seed = argc > 1 ? (uint32_t)atoi(argv[1]) : 1;
+
+    MatchesStableSort(seed);
+    SkippedPasses();
+    SmallCounts();
+    KeyLayouts();
+
+    printf("%s\n", gFailures == 0 ? "passed" : "FAILED");
+    return gFailures == 0 ? 0 : 1;
+}
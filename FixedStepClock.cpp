@@ -0,0 +1,35 @@
+// FixedStepClock.cpp
+#include "FixedStepClock.h"
+#include <algorithm>
+
+FixedStepClock::FixedStepClock(double stepSeconds, uint32_t maxSubsteps)
+    : mStep(stepSeconds)
+    , mMaxSubsteps((std::max)(maxSubsteps, 1u))
+{
+}
+
+uint32_t FixedStepClock::Advance(double frameSeconds)
+{
+    mAccumulator += (std::max)(frameSeconds, 0.0);
+
+    uint32_t steps = 0;
+    while (mAccumulator >= mStep && steps < mMaxSubsteps)
+    {
+        mAccumulator -= mStep;
+        ++steps;
+    }
+
+    if (mAccumulator >= mStep)
+    {
+        // Keep the fraction so interpolation stays continuous.
+        const double dropped = mStep * (double)(uint64_t)(mAccumulator / mStep);
+        mAccumulator -= dropped;
+        mStats.DroppedSeconds += dropped;
+        mStats.ClampedFrames++;
+    }
+
+    mStepCount += steps;
+    mStats.Frames++;
+    mStats.Steps += steps;
+    return steps;
+}
@@ -0,0 +1,46 @@
+// FixedStepClock.h
+#pragma once
+#include <cstdint>
+
+struct FixedStepStats
+{
+    uint64_t Frames = 0;
+    uint64_t Steps = 0;
+    uint64_t ClampedFrames = 0;    // frames that hit the substep cap
+    double   DroppedSeconds = 0.0; // time the cap threw away
+};
+
+// Turns variable frame times into whole fixed-length simulation steps.
+// What is left over stays in the accumulator for the next frame and is
+// exposed as Alpha for interpolating between the last two steps. A frame
+// that would need more than maxSubsteps runs the cap and drops the rest,
+// so one slow frame cannot make the next one slower still; the simulation
+// then falls behind real time until the load eases.
+class FixedStepClock
+{
+public:
+    explicit FixedStepClock(double stepSeconds = 1.0 / 120.0, uint32_t maxSubsteps = 8);
+
+    // Adds a frame's elapsed time and returns the steps to run for it.
+    uint32_t Advance(double frameSeconds);
+
+    double   StepSeconds() const { return mStep; }
+    uint32_t MaxSubsteps() const { return mMaxSubsteps; }
+
+    // Fraction of a step accumulated past the last step, in [0, 1).
+    double   Alpha() const { return mAccumulator / mStep; }
+
+    uint64_t StepCount() const { return mStepCount; }
+    double   SimulationTime() const { return (double)mStepCount * mStep; }
+
+    const FixedStepStats& GetStats() const { return mStats; }
+    void ResetStats() { mStats = FixedStepStats(); }
+
+private:
+    double   mStep;
+    uint32_t mMaxSubsteps;
+    double   mAccumulator = 0.0;
+    uint64_t mStepCount = 0;
+
+    FixedStepStats mStats;
+};
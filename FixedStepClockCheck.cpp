@@ -0,0 +1,98 @@
+// FixedStepClockCheck.cpp
+// Checks for FixedStepClock: FixedStepClockCheck
+// Feeds frame times and checks the steps and alpha it hands out: leftovers
+// carried between frames, zero-step frames, the substep cap dropping whole
+// steps but keeping the fraction, negative frame times, and no drift from
+// real time over a long run at a 1/120 s step.
+// Standard library only; on Linux:
+//   g++ -O2 -std=c++17 FixedStepClockCheck.cpp FixedStepClock.cpp -o FixedStepClockCheck
+#include "FixedStepClock.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+namespace
+{
+    int gFailures = 0;
+
+    void Check(bool ok, const char* what, double a = 0, double b = 0)
+    {
+        if (!ok && gFailures++ < 10)
+            printf("FAIL: %s (%g, %g)\n", what, a, b);
+    }
+
+    bool Near(double a, double b) { return std::fabs(a - b) < 1e-9; }
+
+    void Accumulation()
+    {
+        // Quarter-second steps keep the numbers easy to follow.
+        FixedStepClock clock(0.25, 8);
+
+        Check(clock.Advance(0.1) == 0 && Near(clock.Alpha(), 0.4), "short frame runs no step", clock.Alpha());
+        Check(clock.Advance(0.1) == 0 && Near(clock.Alpha(), 0.8), "leftover carried", clock.Alpha());
+        Check(clock.Advance(0.1) == 1 && Near(clock.Alpha(), 0.2), "leftovers add up to a step", clock.Alpha());
+        Check(clock.Advance(0.6) == 2 && Near(clock.Alpha(), 0.6), "two steps", clock.Alpha());
+        Check(clock.Advance(-1.0) == 0 && Near(clock.Alpha(), 0.6), "negative time ignored", clock.Alpha());
+
+        Check(clock.StepCount() == 3 && Near(clock.SimulationTime(), 0.75), "step count", (double)clock.StepCount());
+        Check(clock.GetStats().Frames == 5 && clock.GetStats().Steps == 3 && clock.GetStats().ClampedFrames == 0, "stats");
+    }
+
+    void Clamping()
+    {
+        FixedStepClock clock(0.25, 4);
+
+        // A 2.6 s hitch would be ten steps: four run, the rest is dropped in
+        // whole steps so the fraction (0.1 s) survives for interpolation.
+        Check(clock.Advance(2.6) == 4, "capped at max substeps");
+        Check(Near(clock.Alpha(), 0.4), "fraction kept after clamping", clock.Alpha());
+        Check(clock.GetStats().ClampedFrames == 1 && Near(clock.GetStats().DroppedSeconds, 1.5), "dropped whole steps",
+              clock.GetStats().DroppedSeconds);
+
+        // The next normal frame is not punished for the hitch.
+        Check(clock.Advance(0.25) == 1 && Near(clock.Alpha(), 0.4), "recovers next frame", clock.Alpha());
+
+        // Exactly the cap is not a clamp.
+        FixedStepClock exact(0.25, 4);
+        Check(exact.Advance(1.0) == 4 && exact.GetStats().ClampedFrames == 0, "cap reached exactly is not clamped");
+
+        // A cap of zero still makes progress.
+        FixedStepClock one(0.25, 0);
+        Check(one.MaxSubsteps() == 1 && one.Advance(1.0) == 1, "zero cap treated as one");
+    }
+
+    void NoDrift()
+    {
+        // Ten minutes of jittery 60 Hz frames at a 1/120 s step: simulated
+        // time stays within one step of real time and alpha in [0, 1).
+        FixedStepClock clock(1.0 / 120.0, 8);
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<double> jitter(-0.002, 0.002);
+
+        double real = 0.0;
+        bool alphaInRange = true;
+        for (int i = 0; i < 60 * 600; ++i)
+        {
+            const double frame = 1.0 / 60.0 + jitter(rng);
+            real += frame;
+            clock.Advance(frame);
+            alphaInRange &= clock.Alpha() >= 0.0 && clock.Alpha() < 1.0;
+        }
+
+        const double lag = real - clock.SimulationTime();
+        Check(lag >= -1e-6 && lag < clock.StepSeconds(), "simulation keeps up with real time", lag);
+        Check(Near(lag, clock.Alpha() * clock.StepSeconds()), "lag is exactly the leftover", lag);
+        Check(alphaInRange, "alpha in [0, 1)");
+        Check(clock.GetStats().ClampedFrames == 0, "no clamping at normal rates", (double)clock.GetStats().ClampedFrames);
+    }
+}
+
+int main()
+{
+    Accumulation();
+    Clamping();
+    NoDrift();
+
+    printf("%s\n", gFailures == 0 ? "passed" : "FAILED");
+    return gFailures == 0 ? 0 : 1;
+}
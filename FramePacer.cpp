@@ -0,0 +1,222 @@
+// FramePacer.cpp
+#include "FramePacer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PACER_PAUSE() _mm_pause()
+#else
+#define PACER_PAUSE() ((void)0)
+#endif
+
+const int64_t FramePacer::MinSpinMargin;
+const int64_t FramePacer::InitialSpinMargin;
+
+SteadyPacerClock::SteadyPacerClock()
+{
+#if defined(_WIN32)
+    // Windows 10 1803 and later; older systems fall back to sleep_for.
+    mTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+#endif
+}
+
+SteadyPacerClock::~SteadyPacerClock()
+{
+#if defined(_WIN32)
+    if (mTimer)
+        CloseHandle((HANDLE)mTimer);
+#endif
+}
+
+int64_t SteadyPacerClock::Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void SteadyPacerClock::Sleep(int64_t ns)
+{
+#if defined(_WIN32)
+    if (mTimer)
+    {
+        LARGE_INTEGER due;
+        due.QuadPart = -(ns / 100);   // relative, in 100 ns units
+        if (SetWaitableTimer((HANDLE)mTimer, &due, 0, nullptr, nullptr, FALSE))
+        {
+            WaitForSingleObject((HANDLE)mTimer, INFINITE);
+            return;
+        }
+    }
+#endif
+    std::this_thread::sleep_for(std::chrono::nanoseconds(ns));
+}
+
+void SteadyPacerClock::Relax()
+{
+    PACER_PAUSE();
+}
+
+FramePacer::FramePacer(IPacerClock& clock, double targetHz)
+    : mClock(clock)
+{
+    SetTargetRate(targetHz);
+}
+
+void FramePacer::SetTargetRate(double hz)
+{
+    mTargetHz = hz > 0.0 ? hz : 0.0;
+    mPeriod = mTargetHz > 0.0 ? (int64_t)(1e9 / mTargetHz) : 0;
+    mDeadline = 0;
+}
+
+void FramePacer::LearnOversleep(int64_t oversleep)
+{
+    // Exponential averages of the oversleep and its deviation; the margin
+    // covers all but the rare outlier.
+    const double sample = (double)(std::max)(oversleep, (int64_t)0);
+    if (!mOversleepSeen)
+    {
+        mOversleepMean = sample;
+        mOversleepDev = sample * 0.5;
+        mOversleepSeen = true;
+    }
+    else
+    {
+        mOversleepMean += (sample - mOversleepMean) / 16.0;
+        mOversleepDev += (std::fabs(sample - mOversleepMean) - mOversleepDev) / 16.0;
+    }
+
+    int64_t margin = (int64_t)(mOversleepMean + 4.0 * mOversleepDev);
+    mSpinMargin = (std::max)(margin, MinSpinMargin);
+    if (mPeriod > 0)
+        mSpinMargin = (std::min)(mSpinMargin, mPeriod / 2);
+}
+
+void FramePacer::WaitForNextFrame()
+{
+    int64_t now = mClock.Now();
+
+    if (mPeriod == 0)
+    {
+        mFrameStart = now;
+        return;
+    }
+
+    if (mDeadline == 0 || now - mDeadline > mPeriod)
+    {
+        if (mDeadline != 0)
+            mMissed++;
+        mDeadline = now;
+    }
+    else if (now > mDeadline)
+    {
+        // Slightly late: start now but keep the cadence.
+        mMissed++;
+    }
+    else
+    {
+        const int64_t sleepFor = mDeadline - now - mSpinMargin;
+        if (sleepFor > 0)
+        {
+            const int64_t before = now;
+            mClock.Sleep(sleepFor);
+            now = mClock.Now();
+            LearnOversleep(now - before - sleepFor);
+            mSleepNs += now - before;
+        }
+
+        const int64_t spinStart = now;
+        while (now < mDeadline)
+        {
+            mClock.Relax();
+            now = mClock.Now();
+        }
+        mSpinNs += now - spinStart;
+    }
+
+    mFrameStart = now;
+    mDeadline += mPeriod;
+}
+
+void FramePacer::MarkPresented()
+{
+    const int64_t now = mClock.Now();
+
+    if (mPredicted != 0)
+    {
+        mPredictionErrorSum += std::fabs((double)(now - mPredicted)) * 1e-6;
+        mPredictions++;
+    }
+
+    const double work = (double)(now - mFrameStart);
+    mWorkAverage = mLastPresent == 0 ? work : mWorkAverage + (work - mWorkAverage) / 8.0;
+
+    if (mLastPresent != 0)
+    {
+        const double interval = (double)(now - mLastPresent);
+        mIntervalAverage = mIntervalAverage == 0.0 ? interval : mIntervalAverage + (interval - mIntervalAverage) / 8.0;
+
+        const double ms = interval * 1e-6;
+        mFrames++;
+        mIntervalSum += ms;
+        mIntervalSquares += ms * ms;
+        mIntervalMax = (std::max)(mIntervalMax, ms);
+    }
+
+    mLastPresent = now;
+    mPredicted = PredictNextPresent();
+}
+
+int64_t FramePacer::PredictNextPresent() const
+{
+    if (mLastPresent == 0)
+        return 0;
+    if (mPeriod > 0 && mDeadline != 0)
+        return mDeadline + (int64_t)mWorkAverage;
+    return mLastPresent + (int64_t)mIntervalAverage;
+}
+
+PacerStats FramePacer::GetStats() const
+{
+    PacerStats stats;
+    stats.Frames = mFrames;
+    stats.Missed = mMissed;
+    stats.SleepMs = (double)mSleepNs * 1e-6;
+    stats.SpinMs = (double)mSpinNs * 1e-6;
+    stats.MaxIntervalMs = mIntervalMax;
+    if (mFrames > 0)
+    {
+        const double mean = mIntervalSum / (double)mFrames;
+        stats.MeanIntervalMs = mean;
+        stats.JitterMs = std::sqrt((std::max)(mIntervalSquares / (double)mFrames - mean * mean, 0.0));
+    }
+    if (mPredictions > 0)
+        stats.PredictionErrorMs = mPredictionErrorSum / (double)mPredictions;
+    return stats;
+}
+
+void FramePacer::ResetStats()
+{
+    mFrames = 0;
+    mMissed = 0;
+    mIntervalSum = 0.0;
+    mIntervalSquares = 0.0;
+    mIntervalMax = 0.0;
+    mSleepNs = 0;
+    mSpinNs = 0;
+    mPredictionErrorSum = 0.0;
+    mPredictions = 0;
+}
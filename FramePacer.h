@@ -0,0 +1,114 @@
+// FramePacer.h
+#pragma once
+#include <cstdint>
+
+// Time source for FramePacer, in nanoseconds on a monotonic clock. Sleep may
+// wake late by an amount the pacer learns, but never early.
+class IPacerClock
+{
+public:
+    virtual ~IPacerClock() = default;
+
+    virtual int64_t Now() = 0;
+    virtual void    Sleep(int64_t ns) = 0;
+    virtual void    Relax() {}   // one iteration of a spin-wait
+};
+
+// steady_clock, sleeping on a high-resolution waitable timer where Windows
+// has one and on sleep_for otherwise.
+class SteadyPacerClock : public IPacerClock
+{
+public:
+    SteadyPacerClock();
+    ~SteadyPacerClock() override;
+
+    SteadyPacerClock(const SteadyPacerClock&) = delete;
+    SteadyPacerClock& operator=(const SteadyPacerClock&) = delete;
+
+    int64_t Now() override;
+    void    Sleep(int64_t ns) override;
+    void    Relax() override;
+
+private:
+    void* mTimer = nullptr;   // HANDLE on Windows
+};
+
+struct PacerStats
+{
+    uint64_t Frames = 0;          // presents measured
+    uint64_t Missed = 0;          // frames that began after their deadline
+    double   MeanIntervalMs = 0;  // present to present
+    double   JitterMs = 0;        // standard deviation of the interval
+    double   MaxIntervalMs = 0;
+    double   SleepMs = 0;         // time spent waiting, summed
+    double   SpinMs = 0;
+    double   PredictionErrorMs = 0; // mean |predicted - actual| present time
+};
+
+// Paces frame starts to a target rate. The wait sleeps until a safety
+// margin before the deadline and spins the rest; the margin follows the
+// clock's measured oversleep, so a precise timer spins for microseconds
+// and a coarse one for what it needs. A frame that starts more than one
+// period late resets the schedule instead of running a burst to catch up.
+class FramePacer
+{
+public:
+    explicit FramePacer(IPacerClock& clock, double targetHz = 0.0);
+
+    // 0 leaves frames unpaced; presents are still measured.
+    void   SetTargetRate(double hz);
+    double TargetRate() const { return mTargetHz; }
+
+    // Call at the start of every frame.
+    void WaitForNextFrame();
+
+    // Call once the frame's Present returns.
+    void MarkPresented();
+
+    // Expected time of the next present: the next frame start plus the
+    // usual start-to-present time, or the last present plus the usual
+    // interval when unpaced. 0 until a present has been seen.
+    int64_t PredictNextPresent() const;
+
+    int64_t SpinMargin() const { return mSpinMargin; }
+
+    // Totals and moments since the last ResetStats.
+    PacerStats GetStats() const;
+    void       ResetStats();
+
+private:
+    static const int64_t MinSpinMargin = 50000;       // 50 us
+    static const int64_t InitialSpinMargin = 2000000; // 2 ms, until the clock is measured
+
+    void LearnOversleep(int64_t oversleep);
+
+    IPacerClock& mClock;
+    double  mTargetHz = 0.0;
+    int64_t mPeriod = 0;
+
+    int64_t mDeadline = 0;     // start of the next frame; 0 until the first wait
+    int64_t mFrameStart = 0;
+
+    // Running estimates of the clock's oversleep
+    double  mOversleepMean = 0.0;
+    double  mOversleepDev = 0.0;
+    bool    mOversleepSeen = false;
+    int64_t mSpinMargin = InitialSpinMargin;
+
+    // Running estimates for the prediction
+    int64_t mLastPresent = 0;
+    int64_t mPredicted = 0;
+    double  mIntervalAverage = 0.0;
+    double  mWorkAverage = 0.0;
+
+    // Stats window
+    uint64_t mFrames = 0;
+    uint64_t mMissed = 0;
+    double   mIntervalSum = 0.0;
+    double   mIntervalSquares = 0.0;
+    double   mIntervalMax = 0.0;
+    int64_t  mSleepNs = 0;
+    int64_t  mSpinNs = 0;
+    double   mPredictionErrorSum = 0.0;
+    uint64_t mPredictions = 0;
+};
@@ -0,0 +1,177 @@
+// FramePacerCheck.cpp
+// Checks for FramePacer on a fake clock: FramePacerCheck
+// Time only moves when the pacer sleeps or spins or the "frame" works, and
+// sleeps wake a set amount late, so every frame start is predictable:
+// steady cadence, the spin margin learning the oversleep, a slightly late
+// frame keeping the cadence, a long stall resetting the deadline instead
+// of bursting, unpaced mode and the present prediction.
+// Standard library only; on Linux:
+//   g++ -O2 -std=c++17 FramePacerCheck.cpp FramePacer.cpp -o FramePacerCheck
+#include "FramePacer.h"
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    int gFailures = 0;
+
+    void Check(bool ok, const char* what, long long a = 0, long long b = 0)
+    {
+        if (!ok && gFailures++ < 10)
+            printf("FAIL: %s (%lld, %lld)\n", what, a, b);
+    }
+
+    const int64_t Ms = 1000000;
+    const int64_t Us = 1000;
+    const int64_t RelaxStep = 1 * Us;
+
+    class FakeClock : public IPacerClock
+    {
+    public:
+        int64_t Now() override { return Time; }
+        void Sleep(int64_t ns) override
+        {
+            Time += ns + Oversleep;
+            Sleeps++;
+        }
+        void Relax() override { Time += RelaxStep; }
+
+        void Work(int64_t ns) { Time += ns; }
+
+        int64_t  Time = 1000 * Ms;
+        int64_t  Oversleep = 0;
+        uint32_t Sleeps = 0;
+    };
+
+    // Runs frames of the given work and returns each frame's start time.
+    std::vector<int64_t> Run(FramePacer& pacer, FakeClock& clock, uint32_t frames, int64_t work)
+    {
+        std::vector<int64_t> starts;
+        for (uint32_t i = 0; i < frames; ++i)
+        {
+            pacer.WaitForNextFrame();
+            starts.push_back(clock.Now());
+            clock.Work(work);
+            pacer.MarkPresented();
+        }
+        return starts;
+    }
+
+    void SteadyCadence()
+    {
+        FakeClock clock;
+        clock.Oversleep = 300 * Us;
+        FramePacer pacer(clock, 100.0);   // 10 ms
+        const int64_t period = 10 * Ms;
+
+        std::vector<int64_t> starts = Run(pacer, clock, 200, 4 * Ms);
+        for (size_t i = 1; i < starts.size(); ++i)
+        {
+            const int64_t late = starts[i] - (starts[0] + (int64_t)i * period);
+            Check(late >= 0 && late < RelaxStep, "frame starts on its deadline", (long long)i, late);
+        }
+        Check(pacer.GetStats().Missed == 0, "no misses", (long long)pacer.GetStats().Missed);
+
+        // The margin settles near the oversleep: enough to never wake late,
+        // far below the 2 ms it starts with.
+        Check(pacer.SpinMargin() >= 300 * Us && pacer.SpinMargin() < 600 * Us, "margin learned", pacer.SpinMargin());
+        Check(pacer.GetStats().MeanIntervalMs > 9.99 && pacer.GetStats().MeanIntervalMs < 10.01, "mean interval",
+              (long long)(pacer.GetStats().MeanIntervalMs * 1000));
+
+        // Start-to-present is 4 ms: the next present is the next deadline plus that.
+        const int64_t next = starts.back() + period;
+        Check(pacer.PredictNextPresent() >= next + 4 * Ms - RelaxStep && pacer.PredictNextPresent() <= next + 4 * Ms + RelaxStep,
+              "prediction", pacer.PredictNextPresent() - next);
+    }
+
+    void SlightlyLate()
+    {
+        FakeClock clock;
+        FramePacer pacer(clock, 100.0);
+        const int64_t period = 10 * Ms;
+
+        std::vector<int64_t> starts = Run(pacer, clock, 10, 2 * Ms);
+        const int64_t origin = starts[0];
+
+        // A 13 ms frame overruns the next deadline by 3 ms: that frame starts
+        // at once, the one after it is back on the old grid.
+        pacer.WaitForNextFrame();
+        const int64_t longStart = clock.Now();
+        clock.Work(13 * Ms);
+        pacer.MarkPresented();
+        Check(longStart - (origin + 10 * period) < RelaxStep, "on grid before the overrun", longStart - origin);
+
+        pacer.WaitForNextFrame();
+        Check(clock.Now() == longStart + 13 * Ms, "late frame starts immediately", clock.Now() - longStart);
+        clock.Work(2 * Ms);
+        pacer.MarkPresented();
+
+        pacer.WaitForNextFrame();
+        const int64_t back = clock.Now() - (origin + 12 * period);
+        Check(back >= 0 && back < RelaxStep, "cadence kept after a slight miss", back);
+        Check(pacer.GetStats().Missed == 1, "one miss", (long long)pacer.GetStats().Missed);
+    }
+
+    void StallResetsDeadline()
+    {
+        FakeClock clock;
+        FramePacer pacer(clock, 100.0);
+        const int64_t period = 10 * Ms;
+
+        Run(pacer, clock, 10, 2 * Ms);
+
+        // A 35 ms hitch is more than a period late: rather than running
+        // three frames back to back to catch up, the schedule restarts.
+        pacer.WaitForNextFrame();
+        clock.Work(35 * Ms);
+        pacer.MarkPresented();
+
+        const uint32_t sleepsBefore = clock.Sleeps;
+        pacer.WaitForNextFrame();
+        const int64_t restart = clock.Now();
+        Check(clock.Sleeps == sleepsBefore, "restart frame does not wait");
+        clock.Work(2 * Ms);
+        pacer.MarkPresented();
+
+        std::vector<int64_t> after = Run(pacer, clock, 3, 2 * Ms);
+        for (size_t i = 0; i < after.size(); ++i)
+        {
+            const int64_t late = after[i] - (restart + (int64_t)(i + 1) * period);
+            Check(late >= 0 && late < RelaxStep, "new grid from the restart, no burst", (long long)i, late);
+        }
+        Check(pacer.GetStats().Missed == 1, "stall counted once", (long long)pacer.GetStats().Missed);
+    }
+
+    void RateChanges()
+    {
+        FakeClock clock;
+        FramePacer pacer(clock, 0.0);
+
+        // Unpaced: no waiting at all, presents are still measured.
+        const uint32_t sleeps = clock.Sleeps;
+        std::vector<int64_t> starts = Run(pacer, clock, 5, 3 * Ms);
+        Check(clock.Sleeps == sleeps && starts[4] - starts[0] == 12 * Ms, "unpaced runs flat out", starts[4] - starts[0]);
+        Check(pacer.GetStats().Frames == 4, "presents measured", (long long)pacer.GetStats().Frames);
+
+        // Turning pacing on starts a fresh schedule at the next wait.
+        pacer.SetTargetRate(50.0);
+        starts = Run(pacer, clock, 3, 3 * Ms);
+        Check(starts[2] - starts[0] >= 40 * Ms && starts[2] - starts[0] < 40 * Ms + RelaxStep, "paced after enabling",
+              starts[2] - starts[0]);
+        Check(pacer.GetStats().Missed == 0, "enabling is not a miss", (long long)pacer.GetStats().Missed);
+
+        pacer.ResetStats();
+        Check(pacer.GetStats().Frames == 0 && pacer.GetStats().SleepMs == 0.0, "stats reset");
+    }
+}
+
+int main()
+{
+    SteadyCadence();
+    SlightlyLate();
+    StallResetsDeadline();
+    RateChanges();
+
+    printf("%s\n", gFailures == 0 ? "passed" : "FAILED");
+    return gFailures == 0 ? 0 : 1;
+}
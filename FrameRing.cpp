@@ -0,0 +1,45 @@
+// FrameRing.cpp
+#include "FrameRing.h"
+#include <stdexcept>
+
+FrameRing::FrameRing(IGpuQueue& queue, uint32_t framesInFlight)
+    : mQueue(queue)
+    , mSlotFences(framesInFlight > 0 ? framesInFlight : 1, 0)
+    , mCurrent((uint32_t)mSlotFences.size() - 1)
+{
+}
+
+uint32_t FrameRing::BeginFrame()
+{
+    if (mInFrame)
+        throw std::logic_error("FrameRing::BeginFrame called twice");
+
+    mCurrent = (mCurrent + 1) % (uint32_t)mSlotFences.size();
+
+    const uint64_t fence = mSlotFences[mCurrent];
+    if (fence != 0 && mQueue.CompletedValue() < fence)
+    {
+        mStats.Stalls++;
+        mQueue.WaitForValue(fence);
+    }
+
+    mInFrame = true;
+    return mCurrent;
+}
+
+void FrameRing::EndFrame()
+{
+    if (!mInFrame)
+        throw std::logic_error("FrameRing::EndFrame without BeginFrame");
+
+    mLastSignaled = mQueue.Signal();
+    mSlotFences[mCurrent] = mLastSignaled;
+    mInFrame = false;
+    mStats.Frames++;
+}
+
+void FrameRing::WaitIdle()
+{
+    mLastSignaled = mQueue.Signal();
+    mQueue.WaitForValue(mLastSignaled);
+}
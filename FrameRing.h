@@ -0,0 +1,60 @@
+// FrameRing.h
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Fence-backed submission queue as seen by frame pacing code. The D3D12
+// queue implements it; so can a fake queue that completes on demand.
+class IGpuQueue
+{
+public:
+    virtual ~IGpuQueue() = default;
+
+    virtual uint64_t Signal() = 0;                   // enqueue a signal, returns its fence value
+    virtual uint64_t CompletedValue() const = 0;
+    virtual void     WaitForValue(uint64_t value) = 0; // blocks until CompletedValue() >= value
+};
+
+struct FrameRingStats
+{
+    uint64_t Frames = 0;
+    uint64_t Stalls = 0;   // BeginFrame had to wait for the GPU
+};
+
+// N frames in flight. Each slot remembers the fence value of the last frame
+// submitted from it and is only waited on when it comes round again.
+class FrameRing
+{
+public:
+    FrameRing(IGpuQueue& queue, uint32_t framesInFlight);
+
+    // Picks the next slot, blocking only until that slot's last use retired.
+    uint32_t BeginFrame();
+
+    // Call after the frame's command lists were submitted.
+    void EndFrame();
+
+    // Blocks until everything submitted so far has completed.
+    void WaitIdle();
+
+    uint32_t CurrentSlot() const { return mCurrent; }
+    uint32_t SlotCount() const { return (uint32_t)mSlotFences.size(); }
+    uint64_t SlotFence(uint32_t slot) const { return mSlotFences[slot]; }
+
+    // Highest fence value known to be complete; anything tagged with a value
+    // at or below it can be reused.
+    uint64_t CompletedFence() const { return mQueue.CompletedValue(); }
+    uint64_t LastSubmittedFence() const { return mLastSignaled; }
+
+    const FrameRingStats& GetStats() const { return mStats; }
+
+private:
+    IGpuQueue& mQueue;
+
+    std::vector<uint64_t> mSlotFences;
+    uint32_t mCurrent = 0;
+    uint64_t mLastSignaled = 0;
+    bool     mInFrame = false;
+
+    FrameRingStats mStats;
+};
@@ -0,0 +1,118 @@
+// FrameRingCheck.cpp
+// Checks for FrameRing against a fake queue: FrameRingCheck
+// The fake GPU completes work only when told to, so the checks can see
+// exactly when BeginFrame waits: slots cycle in order, a slot is waited on
+// only when it comes round while its frame is still in flight, the wait is
+// for that slot's fence and no later one, and misuse throws.
+// Standard library only; on Linux:
+//   g++ -O2 -std=c++17 FrameRingCheck.cpp FrameRing.cpp -o FrameRingCheck
+#include "FrameRing.h"
+#include <cstdio>
+#include <stdexcept>
+
+namespace
+{
+    int gFailures = 0;
+
+    void Check(bool ok, const char* what, long long a = 0, long long b = 0)
+    {
+        if (!ok && gFailures++ < 10)
+            printf("FAIL: %s (%lld, %lld)\n", what, a, b);
+    }
+
+    // Signals queue up; the GPU "finishes" them only through Complete or a
+    // wait, which records the value it was asked for.
+    class FakeQueue : public IGpuQueue
+    {
+    public:
+        uint64_t Signal() override { return ++mSignaled; }
+        uint64_t CompletedValue() const override { return mCompleted; }
+        void WaitForValue(uint64_t value) override
+        {
+            mWaits++;
+            mLastWait = value;
+            if (value > mCompleted)
+                mCompleted = value;
+        }
+
+        void Complete(uint64_t value) { mCompleted = value > mSignaled ? mSignaled : value; }
+
+        uint64_t mSignaled = 0;
+        uint64_t mCompleted = 0;
+        uint32_t mWaits = 0;
+        uint64_t mLastWait = 0;
+    };
+
+    void SlotsAndStalls()
+    {
+        FakeQueue queue;
+        FrameRing ring(queue, 3);
+
+        // The first lap never waits: the slots have no fence yet.
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            Check(ring.BeginFrame() == i, "slots in order", i);
+            ring.EndFrame();
+            Check(ring.SlotFence(i) == i + 1, "slot keeps its fence", ring.SlotFence(i), i + 1);
+        }
+        Check(queue.mWaits == 0 && ring.GetStats().Stalls == 0, "no wait on the first lap", queue.mWaits);
+
+        // Slot 0 comes round with frame 1 still in flight: wait for fence 1 only.
+        Check(ring.BeginFrame() == 0, "wraps to slot 0");
+        Check(queue.mWaits == 1 && queue.mLastWait == 1, "waited for slot 0's fence", queue.mWaits, queue.mLastWait);
+        Check(queue.mCompleted == 1, "did not wait for later frames", queue.mCompleted);
+        ring.EndFrame();
+
+        // GPU catches up on frame 2: slot 1 is reused without a wait.
+        queue.Complete(2);
+        Check(ring.BeginFrame() == 1, "slot 1");
+        Check(queue.mWaits == 1, "retired slot not waited on", queue.mWaits);
+        ring.EndFrame();
+
+        Check(ring.GetStats().Frames == 5 && ring.GetStats().Stalls == 1, "stats",
+              ring.GetStats().Frames, ring.GetStats().Stalls);
+        Check(ring.LastSubmittedFence() == 5, "last fence", ring.LastSubmittedFence());
+
+        ring.WaitIdle();
+        Check(ring.CompletedFence() == ring.LastSubmittedFence(), "idle", ring.CompletedFence());
+    }
+
+    void SingleSlot()
+    {
+        // One frame in flight: every frame waits for the one before it.
+        FakeQueue queue;
+        FrameRing ring(queue, 0);
+        Check(ring.SlotCount() == 1, "zero slots clamps to one", ring.SlotCount());
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            Check(ring.BeginFrame() == 0, "always slot 0");
+            ring.EndFrame();
+        }
+        Check(ring.GetStats().Stalls == 3, "serialised", ring.GetStats().Stalls);
+    }
+
+    void Misuse()
+    {
+        FakeQueue queue;
+        FrameRing ring(queue, 2);
+
+        bool threw = false;
+        try { ring.EndFrame(); } catch (const std::logic_error&) { threw = true; }
+        Check(threw, "EndFrame without BeginFrame throws");
+
+        ring.BeginFrame();
+        threw = false;
+        try { ring.BeginFrame(); } catch (const std::logic_error&) { threw = true; }
+        Check(threw, "nested BeginFrame throws");
+    }
+}
+
+int main()
+{
+    SlotsAndStalls();
+    SingleSlot();
+    Misuse();
+
+    printf("%s\n", gFailures == 0 ? "passed" : "FAILED");
+    return gFailures == 0 ? 0 : 1;
+}
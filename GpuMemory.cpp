@@ -0,0 +1,142 @@
+// GpuMemory.cpp
+#include "GpuMemory.h"
+#include <algorithm>
+
+GpuHeapAllocator::GpuHeapAllocator(ID3D12Device* device, D3D12_HEAP_TYPE type,
+                                   D3D12_HEAP_FLAGS flags, UINT64 heapSize)
+    : mDevice(device)
+    , mType(type)
+    , mFlags(flags)
+    , mHeapSize(heapSize)
+{
+}
+
+uint32_t GpuHeapAllocator::AddHeap(UINT64 size, bool dedicated)
+{
+    CD3DX12_HEAP_DESC desc(size, mType, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT, mFlags);
+
+    HeapBlock block;
+    ThrowIfFailed(mDevice->CreateHeap(&desc, IID_PPV_ARGS(&block.Heap)));
+    if (!dedicated)
+        block.Blocks = std::make_unique<TlsfAllocator>(size, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+    block.Size = size;
+    block.Dedicated = dedicated;
+
+    // Reuse a slot left by a released heap so allocations keep their indices.
+    for (uint32_t i = 0; i < (uint32_t)mHeaps.size(); ++i)
+    {
+        if (!mHeaps[i].Heap)
+        {
+            mHeaps[i] = std::move(block);
+            return i;
+        }
+    }
+    mHeaps.push_back(std::move(block));
+    return (uint32_t)mHeaps.size() - 1;
+}
+
+ComPtr<ID3D12Resource> GpuHeapAllocator::CreateResource(const D3D12_RESOURCE_DESC& desc,
+    D3D12_RESOURCE_STATES initialState, GpuAllocation& outAllocation)
+{
+    D3D12_RESOURCE_ALLOCATION_INFO info = mDevice->GetResourceAllocationInfo(0, 1, &desc);
+
+    GpuAllocation a;
+    if (info.SizeInBytes > mHeapSize)
+    {
+        a.Heap = AddHeap(info.SizeInBytes, true);
+        a.Block = DedicatedBlock;
+    }
+    else
+    {
+        for (uint32_t i = 0; i < (uint32_t)mHeaps.size() && !a.IsValid(); ++i)
+        {
+            if (!mHeaps[i].Heap || mHeaps[i].Dedicated)
+                continue;
+            a.Block = mHeaps[i].Blocks->Allocate(info.SizeInBytes, info.Alignment);
+            a.Heap = i;
+        }
+        if (!a.IsValid())
+        {
+            a.Heap = AddHeap(mHeapSize, false);
+            a.Block = mHeaps[a.Heap].Blocks->Allocate(info.SizeInBytes, info.Alignment);
+        }
+    }
+
+    if (!a.IsValid())
+        throw std::runtime_error("GPU heap allocation failed");
+
+    ComPtr<ID3D12Resource> resource;
+    ThrowIfFailed(mDevice->CreatePlacedResource(
+        mHeaps[a.Heap].Heap.Get(),
+        GetOffset(a),
+        &desc,
+        initialState,
+        nullptr,
+        IID_PPV_ARGS(&resource)));
+
+    outAllocation = a;
+    return resource;
+}
+
+void GpuHeapAllocator::Free(GpuAllocation& allocation)
+{
+    if (!allocation.IsValid())
+        return;
+
+    // Shared heaps are kept for reuse; dedicated ones go with their resource.
+    HeapBlock& heap = mHeaps[allocation.Heap];
+    if (heap.Dedicated)
+        heap = HeapBlock();
+    else
+        heap.Blocks->Free(allocation.Block);
+
+    allocation = GpuAllocation();
+}
+
+GpuMemoryStats GpuHeapAllocator::GetStats() const
+{
+    GpuMemoryStats s;
+    for (const HeapBlock& heap : mHeaps)
+    {
+        if (!heap.Heap)
+            continue;
+
+        s.Heaps++;
+        if (heap.Dedicated)
+        {
+            s.Reserved += heap.Size;
+            s.Used += heap.Size;
+            s.Allocations++;
+            continue;
+        }
+
+        TlsfStats t = heap.Blocks->GetStats();
+        s.Reserved += t.Capacity;
+        s.Used += t.Used;
+        s.Allocations += t.Allocations;
+        s.Fragmentation = (std::max)(s.Fragmentation, t.Fragmentation());
+    }
+    return s;
+}
+
+uint32_t GpuHeapAllocator::Defragment(const std::function<void(const GpuAllocation&, UINT64, UINT64)>& move,
+                                      uint32_t maxMoves)
+{
+    uint32_t moves = 0;
+    for (uint32_t i = 0; i < (uint32_t)mHeaps.size() && moves < maxMoves; ++i)
+    {
+        if (!mHeaps[i].Heap || mHeaps[i].Dedicated)
+            continue;
+
+        moves += mHeaps[i].Blocks->Defragment(
+            [&](TlsfAllocator::Handle block, uint64_t from, uint64_t to, uint64_t)
+            {
+                GpuAllocation a;
+                a.Heap = i;
+                a.Block = block;
+                move(a, from, to);
+            },
+            maxMoves - moves);
+    }
+    return moves;
+}
@@ -0,0 +1,76 @@
+// GpuMemory.h
+#pragma once
+#include "Common.h"
+#include "TlsfAllocator.h"
+#include <functional>
+
+struct GpuAllocation
+{
+    uint32_t Heap = 0xFFFFFFFFu;
+    TlsfAllocator::Handle Block = TlsfAllocator::InvalidHandle;
+
+    bool IsValid() const { return Block != TlsfAllocator::InvalidHandle; }
+};
+
+struct GpuMemoryStats
+{
+    uint32_t Heaps = 0;
+    uint64_t Reserved = 0;
+    uint64_t Used = 0;
+    uint32_t Allocations = 0;
+    float    Fragmentation = 0.0f; // worst heap
+};
+
+// Reserves large ID3D12Heaps and places resources in them, so a buffer costs
+// a TLSF allocation instead of an implicit heap of its own. Resources larger
+// than the heap size get a dedicated heap, which is released with them.
+class GpuHeapAllocator
+{
+public:
+    GpuHeapAllocator(ID3D12Device* device, D3D12_HEAP_TYPE type, D3D12_HEAP_FLAGS flags, UINT64 heapSize);
+
+    ComPtr<ID3D12Resource> CreateResource(const D3D12_RESOURCE_DESC& desc,
+        D3D12_RESOURCE_STATES initialState, GpuAllocation& outAllocation);
+
+    // The resource placed at the allocation must already be released and no
+    // longer used by the GPU.
+    void Free(GpuAllocation& allocation);
+
+    ID3D12Heap* GetHeap(const GpuAllocation& a) const { return mHeaps[a.Heap].Heap.Get(); }
+    UINT64      GetOffset(const GpuAllocation& a) const
+    {
+        return a.Block == DedicatedBlock ? 0 : mHeaps[a.Heap].Blocks->GetOffset(a.Block);
+    }
+
+    GpuMemoryStats GetStats() const;
+
+    // Compacts each heap. move(allocation, oldOffset, newOffset) must place a
+    // new resource at newOffset in the same heap and copy the old contents
+    // before the old resource is released.
+    uint32_t Defragment(const std::function<void(const GpuAllocation&, UINT64, UINT64)>& move,
+                        uint32_t maxMoves);
+
+private:
+    // A dedicated heap holds one resource at offset 0 and has no TLSF: its
+    // size is exact, and TLSF's size classes would not find a block that
+    // fills the whole range.
+    static const TlsfAllocator::Handle DedicatedBlock = TlsfAllocator::InvalidHandle - 1;
+
+    struct HeapBlock
+    {
+        ComPtr<ID3D12Heap> Heap;
+        std::unique_ptr<TlsfAllocator> Blocks;   // null for dedicated heaps
+        UINT64 Size = 0;
+        bool Dedicated = false;
+    };
+
+    uint32_t AddHeap(UINT64 size, bool dedicated);
+
+private:
+    ID3D12Device*    mDevice;
+    D3D12_HEAP_TYPE  mType;
+    D3D12_HEAP_FLAGS mFlags;
+    UINT64           mHeapSize;
+
+    std::vector<HeapBlock> mHeaps;
+};
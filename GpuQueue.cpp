@@ -0,0 +1,39 @@
+// GpuQueue.cpp
+#include "GpuQueue.h"
+
+D3D12GpuQueue::D3D12GpuQueue(ID3D12Device* device, ID3D12CommandQueue* queue)
+    : mQueue(queue)
+{
+    ThrowIfFailed(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&mFence)));
+
+    mEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (!mEvent)
+        throw std::runtime_error("CreateEvent failed");
+}
+
+D3D12GpuQueue::~D3D12GpuQueue()
+{
+    if (mEvent)
+        CloseHandle(mEvent);
+}
+
+uint64_t D3D12GpuQueue::Signal()
+{
+    ++mNextValue;
+    ThrowIfFailed(mQueue->Signal(mFence.Get(), mNextValue));
+    return mNextValue;
+}
+
+uint64_t D3D12GpuQueue::CompletedValue() const
+{
+    return mFence->GetCompletedValue();
+}
+
+void D3D12GpuQueue::WaitForValue(uint64_t value)
+{
+    if (mFence->GetCompletedValue() >= value)
+        return;
+
+    ThrowIfFailed(mFence->SetEventOnCompletion(value, mEvent));
+    WaitForSingleObject(mEvent, INFINITE);
+}
@@ -0,0 +1,24 @@
+// GpuQueue.h
+#pragma once
+#include "Common.h"
+#include "FrameRing.h"
+
+class D3D12GpuQueue : public IGpuQueue
+{
+public:
+    D3D12GpuQueue(ID3D12Device* device, ID3D12CommandQueue* queue);
+    virtual ~D3D12GpuQueue();
+
+    virtual uint64_t Signal() override;
+    virtual uint64_t CompletedValue() const override;
+    virtual void     WaitForValue(uint64_t value) override;
+
+    ID3D12CommandQueue* GetQueue() const { return mQueue; }
+    ID3D12Fence*        GetFence() const { return mFence.Get(); }
+
+private:
+    ID3D12CommandQueue* mQueue;
+    ComPtr<ID3D12Fence> mFence;
+    HANDLE   mEvent = nullptr;
+    uint64_t mNextValue = 0;
+};
@@ -1,82 +1,108 @@
 #include "InputDevice.h"
 #include <windowsx.h>
+#include "Timer.h"
+
+int64_t InputDevice::Now()
+{
+    return GameTimer::Counter();
+}
+
+uint8_t InputDevice::ButtonKey(int button)
+{
+    static const uint8_t keys[3] = { VK_LBUTTON, VK_RBUTTON, VK_MBUTTON };
+    return keys[button];
+}
+
 void InputDevice::Initialize(HWND hwnd)
 {
     mHwnd = hwnd;
-    GetCursorPos(&mMousePos);
-    ScreenToClient(mHwnd, &mMousePos);
-    mPrevMousePos = mMousePos;
+    POINT p{ 0,0 };
+    GetCursorPos(&p);
+    ScreenToClient(mHwnd, &p);
+    mState.SetMousePosition(p.x, p.y);
 }
 
 void InputDevice::BeginFrame()
 {
-    mPrevKeys = mCurrKeys;
-    mPrevMouse[0] = mCurrMouse[0];
-    mPrevMouse[1] = mCurrMouse[1];
-    mPrevMouse[2] = mCurrMouse[2];
-
-    
-    mWheelDelta = 0;
-
-    
-    mMouseDelta.x = mMousePos.x - mPrevMousePos.x;
-    mMouseDelta.y = mMousePos.y - mPrevMousePos.y;
-    mPrevMousePos = mMousePos;
-
-   
-    for (int vk = 0; vk < 256; vk++)
-        mCurrKeys[vk] = (GetAsyncKeyState(vk) & 0x8000) ? 0x80 : 0x00;
+    mState.BeginFrame();
 }
 
 void InputDevice::ProcessMessage(UINT msg, WPARAM wParam, LPARAM lParam)
 {
     switch (msg)
     {
+    case WM_KEYDOWN:
+    case WM_SYSKEYDOWN:  mState.OnKey((uint8_t)wParam, true, Now());  break;
+    case WM_KEYUP:
+    case WM_SYSKEYUP:    mState.OnKey((uint8_t)wParam, false, Now()); break;
+
+    // Ups that happen while another window has focus never reach us.
+    case WM_KILLFOCUS:   mState.ReleaseAll(Now()); break;
+
     case WM_MOUSEMOVE:
     {
-        mMousePos.x = GET_X_LPARAM(lParam);
-        mMousePos.y = GET_Y_LPARAM(lParam);
+        mState.OnMouseMove(GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam), Now());
     } break;
 
-    case WM_LBUTTONDOWN: mCurrMouse[0] = 0x80; SetCapture(mHwnd); break;
-    case WM_LBUTTONUP:   mCurrMouse[0] = 0x00; ReleaseCapture();  break;
+    case WM_LBUTTONDOWN: mState.OnKey(VK_LBUTTON, true, Now());  SetCapture(mHwnd); break;
+    case WM_LBUTTONUP:   mState.OnKey(VK_LBUTTON, false, Now()); ReleaseCapture();  break;
 
-    case WM_RBUTTONDOWN: mCurrMouse[1] = 0x80; SetCapture(mHwnd); break;
-    case WM_RBUTTONUP:   mCurrMouse[1] = 0x00; ReleaseCapture();  break;
+    case WM_RBUTTONDOWN: mState.OnKey(VK_RBUTTON, true, Now());  SetCapture(mHwnd); break;
+    case WM_RBUTTONUP:   mState.OnKey(VK_RBUTTON, false, Now()); ReleaseCapture();  break;
 
-    case WM_MBUTTONDOWN: mCurrMouse[2] = 0x80; SetCapture(mHwnd); break;
-    case WM_MBUTTONUP:   mCurrMouse[2] = 0x00; ReleaseCapture();  break;
+    case WM_MBUTTONDOWN: mState.OnKey(VK_MBUTTON, true, Now());  SetCapture(mHwnd); break;
+    case WM_MBUTTONUP:   mState.OnKey(VK_MBUTTON, false, Now()); ReleaseCapture();  break;
 
     case WM_MOUSEWHEEL:
     {
-        mWheelDelta += GET_WHEEL_DELTA_WPARAM(wParam); 
+        mState.OnWheel(GET_WHEEL_DELTA_WPARAM(wParam), Now()); 
     } break;
 
     default: break;
     }
 }
 
-bool InputDevice::IsKeyDown(uint8_t vk) const
+bool InputDevice::IsMouseDown(int button) const
 {
-    return (mCurrKeys[vk] & 0x80) != 0;
+    return mState.IsDown(ButtonKey(button));
 }
 
-bool InputDevice::WasKeyPressed(uint8_t vk) const
+bool InputDevice::WasMousePressed(int button) const
 {
-    return (mCurrKeys[vk] & 0x80) && !(mPrevKeys[vk] & 0x80);
+    return mState.WasPressed(ButtonKey(button));
 }
 
-bool InputDevice::WasKeyReleased(uint8_t vk) const
+POINT InputDevice::LookDelta() const
 {
-    return !(mCurrKeys[vk] & 0x80) && (mPrevKeys[vk] & 0x80);
+    if (mState.HasRawMouse())
+        return POINT{ mState.RawDeltaX(), mState.RawDeltaY() };
+    return MouseDelta();
 }
 
-bool InputDevice::IsMouseDown(int button) const
+POINT InputDevice::LookPosition() const
 {
-    return (mCurrMouse[button] & 0x80) != 0;
+    // Truncated totals still subtract correctly for any sane motion.
+    if (mState.HasRawMouse())
+        return POINT{ (LONG)mState.RawTotalX(), (LONG)mState.RawTotalY() };
+    return MousePos();
 }
 
-bool InputDevice::WasMousePressed(int button) const
+POINT InputDevice::PollLookPosition() const
+{
+    if (mState.HasRawMouse())
+        return POINT{ (LONG)mState.LiveRawTotalX(), (LONG)mState.LiveRawTotalY() };
+    return PollMousePos();
+}
+
+POINT InputDevice::PollMousePos() const
+{
+    POINT p;
+    if (!GetCursorPos(&p) || !ScreenToClient(mHwnd, &p))
+        return MousePos();
+    return p;
+}
+
+bool InputDevice::PollKeyDown(uint8_t vk) const
 {
-    return (mCurrMouse[button] & 0x80) && !(mPrevMouse[button] & 0x80);
+    return (GetAsyncKeyState(vk) & 0x8000) != 0;
 }
@@ -1,42 +1,52 @@
 #pragma once
 #include <Windows.h>
-#include <array>
+#include "InputState.h"
 
+// Win32 front end for InputState: window messages become events stamped
+// with GameTimer::Counter(), so GameTimer::TimeAt places them in the frame.
 class InputDevice
 {
 public:
     void Initialize(HWND hwnd);
     void BeginFrame();                
     void ProcessMessage(UINT msg, WPARAM wParam, LPARAM lParam);
+    void OnRawMouse(int32_t dx, int32_t dy, int64_t time) { mState.OnRawMouse(dx, dy, time); }
 
     
-    bool IsKeyDown(uint8_t vk) const;
-    bool WasKeyPressed(uint8_t vk) const;   
-    bool WasKeyReleased(uint8_t vk) const;  
+    bool IsKeyDown(uint8_t vk) const { return mState.IsDown(vk); }
+    bool WasKeyPressed(uint8_t vk) const { return mState.WasPressed(vk); }
+    bool WasKeyReleased(uint8_t vk) const { return mState.WasReleased(vk); }
 
     
-    POINT MousePos() const { return mMousePos; }
-    POINT MouseDelta() const { return mMouseDelta; }
-    int   WheelDelta() const { return mWheelDelta; }
+    POINT MousePos() const { return POINT{ mState.MouseX(), mState.MouseY() }; }
+    POINT MouseDelta() const { return POINT{ mState.MouseDeltaX(), mState.MouseDeltaY() }; }
+    int   WheelDelta() const { return mState.WheelDelta(); }
 
     bool IsMouseDown(int button) const;     
     bool WasMousePressed(int button) const;
 
-private:
-    HWND mHwnd = nullptr;
-
-    std::array<uint8_t, 256> mCurrKeys{};
-    std::array<uint8_t, 256> mPrevKeys{};
+    // Motion for looking around: raw device counts once raw input has
+    // arrived, cursor pixels otherwise. LookPosition is a running total
+    // (or the cursor) as of BeginFrame, for measuring motion since then.
+    POINT LookDelta() const;
+    POINT LookPosition() const;
 
-    uint8_t mCurrMouse[3]{};
-    uint8_t mPrevMouse[3]{};
+    // The frame's input in arrival order, for anything that needs sub-frame ordering
+    const std::vector<InputEvent>& Events() const { return mState.Events(); }
+    const InputState& State() const { return mState; }
 
-    POINT mMousePos{ 0,0 };
-    POINT mPrevMousePos{ 0,0 };
-    POINT mMouseDelta{ 0,0 };
-
-    int mWheelDelta = 0;
+    // The OS state right now rather than as of BeginFrame, for sampling
+    // input late in a frame. vk may be a mouse button (VK_RBUTTON).
+    POINT PollMousePos() const;
+    bool  PollKeyDown(uint8_t vk) const;
+    // LookPosition including raw motion drained since BeginFrame, or the
+    // polled cursor.
+    POINT PollLookPosition() const;
 
 private:
-    static uint8_t ToByteDown(bool down) { return down ? 0x80 : 0x00; }
+    static int64_t Now();
+    static uint8_t ButtonKey(int button);
+
+    HWND mHwnd = nullptr;
+    InputState mState;
 };
@@ -0,0 +1,88 @@
+// InputState.cpp
+#include "InputState.h"
+
+void InputState::OnKey(uint8_t key, bool down, int64_t time)
+{
+    const bool wasDown = mLiveDown.Test(key);
+    if (down)
+    {
+        // Auto-repeat downs are not presses; only a real down can make a tap.
+        mLiveDown.Set(key);
+        if (!wasDown)
+            mSawDown.Set(key);
+        mPending.push_back({ InputEventType::KeyDown, key, wasDown, 0, 0, time });
+    }
+    else
+    {
+        // An up for a key that is not down (focus came back mid-press) is dropped.
+        if (!wasDown)
+            return;
+        mLiveDown.Clear(key);
+        mSawUp.Set(key);
+        mPending.push_back({ InputEventType::KeyUp, key, false, 0, 0, time });
+    }
+}
+
+void InputState::OnMouseMove(int32_t x, int32_t y, int64_t time)
+{
+    mLiveMouseX = x;
+    mLiveMouseY = y;
+    mPending.push_back({ InputEventType::MouseMove, 0, false, x, y, time });
+}
+
+void InputState::OnWheel(int32_t delta, int64_t time)
+{
+    mLiveWheel += delta;
+    mPending.push_back({ InputEventType::Wheel, 0, false, delta, 0, time });
+}
+
+void InputState::OnRawMouse(int32_t dx, int32_t dy, int64_t time)
+{
+    mLiveRawTotalX += dx;
+    mLiveRawTotalY += dy;
+    mRawSeen = true;
+    mPending.push_back({ InputEventType::RawMouse, 0, false, dx, dy, time });
+}
+
+void InputState::ReleaseAll(int64_t time)
+{
+    for (int key = 0; key < 256; ++key)
+    {
+        if (mLiveDown.Test((uint8_t)key))
+            OnKey((uint8_t)key, false, time);
+    }
+}
+
+void InputState::SetMousePosition(int32_t x, int32_t y)
+{
+    mLiveMouseX = mMouseX = x;
+    mLiveMouseY = mMouseY = y;
+}
+
+void InputState::BeginFrame()
+{
+    const KeyBits prevDown = mDown;
+    const KeyBits tapped = mSawDown & mSawUp;
+
+    mDown = mLiveDown;
+    mPressed = (mDown & ~prevDown) | tapped;
+    mReleased = (prevDown & ~mDown) | tapped;
+    mSawDown = KeyBits();
+    mSawUp = KeyBits();
+
+    mMouseDeltaX = mLiveMouseX - mMouseX;
+    mMouseDeltaY = mLiveMouseY - mMouseY;
+    mMouseX = mLiveMouseX;
+    mMouseY = mLiveMouseY;
+    mWheelDelta = mLiveWheel;
+    mLiveWheel = 0;
+
+    mRawDeltaX = (int32_t)(mLiveRawTotalX - mRawTotalX);
+    mRawDeltaY = (int32_t)(mLiveRawTotalY - mRawTotalY);
+    mRawTotalX = mLiveRawTotalX;
+    mRawTotalY = mLiveRawTotalY;
+
+    // Swap so both vectors keep their capacity from frame to frame.
+    mFrameEvents.swap(mPending);
+    mPending.clear();
+}
@@ -0,0 +1,136 @@
+// InputState.h
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// 256 keys, one bit each, indexed by virtual-key code. Mouse buttons use
+// their key codes too (1 left, 2 right, 4 middle on Windows).
+struct KeyBits
+{
+    uint64_t Words[4] = {};
+
+    bool Test(uint8_t key) const { return (Words[key >> 6] >> (key & 63)) & 1; }
+    void Set(uint8_t key)        { Words[key >> 6] |= 1ull << (key & 63); }
+    void Clear(uint8_t key)      { Words[key >> 6] &= ~(1ull << (key & 63)); }
+    bool Any() const             { return (Words[0] | Words[1] | Words[2] | Words[3]) != 0; }
+
+    KeyBits operator&(const KeyBits& o) const
+    {
+        KeyBits r;
+        for (int i = 0; i < 4; ++i) r.Words[i] = Words[i] & o.Words[i];
+        return r;
+    }
+    KeyBits operator|(const KeyBits& o) const
+    {
+        KeyBits r;
+        for (int i = 0; i < 4; ++i) r.Words[i] = Words[i] | o.Words[i];
+        return r;
+    }
+    KeyBits operator~() const
+    {
+        KeyBits r;
+        for (int i = 0; i < 4; ++i) r.Words[i] = ~Words[i];
+        return r;
+    }
+};
+
+enum class InputEventType : uint8_t
+{
+    KeyDown,
+    KeyUp,
+    MouseMove,
+    Wheel,
+    RawMouse,   // relative device motion, not tied to the cursor
+};
+
+struct InputEvent
+{
+    InputEventType Type;
+    uint8_t  Key;      // KeyDown, KeyUp
+    bool     Repeat;   // KeyDown for a key that was already down
+    int32_t  X;        // MouseMove: position; Wheel, RawMouse: delta
+    int32_t  Y;
+    int64_t  Time;     // the feeder's clock, in arrival order
+};
+
+// Event-driven keyboard and mouse state with no platform calls, so it can
+// be fed synthetic events. Events change the live state as they arrive;
+// BeginFrame closes the frame: it fixes the state the frame reads,
+// computes edges and hands over the frame's events in arrival order.
+//
+// Edges come from the key bits alone:
+//   pressed  = (down & ~prevDown) | (sawDown & sawUp)
+//   released = (prevDown & ~down) | (sawDown & sawUp)
+// so a key tapped within one frame still reports both edges, and
+// auto-repeat (downs without an up) reports none.
+class InputState
+{
+public:
+    void OnKey(uint8_t key, bool down, int64_t time);
+    void OnMouseMove(int32_t x, int32_t y, int64_t time);
+    void OnWheel(int32_t delta, int64_t time);
+    void OnRawMouse(int32_t dx, int32_t dy, int64_t time);
+
+    // Focus loss: the ups for held keys will never arrive.
+    void ReleaseAll(int64_t time);
+
+    // Places the cursor without an event or a delta, e.g. at startup.
+    void SetMousePosition(int32_t x, int32_t y);
+
+    void BeginFrame();
+
+    bool IsDown(uint8_t key) const      { return mDown.Test(key); }
+    bool WasPressed(uint8_t key) const  { return mPressed.Test(key); }
+    bool WasReleased(uint8_t key) const { return mReleased.Test(key); }
+
+    const KeyBits& Down() const     { return mDown; }
+    const KeyBits& Pressed() const  { return mPressed; }
+    const KeyBits& Released() const { return mReleased; }
+
+    int32_t MouseX() const { return mMouseX; }
+    int32_t MouseY() const { return mMouseY; }
+    int32_t MouseDeltaX() const { return mMouseDeltaX; }
+    int32_t MouseDeltaY() const { return mMouseDeltaY; }
+    int32_t WheelDelta() const { return mWheelDelta; }
+
+    // Raw motion summed over the frame, and running totals of all raw
+    // motion: as of BeginFrame, and including what arrived since.
+    bool    HasRawMouse() const { return mRawSeen; }
+    int32_t RawDeltaX() const { return mRawDeltaX; }
+    int32_t RawDeltaY() const { return mRawDeltaY; }
+    int64_t RawTotalX() const { return mRawTotalX; }
+    int64_t RawTotalY() const { return mRawTotalY; }
+    int64_t LiveRawTotalX() const { return mLiveRawTotalX; }
+    int64_t LiveRawTotalY() const { return mLiveRawTotalY; }
+
+    // Events that arrived before the last BeginFrame and after the one before.
+    const std::vector<InputEvent>& Events() const { return mFrameEvents; }
+
+private:
+    // Live state, changed by events
+    KeyBits mLiveDown;
+    KeyBits mSawDown;
+    KeyBits mSawUp;
+    int32_t mLiveMouseX = 0;
+    int32_t mLiveMouseY = 0;
+    int32_t mLiveWheel = 0;
+    int64_t mLiveRawTotalX = 0;
+    int64_t mLiveRawTotalY = 0;
+    bool    mRawSeen = false;
+    std::vector<InputEvent> mPending;
+
+    // State as of the last BeginFrame
+    KeyBits mDown;
+    KeyBits mPressed;
+    KeyBits mReleased;
+    int32_t mMouseX = 0;
+    int32_t mMouseY = 0;
+    int32_t mMouseDeltaX = 0;
+    int32_t mMouseDeltaY = 0;
+    int32_t mWheelDelta = 0;
+    int64_t mRawTotalX = 0;
+    int64_t mRawTotalY = 0;
+    int32_t mRawDeltaX = 0;
+    int32_t mRawDeltaY = 0;
+    std::vector<InputEvent> mFrameEvents;
+};
@@ -0,0 +1,161 @@
+// InputStateCheck.cpp
+// Checks for InputState with synthetic events: InputStateCheck
+// Feeds key, mouse, wheel and raw events between BeginFrame calls and
+// checks the frame view: edges for presses, holds, releases, taps within
+// one frame and auto-repeat, focus loss, mouse and raw deltas, and the
+// frame's event list in arrival order.
+// Standard library only; on Linux:
+//   g++ -O2 -std=c++17 InputStateCheck.cpp InputState.cpp -o InputStateCheck
+#include "InputState.h"
+#include <cstdio>
+
+namespace
+{
+    int gFailures = 0;
+
+    void Check(bool ok, const char* what, long long a = 0, long long b = 0)
+    {
+        if (!ok && gFailures++ < 10)
+            printf("FAIL: %s (%lld, %lld)\n", what, a, b);
+    }
+
+    const uint8_t KeyW = 'W';
+    const uint8_t KeyA = 'A';
+    const uint8_t KeySpace = 0x20;
+    const uint8_t MouseLeft = 0x01;
+
+    void KeyEdges()
+    {
+        InputState input;
+        int64_t t = 0;
+
+        // Press: down and pressed for one frame, then only down.
+        input.OnKey(KeyW, true, ++t);
+        input.BeginFrame();
+        Check(input.IsDown(KeyW) && input.WasPressed(KeyW) && !input.WasReleased(KeyW), "press edge");
+        input.BeginFrame();
+        Check(input.IsDown(KeyW) && !input.WasPressed(KeyW), "held, no edge");
+
+        // Auto-repeat downs: flagged as repeats, no new edge.
+        input.OnKey(KeyW, true, ++t);
+        input.OnKey(KeyW, true, ++t);
+        input.BeginFrame();
+        Check(input.IsDown(KeyW) && !input.WasPressed(KeyW), "repeat is not a press");
+        Check(input.Events().size() == 2 && input.Events()[0].Repeat, "repeat flagged", (long long)input.Events().size());
+
+        // Release in the same frame as a repeat: a release edge, not a tap.
+        input.OnKey(KeyW, true, ++t);
+        input.OnKey(KeyW, false, ++t);
+        input.BeginFrame();
+        Check(!input.IsDown(KeyW) && input.WasReleased(KeyW) && !input.WasPressed(KeyW), "release after a repeat");
+
+        // Tap inside one frame: never seen down, but both edges report.
+        input.OnKey(KeySpace, true, ++t);
+        input.OnKey(KeySpace, false, ++t);
+        input.BeginFrame();
+        Check(!input.IsDown(KeySpace) && input.WasPressed(KeySpace) && input.WasReleased(KeySpace), "tap keeps both edges");
+        input.BeginFrame();
+        Check(!input.WasPressed(KeySpace) && !input.WasReleased(KeySpace), "tap edges last one frame");
+
+        // Release then press again within one frame while held: still down,
+        // and the press is reported.
+        input.OnKey(KeyA, true, ++t);
+        input.BeginFrame();
+        input.OnKey(KeyA, false, ++t);
+        input.OnKey(KeyA, true, ++t);
+        input.BeginFrame();
+        Check(input.IsDown(KeyA) && input.WasPressed(KeyA) && input.WasReleased(KeyA), "re-press within a frame");
+
+        // An up without a down (focus returned mid-press) is ignored.
+        input.OnKey(KeyW, false, ++t);
+        input.BeginFrame();
+        Check(!input.WasReleased(KeyW) && input.Events().empty(), "stray up dropped", (long long)input.Events().size());
+    }
+
+    void FocusLoss()
+    {
+        InputState input;
+        input.OnKey(KeyW, true, 1);
+        input.OnKey(MouseLeft, true, 2);
+        input.BeginFrame();
+
+        input.ReleaseAll(3);
+        input.BeginFrame();
+        Check(!input.Down().Any(), "nothing held after focus loss");
+        Check(input.WasReleased(KeyW) && input.WasReleased(MouseLeft), "released edges reported");
+        Check(input.Events().size() == 2 && input.Events()[0].Type == InputEventType::KeyUp, "ups queued",
+              (long long)input.Events().size());
+    }
+
+    void Mouse()
+    {
+        InputState input;
+        input.SetMousePosition(100, 100);
+        input.BeginFrame();
+        Check(input.MouseDeltaX() == 0 && input.MouseDeltaY() == 0, "placing the cursor is not motion");
+
+        // Positions: the frame sees the last one and the delta from the
+        // previous frame, however many moves arrived.
+        input.OnMouseMove(110, 95, 1);
+        input.OnMouseMove(130, 90, 2);
+        input.OnWheel(120, 3);
+        input.OnWheel(-240, 4);
+        input.BeginFrame();
+        Check(input.MouseX() == 130 && input.MouseY() == 90, "last position", input.MouseX(), input.MouseY());
+        Check(input.MouseDeltaX() == 30 && input.MouseDeltaY() == -10, "frame delta", input.MouseDeltaX(), input.MouseDeltaY());
+        Check(input.WheelDelta() == -120, "wheel summed", input.WheelDelta());
+
+        input.BeginFrame();
+        Check(input.MouseDeltaX() == 0 && input.WheelDelta() == 0, "deltas reset");
+
+        // Raw motion sums per frame; the live total runs ahead of the frame.
+        Check(!input.HasRawMouse(), "no raw input yet");
+        input.OnRawMouse(3, -1, 5);
+        input.OnRawMouse(4, -2, 6);
+        input.BeginFrame();
+        Check(input.HasRawMouse() && input.RawDeltaX() == 7 && input.RawDeltaY() == -3, "raw summed",
+              input.RawDeltaX(), input.RawDeltaY());
+        input.OnRawMouse(10, 0, 7);
+        Check(input.LiveRawTotalX() - input.RawTotalX() == 10, "live total ahead of the frame",
+              input.LiveRawTotalX() - input.RawTotalX());
+        input.BeginFrame();
+        Check(input.RawTotalX() == 17 && input.RawDeltaX() == 10, "raw totals", (long long)input.RawTotalX());
+    }
+
+    void EventOrder()
+    {
+        InputState input;
+        input.OnKey(KeyW, true, 10);
+        input.OnMouseMove(5, 6, 11);
+        input.OnRawMouse(1, 2, 12);
+        input.OnKey(KeyW, false, 13);
+        input.BeginFrame();
+
+        const std::vector<InputEvent>& e = input.Events();
+        Check(e.size() == 4, "all events kept", (long long)e.size());
+        if (e.size() == 4)
+        {
+            Check(e[0].Type == InputEventType::KeyDown && e[1].Type == InputEventType::MouseMove &&
+                  e[2].Type == InputEventType::RawMouse && e[3].Type == InputEventType::KeyUp, "arrival order");
+            Check(e[0].Time == 10 && e[3].Time == 13 && e[1].X == 5 && e[2].Y == 2, "payloads");
+        }
+
+        // Events arriving after BeginFrame belong to the next frame.
+        input.OnKey(KeyA, true, 14);
+        Check(input.Events().size() == 4, "frame events fixed until the next BeginFrame");
+        input.BeginFrame();
+        Check(input.Events().size() == 1 && input.Events()[0].Key == KeyA, "next frame's events",
+              (long long)input.Events().size());
+    }
+}
+
+int main()
+{
+    KeyEdges();
+    FocusLoss();
+    Mouse();
+    EventOrder();
+
+    printf("%s\n", gFailures == 0 ? "passed" : "FAILED");
+    return gFailures == 0 ? 0 : 1;
+}
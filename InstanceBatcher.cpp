@@ -0,0 +1,40 @@
+// InstanceBatcher.cpp
+#include "InstanceBatcher.h"
+#include <algorithm>
+
+void InstanceBatcher::Build(const InstanceItem* items, uint32_t count, uint32_t maxPerBatch)
+{
+    mSorted.assign(items, items + count);
+    mBatches.clear();
+    mOrder.clear();
+    mStats = InstanceStats();
+
+    std::sort(mSorted.begin(), mSorted.end(), [](const InstanceItem& a, const InstanceItem& b)
+        {
+            if (a.Mesh != b.Mesh) return a.Mesh < b.Mesh;
+            if (a.Material != b.Material) return a.Material < b.Material;
+            return a.Object < b.Object;
+        });
+
+    maxPerBatch = (std::max)(maxPerBatch, 1u);
+    mOrder.reserve(count);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const InstanceItem& item = mSorted[i];
+        bool extend = !mBatches.empty() &&
+            mBatches.back().Mesh == item.Mesh &&
+            mBatches.back().Material == item.Material &&
+            mBatches.back().InstanceCount < maxPerBatch;
+
+        if (extend)
+            mBatches.back().InstanceCount++;
+        else
+            mBatches.push_back({ item.Mesh, item.Material, i, 1 });
+
+        mOrder.push_back(item.Object);
+    }
+
+    mStats.Instances = count;
+    mStats.Batches = (uint32_t)mBatches.size();
+}
@@ -0,0 +1,49 @@
+// InstanceBatcher.h
+#pragma once
+#include <cstdint>
+#include <vector>
+
+struct InstanceItem
+{
+    uint32_t Mesh;
+    uint32_t Material;
+    uint32_t Object;   // caller's id, used to fetch the transform
+};
+
+struct InstanceBatch
+{
+    uint32_t Mesh;
+    uint32_t Material;
+    uint32_t FirstInstance; // into Order()
+    uint32_t InstanceCount;
+};
+
+struct InstanceStats
+{
+    uint32_t Instances = 0;
+    uint32_t Batches = 0;
+};
+
+// Groups visible items that share a mesh and material into instanced
+// draws. Items are ordered by (mesh, material, object), a total order, so
+// the batches and the instance order do not depend on the input order or
+// on how culling was split across threads.
+class InstanceBatcher
+{
+public:
+    // maxPerBatch bounds a batch to what one instance buffer range can hold.
+    void Build(const InstanceItem* items, uint32_t count, uint32_t maxPerBatch = 0xFFFFFFFFu);
+
+    const std::vector<InstanceBatch>& Batches() const { return mBatches; }
+
+    // Object ids in instance order; instance i of batch b is Order()[b.FirstInstance + i].
+    const std::vector<uint32_t>& Order() const { return mOrder; }
+
+    const InstanceStats& GetStats() const { return mStats; }
+
+private:
+    std::vector<InstanceItem>  mSorted;
+    std::vector<InstanceBatch> mBatches;
+    std::vector<uint32_t>      mOrder;
+    InstanceStats              mStats;
+};
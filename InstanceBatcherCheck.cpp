@@ -0,0 +1,168 @@
+// InstanceBatcherCheck.cpp
+// Checks for InstanceBatcher: InstanceBatcherCheck [items] [pairs]
+// Builds batches from shuffled copies of one visible set and checks that
+// the batches and instance order are identical, that maxPerBatch splits a
+// group, that the batches tile the instance order, and that a large set
+// over a few hundred (mesh, material) pairs gives one batch per pair.
+// Standard library only; on Linux:
+//   g++ -O2 -std=c++17 InstanceBatcherCheck.cpp InstanceBatcher.cpp -o InstanceBatcherCheck
+#include "InstanceBatcher.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include <utility>
+
+namespace
+{
+    int gFailures = 0;
+
+    void Check(bool ok, const char* what, long long a = 0, long long b = 0)
+    {
+        if (!ok && gFailures++ < 10)
+            printf("FAIL: %s (%lld, %lld)\n", what, a, b);
+    }
+
+    // count items spread over pairs (mesh, material) combinations, one object each.
+    std::vector<InstanceItem> MakeItems(uint32_t count, uint32_t pairs, uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        std::vector<InstanceItem> items(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const uint32_t pair = i < pairs ? i : rng() % pairs;
+            items[i] = { pair / 8, pair % 8, i };
+        }
+        return items;
+    }
+
+    bool SameBatches(const InstanceBatcher& a, const InstanceBatcher& b)
+    {
+        if (a.Batches().size() != b.Batches().size() || a.Order() != b.Order())
+            return false;
+        for (size_t i = 0; i < a.Batches().size(); ++i)
+        {
+            const InstanceBatch& x = a.Batches()[i];
+            const InstanceBatch& y = b.Batches()[i];
+            if (x.Mesh != y.Mesh || x.Material != y.Material || x.FirstInstance != y.FirstInstance ||
+                x.InstanceCount != y.InstanceCount)
+                return false;
+        }
+        return true;
+    }
+
+    // Batches must cover Order() back to back, each instance with its batch's
+    // mesh and material, and the same key never in two batches unless split.
+    void CheckTiling(const InstanceBatcher& batcher, const std::vector<InstanceItem>& items, uint32_t maxPerBatch)
+    {
+        uint32_t next = 0;
+        for (const InstanceBatch& b : batcher.Batches())
+        {
+            Check(b.FirstInstance == next && b.InstanceCount > 0, "batches tile the order", b.FirstInstance, next);
+            Check(b.InstanceCount <= maxPerBatch, "batch within the limit", b.InstanceCount, maxPerBatch);
+            for (uint32_t i = b.FirstInstance; i < b.FirstInstance + b.InstanceCount && i < batcher.Order().size(); ++i)
+            {
+                const InstanceItem& item = items[batcher.Order()[i]];
+                Check(item.Mesh == b.Mesh && item.Material == b.Material, "instance matches its batch", i);
+            }
+            next = b.FirstInstance + b.InstanceCount;
+        }
+        Check(next == batcher.Order().size() && next == items.size(), "every instance in one batch", next, (long long)items.size());
+
+        std::vector<uint32_t> objects = batcher.Order();
+        std::sort(objects.begin(), objects.end());
+        Check(std::adjacent_find(objects.begin(), objects.end()) == objects.end(), "no object twice");
+    }
+
+    void Determinism()
+    {
+        const std::vector<InstanceItem> items = MakeItems(5000, 40, 1);
+
+        InstanceBatcher reference;
+        reference.Build(items.data(), (uint32_t)items.size());
+        CheckTiling(reference, items, 0xFFFFFFFFu);
+
+        std::mt19937 rng(2);
+        for (int round = 0; round < 8; ++round)
+        {
+            std::vector<InstanceItem> shuffled = items;
+            std::shuffle(shuffled.begin(), shuffled.end(), rng);
+
+            InstanceBatcher batcher;
+            batcher.Build(shuffled.data(), (uint32_t)shuffled.size());
+            Check(SameBatches(reference, batcher), "input order does not matter", round);
+        }
+
+        // Rebuilding into the same batcher leaves nothing behind.
+        InstanceBatcher reused;
+        reused.Build(items.data(), 100);
+        reused.Build(items.data(), (uint32_t)items.size());
+        Check(SameBatches(reference, reused), "rebuild starts clean");
+
+        reused.Build(nullptr, 0);
+        Check(reused.Batches().empty() && reused.Order().empty() && reused.GetStats().Instances == 0, "empty input");
+    }
+
+    void Splitting()
+    {
+        // Ten of one pair, three of another, limit four: 4 + 4 + 2, then 3.
+        std::vector<InstanceItem> items;
+        for (uint32_t i = 0; i < 10; ++i)
+            items.push_back({ 1, 2, 100 - i });
+        for (uint32_t i = 0; i < 3; ++i)
+            items.push_back({ 0, 5, 200 + i });
+
+        InstanceBatcher batcher;
+        batcher.Build(items.data(), (uint32_t)items.size(), 4);
+        const std::vector<InstanceBatch>& b = batcher.Batches();
+        Check(b.size() == 4, "split into four", (long long)b.size());
+        if (b.size() == 4)
+        {
+            Check(b[0].Mesh == 0 && b[0].InstanceCount == 3, "lower mesh first", b[0].Mesh, b[0].InstanceCount);
+            Check(b[1].InstanceCount == 4 && b[2].InstanceCount == 4 && b[3].InstanceCount == 2, "full batches then the rest",
+                  b[3].InstanceCount);
+            Check(batcher.Order()[0] == 200 && batcher.Order()[3] == 91, "objects ascending within a pair",
+                  batcher.Order()[0], batcher.Order()[3]);
+        }
+        Check(batcher.GetStats().Batches == 4 && batcher.GetStats().Instances == 13, "stats");
+
+        // Zero is treated as one per batch.
+        batcher.Build(items.data(), (uint32_t)items.size(), 0);
+        Check(batcher.Batches().size() == items.size(), "limit of zero", (long long)batcher.Batches().size());
+    }
+
+    void Large(uint32_t count, uint32_t pairs)
+    {
+        const std::vector<InstanceItem> items = MakeItems(count, pairs, 3);
+
+        InstanceBatcher batcher;
+        auto start = std::chrono::steady_clock::now();
+        batcher.Build(items.data(), count);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::set<std::pair<uint32_t, uint32_t>> keys;
+        for (const InstanceItem& item : items)
+            keys.insert({ item.Mesh, item.Material });
+
+        Check(batcher.Batches().size() == keys.size(), "one batch per pair", (long long)batcher.Batches().size(),
+              (long long)keys.size());
+        CheckTiling(batcher, items, 0xFFFFFFFFu);
+
+        printf("large: %u items, %u pairs, %zu batches, %.3f ms\n", count, pairs, batcher.Batches().size(), ms);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t items = argc > 1 ? (uint32_t)atoi(argv[1]) : 100000;
+    uint32_t pairs = argc > 2 ? (uint32_t)atoi(argv[2]) : 300;
+
+    Determinism();
+    Splitting();
+    Large(items, (std::max)((std::min)(pairs, items), 1u));
+
+    printf("%s\n", gFailures == 0 ? "passed" : "FAILED");
+    return gFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,292 @@
+// JobSystem.cpp
+#include "JobSystem.h"
+#include <algorithm>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Deque index of the current thread in the system it belongs to.
+static thread_local const JobSystem* tlsSystem = nullptr;
+static thread_local int tlsIndex = -1;
+
+static void PinCurrentThread(uint32_t core)
+{
+#if defined(_WIN32)
+    SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << (core % (sizeof(DWORD_PTR) * 8)));
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core % CPU_SETSIZE, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)core;
+#endif
+}
+
+WorkStealingDeque::WorkStealingDeque(uint32_t capacity)
+    : mJobs(new std::atomic<Job*>[capacity])
+    , mMask((int64_t)capacity - 1)
+{
+}
+
+bool WorkStealingDeque::Push(Job* job)
+{
+    int64_t b = mBottom.load(std::memory_order_relaxed);
+    int64_t t = mTop.load(std::memory_order_acquire);
+    if (b - t > mMask)
+        return false;
+
+    mJobs[b & mMask].store(job, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    mBottom.store(b + 1, std::memory_order_relaxed);
+    return true;
+}
+
+Job* WorkStealingDeque::Pop()
+{
+    int64_t b = mBottom.load(std::memory_order_relaxed) - 1;
+    mBottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = mTop.load(std::memory_order_relaxed);
+
+    if (t > b)
+    {
+        mBottom.store(b + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Job* job = mJobs[b & mMask].load(std::memory_order_relaxed);
+    if (t == b)
+    {
+        // Last item: race the thieves for it.
+        if (!mTop.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            job = nullptr;
+        mBottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+Job* WorkStealingDeque::Steal()
+{
+    int64_t t = mTop.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = mBottom.load(std::memory_order_acquire);
+
+    if (t >= b)
+        return nullptr;
+
+    Job* job = mJobs[t & mMask].load(std::memory_order_relaxed);
+    if (!mTop.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return nullptr;
+    return job;
+}
+
+JobSystem::JobSystem(uint32_t workerCount, bool pinToCores)
+{
+    if (workerCount == 0)
+    {
+        uint32_t cores = std::thread::hardware_concurrency();
+        workerCount = cores > 1 ? cores - 1 : 1;
+    }
+
+    for (uint32_t i = 0; i <= workerCount; ++i)
+        mDeques.push_back(std::make_unique<WorkStealingDeque>(DequeCapacity));
+
+    tlsSystem = this;
+    tlsIndex = 0;
+    if (pinToCores)
+        PinCurrentThread(0);
+
+    for (uint32_t i = 1; i <= workerCount; ++i)
+    {
+        mThreads.emplace_back([this, i, pinToCores]()
+            {
+                if (pinToCores)
+                    PinCurrentThread(i);
+                WorkerMain(i);
+            });
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mStop = true;
+    }
+    mWakeUp.notify_all();
+
+    for (std::thread& t : mThreads)
+        t.join();
+
+    if (tlsSystem == this)
+    {
+        tlsSystem = nullptr;
+        tlsIndex = NotAWorker;
+    }
+}
+
+void JobSystem::Wake()
+{
+    // Pairs with the sleeper bumping mSleeping before it checks mQueued.
+    if (mSleeping.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mWakeUp.notify_one();
+    }
+}
+
+void JobSystem::Run(std::function<void()> function, JobCounter* counter)
+{
+    if (counter)
+        counter->mValue.fetch_add(1, std::memory_order_relaxed);
+
+    Job* job = new Job{ std::move(function), counter };
+
+    mQueued.fetch_add(1);
+    bool queued = tlsSystem == this && mDeques[tlsIndex]->Push(job);
+    if (!queued)
+    {
+        std::lock_guard<std::mutex> lock(mInjectMutex);
+        mInjected.push_back(job);
+    }
+    Wake();
+}
+
+void JobSystem::RunOnWorker(std::function<void()> function, JobCounter* counter)
+{
+    if (counter)
+        counter->mValue.fetch_add(1, std::memory_order_relaxed);
+
+    Job* job = new Job{ std::move(function), counter };
+
+    mQueued.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(mInjectMutex);
+        mWorkerOnly.push_back(job);
+        mWorkerOnlyCount.fetch_add(1);
+    }
+    Wake();
+}
+
+Job* JobSystem::FindJob(int self, uint32_t& seed)
+{
+    if (self != NotAWorker)
+    {
+        if (Job* job = mDeques[self]->Pop())
+            return job;
+    }
+
+    if (self > 0 && mWorkerOnlyCount.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(mInjectMutex);
+        if (!mWorkerOnly.empty())
+        {
+            Job* job = mWorkerOnly.back();
+            mWorkerOnly.pop_back();
+            mWorkerOnlyCount.fetch_sub(1);
+            return job;
+        }
+    }
+
+    // Random victim first so thieves do not all pile onto deque 0.
+    const uint32_t count = (uint32_t)mDeques.size();
+    seed = seed * 1664525u + 1013904223u;
+    uint32_t start = (seed >> 8) % count;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t victim = (start + i) % count;
+        if ((int)victim == self)
+            continue;
+        if (Job* job = mDeques[victim]->Steal())
+            return job;
+    }
+
+    std::lock_guard<std::mutex> lock(mInjectMutex);
+    if (mInjected.empty())
+        return nullptr;
+    Job* job = mInjected.back();
+    mInjected.pop_back();
+    return job;
+}
+
+void JobSystem::Execute(Job* job)
+{
+    mQueued.fetch_sub(1);
+    job->Function();
+    if (job->Counter)
+        job->Counter->mValue.fetch_sub(1, std::memory_order_release);
+    delete job;
+}
+
+void JobSystem::WorkerMain(uint32_t index)
+{
+    tlsSystem = this;
+    tlsIndex = (int)index;
+    uint32_t seed = index * 2654435761u;
+
+    for (;;)
+    {
+        if (Job* job = FindJob((int)index, seed))
+        {
+            Execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        mSleeping.fetch_add(1);
+        mWakeUp.wait(lock, [this]() { return mStop || mQueued.load() > 0; });
+        mSleeping.fetch_sub(1);
+        if (mStop)
+            return;
+    }
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+    const int self = tlsSystem == this ? tlsIndex : NotAWorker;
+    uint32_t seed = 0x9E3779B9u + (uint32_t)(self + 1);
+
+    while (!counter.IsDone())
+    {
+        if (Job* job = FindJob(self, seed))
+            Execute(job);
+        else
+            std::this_thread::yield();
+    }
+}
+
+void JobSystem::ParallelFor(uint32_t count, uint32_t minGrain,
+    const std::function<void(uint32_t begin, uint32_t end)>& body)
+{
+    if (count == 0)
+        return;
+
+    // About four ranges per thread keeps the tail short when items vary in
+    // cost without paying per-item scheduling.
+    const uint32_t threads = ThreadCount();
+    const uint32_t grain = (std::max)((std::max)(minGrain, 1u), (count + threads * 4 - 1) / (threads * 4));
+
+    if (count <= grain)
+    {
+        body(0, count);
+        return;
+    }
+
+    JobCounter counter;
+    for (uint32_t begin = grain; begin < count; begin += grain)
+    {
+        uint32_t end = (std::min)(begin + grain, count);
+        Run([&body, begin, end]() { body(begin, end); }, &counter);
+    }
+
+    body(0, grain);
+    Wait(counter);
+}
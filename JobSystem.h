@@ -0,0 +1,107 @@
+// JobSystem.h
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Completion counter for a group of jobs. Run increments it, finishing a
+// job decrements it; Wait returns once it reaches zero.
+class JobCounter
+{
+public:
+    bool IsDone() const { return mValue.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+    std::atomic<uint32_t> mValue{ 0 };
+};
+
+struct Job
+{
+    std::function<void()> Function;
+    JobCounter*           Counter;
+};
+
+// Chase-Lev work-stealing deque with a fixed capacity (C11 formulation of
+// Le, Pop, Cohen and Zappa Nardelli). The owning thread pushes and pops at
+// the bottom; other threads steal from the top.
+class WorkStealingDeque
+{
+public:
+    explicit WorkStealingDeque(uint32_t capacity); // power of two
+
+    bool Push(Job* job);  // owner; false when full
+    Job* Pop();           // owner
+    Job* Steal();         // any thread
+
+private:
+    std::atomic<int64_t> mTop{ 0 };
+    std::atomic<int64_t> mBottom{ 0 };
+    std::unique_ptr<std::atomic<Job*>[]> mJobs;
+    int64_t mMask;
+};
+
+// One worker per core besides the thread that created the system, each
+// with its own deque. The creating thread owns deque 0 and helps out while
+// it waits; other threads submit through a locked queue. Idle workers steal
+// from a random victim, then sleep until new work is queued.
+class JobSystem
+{
+public:
+    // workerCount 0 means one per core minus the creating thread, at least one.
+    explicit JobSystem(uint32_t workerCount = 0, bool pinToCores = false);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Threads that run jobs, the creating thread included.
+    uint32_t ThreadCount() const { return (uint32_t)mDeques.size(); }
+
+    void Run(std::function<void()> function, JobCounter* counter = nullptr);
+
+    // Like Run, but only worker threads take the job, never the creating
+    // thread. For work meant to overlap with what that thread does next:
+    // queued on its own deque, a Wait or ParallelFor there could pop it and
+    // run it inline.
+    void RunOnWorker(std::function<void()> function, JobCounter* counter = nullptr);
+
+    // Runs queued jobs until counter reaches zero, so waiting inside a job is fine.
+    void Wait(JobCounter& counter);
+
+    // body(begin, end) over [0, count). The grain is derived from count and
+    // ThreadCount, never below minGrain, so ranges do not depend on timing.
+    void ParallelFor(uint32_t count, uint32_t minGrain,
+                     const std::function<void(uint32_t begin, uint32_t end)>& body);
+
+private:
+    static const uint32_t DequeCapacity = 4096;
+    static const int      NotAWorker = -1;
+
+    void WorkerMain(uint32_t index);
+    Job* FindJob(int self, uint32_t& seed);
+    void Execute(Job* job);
+    void Wake();
+
+    std::vector<std::unique_ptr<WorkStealingDeque>> mDeques;
+    std::vector<std::thread> mThreads;
+
+    // Submissions from threads without a deque, and full-deque overflow;
+    // RunOnWorker jobs, which thread 0 skips
+    std::mutex        mInjectMutex;
+    std::vector<Job*> mInjected;
+    std::vector<Job*> mWorkerOnly;
+    std::atomic<uint32_t> mWorkerOnlyCount{ 0 };
+
+    // Jobs queued but not yet taken; workers sleep while it is zero
+    std::atomic<int64_t>    mQueued{ 0 };
+    std::atomic<uint32_t>   mSleeping{ 0 };
+    std::mutex              mSleepMutex;
+    std::condition_variable mWakeUp;
+    std::atomic<bool>       mStop{ false };
+};
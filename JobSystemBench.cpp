@@ -0,0 +1,227 @@
+// JobSystemBench.cpp
+// Scaling benchmark: JobSystemBench [maxThreads] [items]
+// Compares the job system with std::async and a pool behind one locked
+// queue, for a coarse parallel-for and for many tiny independent jobs.
+// Standard library only; on Linux:
+//   g++ -O2 -std=c++17 -pthread JobSystemBench.cpp JobSystem.cpp -o JobSystemBench
+#include "JobSystem.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <future>
+
+namespace
+{
+    // Roughly a culling test's worth of arithmetic per item.
+    float Work(uint32_t i)
+    {
+        float x = (float)i;
+        for (int k = 0; k < 64; ++k)
+            x = std::sqrt(x * 1.0001f + (float)k);
+        return x;
+    }
+
+    // The baseline most code starts with: N threads, one mutex, one queue.
+    class GlobalQueuePool
+    {
+    public:
+        explicit GlobalQueuePool(uint32_t threads)
+        {
+            for (uint32_t i = 0; i < threads; ++i)
+                mThreads.emplace_back([this]() { WorkerMain(); });
+        }
+
+        ~GlobalQueuePool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mStop = true;
+            }
+            mWake.notify_all();
+            for (std::thread& t : mThreads)
+                t.join();
+        }
+
+        void Run(std::function<void()> job)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mJobs.push_back(std::move(job));
+                mPending++;
+            }
+            mWake.notify_one();
+        }
+
+        void WaitIdle()
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mIdle.wait(lock, [this]() { return mPending == 0; });
+        }
+
+    private:
+        void WorkerMain()
+        {
+            for (;;)
+            {
+                std::function<void()> job;
+                {
+                    std::unique_lock<std::mutex> lock(mMutex);
+                    mWake.wait(lock, [this]() { return mStop || !mJobs.empty(); });
+                    if (mStop && mJobs.empty())
+                        return;
+                    job = std::move(mJobs.front());
+                    mJobs.pop_front();
+                }
+
+                job();
+
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (--mPending == 0)
+                    mIdle.notify_all();
+            }
+        }
+
+        std::vector<std::thread> mThreads;
+        std::deque<std::function<void()>> mJobs;
+        std::mutex mMutex;
+        std::condition_variable mWake;
+        std::condition_variable mIdle;
+        uint64_t mPending = 0;
+        bool mStop = false;
+    };
+
+    template <typename F>
+    double TimeMs(F&& f, int repeats = 5)
+    {
+        // Best of several runs; the first run also warms up thread stacks.
+        double best = 1e30;
+        for (int r = 0; r < repeats; ++r)
+        {
+            auto start = std::chrono::steady_clock::now();
+            f();
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (ms < best)
+                best = ms;
+        }
+        return best;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t maxThreads = argc > 1 ? (uint32_t)atoi(argv[1]) : std::thread::hardware_concurrency();
+    uint32_t items = argc > 2 ? (uint32_t)atoi(argv[2]) : 1u << 20;
+    // The job system always has a worker besides the calling thread, so two
+    // is the smallest count all three can be compared at, even on one core.
+    maxThreads = (std::max)(maxThreads, 2u);
+
+    std::vector<float> out(items);
+    const uint32_t tinyJobs = items / 16;
+
+    double serial = TimeMs([&]() { for (uint32_t i = 0; i < items; ++i) out[i] = Work(i); });
+    printf("items %u, serial %.2f ms\n\n", items, serial);
+    printf("%7s | %-28s | %-28s\n", "", "parallel-for (ms / speedup)", "tiny jobs x16 items (ms)");
+    printf("%7s | %8s %9s %9s | %8s %9s %9s\n", "threads", "async", "global", "steal", "async", "global", "steal");
+
+    for (uint32_t threads = 2; threads <= maxThreads; threads *= 2)
+    {
+        const uint32_t chunks = threads * 4;
+        const uint32_t chunk = (items + chunks - 1) / chunks;
+
+        double asyncFor = TimeMs([&]()
+            {
+                std::vector<std::future<void>> f;
+                for (uint32_t c = 0; c < chunks; ++c)
+                {
+                    f.push_back(std::async(std::launch::async, [&, c]()
+                        {
+                            uint32_t end = (std::min)(items, (c + 1) * chunk);
+                            for (uint32_t i = c * chunk; i < end; ++i)
+                                out[i] = Work(i);
+                        }));
+                }
+                for (auto& x : f)
+                    x.get();
+            });
+
+        double asyncTiny = TimeMs([&]()
+            {
+                std::vector<std::future<void>> f;
+                f.reserve(tinyJobs);
+                for (uint32_t j = 0; j < tinyJobs; ++j)
+                {
+                    f.push_back(std::async(std::launch::async, [&, j]()
+                        {
+                            for (uint32_t i = j * 16; i < j * 16 + 16; ++i)
+                                out[i] = Work(i);
+                        }));
+                }
+                for (auto& x : f)
+                    x.get();
+            }, 1);
+
+        double globalFor, globalTiny;
+        {
+            GlobalQueuePool pool(threads);
+            globalFor = TimeMs([&]()
+                {
+                    for (uint32_t c = 0; c < chunks; ++c)
+                    {
+                        pool.Run([&, c]()
+                            {
+                                uint32_t end = (std::min)(items, (c + 1) * chunk);
+                                for (uint32_t i = c * chunk; i < end; ++i)
+                                    out[i] = Work(i);
+                            });
+                    }
+                    pool.WaitIdle();
+                });
+            globalTiny = TimeMs([&]()
+                {
+                    for (uint32_t j = 0; j < tinyJobs; ++j)
+                    {
+                        pool.Run([&, j]()
+                            {
+                                for (uint32_t i = j * 16; i < j * 16 + 16; ++i)
+                                    out[i] = Work(i);
+                            });
+                    }
+                    pool.WaitIdle();
+                });
+        }
+
+        double stealFor, stealTiny;
+        {
+            JobSystem jobs(threads - 1);
+            stealFor = TimeMs([&]()
+                {
+                    jobs.ParallelFor(items, 1, [&](uint32_t begin, uint32_t end)
+                        {
+                            for (uint32_t i = begin; i < end; ++i)
+                                out[i] = Work(i);
+                        });
+                });
+            stealTiny = TimeMs([&]()
+                {
+                    JobCounter counter;
+                    for (uint32_t j = 0; j < tinyJobs; ++j)
+                    {
+                        jobs.Run([&, j]()
+                            {
+                                for (uint32_t i = j * 16; i < j * 16 + 16; ++i)
+                                    out[i] = Work(i);
+                            }, &counter);
+                    }
+                    jobs.Wait(counter);
+                });
+        }
+
+        printf("%7u | %8.2f %9.2f %9.2f | %8.2f %9.2f %9.2f\n", threads,
+            asyncFor, globalFor, stealFor, asyncTiny, globalTiny, stealTiny);
+        printf("%7s | %7.1fx %8.1fx %8.1fx |\n", "", serial / asyncFor, serial / globalFor, serial / stealFor);
+    }
+    return 0;
+}
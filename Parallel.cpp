@@ -0,0 +1,19 @@
+// Parallel.cpp
+#include "Parallel.h"
+
+JobSystem& Jobs()
+{
+    static JobSystem jobs;
+    return jobs;
+}
+
+uint32_t WorkerCount()
+{
+    return Jobs().ThreadCount();
+}
+
+void ParallelFor(uint32_t count, uint32_t minGrain,
+                 const std::function<void(uint32_t begin, uint32_t end)>& body)
+{
+    Jobs().ParallelFor(count, minGrain, body);
+}
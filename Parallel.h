@@ -0,0 +1,19 @@
+// Parallel.h
+#pragma once
+#include "JobSystem.h"
+#include <cstdint>
+#include <functional>
+
+// Process-wide job system, created on first use by the thread that calls
+// it first (normally the main thread).
+JobSystem& Jobs();
+
+uint32_t WorkerCount();
+
+// Runs body(begin, end) over [0, count) on the job system and returns when
+// every range is done; the caller runs ranges too. Ranges are at least
+// minGrain items and are fixed by count and the thread count, so the work
+// split does not depend on thread timing for anything that writes
+// per-item results. Safe to call from inside a job.
+void ParallelFor(uint32_t count, uint32_t minGrain,
+                 const std::function<void(uint32_t begin, uint32_t end)>& body);
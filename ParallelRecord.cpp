@@ -0,0 +1,49 @@
+// ParallelRecord.cpp
+#include "ParallelRecord.h"
+#include "Parallel.h"
+#include <algorithm>
+
+void PartitionDraws(uint32_t drawCount, uint32_t maxLists, uint32_t minDraws,
+                    std::vector<RecordRange>& out)
+{
+    out.clear();
+    if (drawCount == 0)
+        return;
+
+    // Round down so every list gets at least minDraws; a count below the
+    // minimum still records, as one list.
+    minDraws = (std::max)(minDraws, 1u);
+    uint32_t lists = (std::max)(drawCount / minDraws, 1u);
+    lists = (std::max)((std::min)(lists, maxLists), 1u);
+
+    const uint32_t base = drawCount / lists;
+    const uint32_t extra = drawCount % lists;
+
+    uint32_t first = 0;
+    for (uint32_t i = 0; i < lists; ++i)
+    {
+        uint32_t count = base + (i < extra ? 1u : 0u);
+        out.push_back({ first, count });
+        first += count;
+    }
+}
+
+uint32_t RecordParallel(ICommandRecorder& recorder, uint32_t drawCount,
+                        uint32_t maxLists, uint32_t minDraws)
+{
+    std::vector<RecordRange> ranges;
+    PartitionDraws(drawCount, maxLists, minDraws, ranges);
+
+    // One range per work item, so a list never spans two threads.
+    ParallelFor((uint32_t)ranges.size(), 1, [&](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                recorder.BeginList(i);
+                recorder.RecordDraws(i, ranges[i].First, ranges[i].Count);
+                recorder.EndList(i);
+            }
+        });
+
+    return (uint32_t)ranges.size();
+}
@@ -0,0 +1,35 @@
+// ParallelRecord.h
+#pragma once
+#include <cstdint>
+#include <vector>
+
+struct RecordRange
+{
+    uint32_t First;
+    uint32_t Count;
+};
+
+// Splits [0, drawCount) into at most maxLists contiguous ranges of at least
+// minDraws draws; only a lone range for fewer than minDraws draws is
+// smaller. Ranges differ in size by at most one draw and are in draw order.
+void PartitionDraws(uint32_t drawCount, uint32_t maxLists, uint32_t minDraws,
+                    std::vector<RecordRange>& out);
+
+// What the parallel recording path drives. list is the index of the range
+// being recorded; each index is begun, filled and ended on a single thread,
+// and distinct indices may be recorded concurrently.
+class ICommandRecorder
+{
+public:
+    virtual ~ICommandRecorder() = default;
+
+    virtual void BeginList(uint32_t list) = 0;
+    virtual void RecordDraws(uint32_t list, uint32_t first, uint32_t count) = 0;
+    virtual void EndList(uint32_t list) = 0;
+};
+
+// Partitions the draws and records one list per range on worker threads.
+// Returns the number of lists; submitting them in index order reproduces
+// the single-threaded draw order.
+uint32_t RecordParallel(ICommandRecorder& recorder, uint32_t drawCount,
+                        uint32_t maxLists, uint32_t minDraws);
@@ -0,0 +1,231 @@
+// ParallelRecordCheck.cpp
+// Checks and scaling benchmark: ParallelRecordCheck [draws] [frames]
+// Checks PartitionDraws over a sweep of draw counts and limits (ranges tile
+// the draws in list order, none below the minimum unless there is only one,
+// no more lists than allowed, sizes within one draw), then drives
+// RecordParallel with a recording mock that checks each list is begun,
+// filled and ended once, on one thread, and that the lists in index order
+// replay the draws in order. Last, records a frame of draws with a mock that
+// does a command's worth of work per draw and times it for growing list
+// counts against a single list.
+// Standard library only; on Linux:
+//   g++ -O2 -std=c++17 -pthread ParallelRecordCheck.cpp ParallelRecord.cpp Parallel.cpp JobSystem.cpp -o ParallelRecordCheck
+#include "ParallelRecord.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+namespace
+{
+    int gFailures = 0;
+
+    void Check(bool ok, const char* what, long long a = 0, long long b = 0)
+    {
+        if (!ok && gFailures++ < 10)
+            printf("FAIL: %s (%lld, %lld)\n", what, a, b);
+    }
+
+    void Partitions()
+    {
+        const uint32_t minimums[] = { 0, 1, 7, 64, 256 };
+        std::vector<RecordRange> ranges;
+
+        for (uint32_t drawCount = 0; drawCount <= 3000; drawCount += (drawCount < 300 ? 1 : 37))
+        {
+            for (uint32_t maxLists = 0; maxLists <= 16; ++maxLists)
+            {
+                for (uint32_t minDraws : minimums)
+                {
+                    PartitionDraws(drawCount, maxLists, minDraws, ranges);
+                    if (drawCount == 0)
+                    {
+                        Check(ranges.empty(), "no draws, no lists", (long long)ranges.size());
+                        continue;
+                    }
+
+                    const uint32_t lists = (uint32_t)ranges.size();
+                    Check(lists >= 1 && lists <= (std::max)(maxLists, 1u), "list count within limit", lists, maxLists);
+
+                    uint32_t next = 0, smallest = drawCount, largest = 0;
+                    for (const RecordRange& r : ranges)
+                    {
+                        Check(r.First == next && r.Count > 0, "ranges tile in order", r.First, next);
+                        next = r.First + r.Count;
+                        smallest = (std::min)(smallest, r.Count);
+                        largest = (std::max)(largest, r.Count);
+                    }
+                    Check(next == drawCount, "ranges cover every draw", next, drawCount);
+                    Check(lists == 1 || smallest >= minDraws, "no range below the minimum", smallest, minDraws);
+                    Check(largest - smallest <= 1, "ranges balanced", smallest, largest);
+                }
+            }
+        }
+
+        // Just over one minimum is one list, not two short ones.
+        PartitionDraws(300, 8, 256, ranges);
+        Check(ranges.size() == 1 && ranges[0].Count == 300, "300 draws at 256 minimum", (long long)ranges.size());
+        PartitionDraws(100, 8, 256, ranges);
+        Check(ranges.size() == 1 && ranges[0].Count == 100, "below the minimum still records", (long long)ranges.size());
+    }
+
+    // Logs every call per list; lists are only touched by the thread that
+    // began them, so each list's log needs no lock.
+    class RecordingMock : public ICommandRecorder
+    {
+    public:
+        explicit RecordingMock(uint32_t maxLists) : mLists(maxLists) {}
+
+        void BeginList(uint32_t list) override
+        {
+            if (list >= mLists.size())
+            {
+                mBadIndex = true;
+                return;
+            }
+            List& l = mLists[list];
+            l.Begins++;
+            l.Thread = std::this_thread::get_id();
+            l.Open = true;
+        }
+
+        void RecordDraws(uint32_t list, uint32_t first, uint32_t count) override
+        {
+            if (list >= mLists.size())
+            {
+                mBadIndex = true;
+                return;
+            }
+            List& l = mLists[list];
+            l.InOrder &= l.Open && l.Thread == std::this_thread::get_id();
+            l.Records++;
+            l.First = first;
+            l.Count = count;
+        }
+
+        void EndList(uint32_t list) override
+        {
+            if (list >= mLists.size())
+            {
+                mBadIndex = true;
+                return;
+            }
+            List& l = mLists[list];
+            l.InOrder &= l.Open && l.Thread == std::this_thread::get_id();
+            l.Open = false;
+            l.Ends++;
+        }
+
+        struct List
+        {
+            uint32_t Begins = 0, Records = 0, Ends = 0;
+            uint32_t First = 0, Count = 0;
+            bool     Open = false;
+            bool     InOrder = true;
+            std::thread::id Thread;
+        };
+
+        std::vector<List> mLists;
+        std::atomic<bool> mBadIndex{ false };
+    };
+
+    void Recording()
+    {
+        const uint32_t counts[] = { 0, 1, 255, 256, 300, 1000, 4099, 50000 };
+        const uint32_t limits[] = { 1, 3, 8, 64 };
+        for (uint32_t drawCount : counts)
+        {
+            for (uint32_t maxLists : limits)
+            {
+                RecordingMock mock(maxLists);
+                const uint32_t lists = RecordParallel(mock, drawCount, maxLists, 256);
+                Check(!mock.mBadIndex, "list index in range");
+                Check(lists <= maxLists && (drawCount == 0 || lists >= 1), "returned list count", lists, maxLists);
+
+                uint32_t next = 0;
+                for (uint32_t i = 0; i < maxLists; ++i)
+                {
+                    const RecordingMock::List& l = mock.mLists[i];
+                    if (i >= lists)
+                    {
+                        Check(l.Begins == 0 && l.Records == 0 && l.Ends == 0, "unused list untouched", i);
+                        continue;
+                    }
+                    Check(l.Begins == 1 && l.Records == 1 && l.Ends == 1, "begin, record, end once", i, l.Begins + l.Records + l.Ends);
+                    Check(l.InOrder && !l.Open, "begin, record, end on one thread in order", i);
+                    Check(l.First == next, "lists in index order replay the draws", l.First, next);
+                    Check(lists == 1 || l.Count >= 256, "recorded range at least the minimum", l.Count);
+                    next += l.Count;
+                }
+                Check(next == drawCount, "every draw recorded once", next, drawCount);
+            }
+        }
+    }
+
+    // Roughly what recording one draw costs: root arguments, a few state
+    // changes and the draw itself written into the list.
+    class BusyRecorder : public ICommandRecorder
+    {
+    public:
+        explicit BusyRecorder(uint32_t maxLists) : mCommands(maxLists) {}
+
+        void BeginList(uint32_t list) override { mCommands[list].clear(); }
+
+        void RecordDraws(uint32_t list, uint32_t first, uint32_t count) override
+        {
+            std::vector<uint32_t>& out = mCommands[list];
+            for (uint32_t d = first; d < first + count; ++d)
+            {
+                uint32_t h = d * 2654435761u;
+                for (int k = 0; k < 48; ++k)
+                {
+                    h ^= h >> 13;
+                    h *= 0x5bd1e995u;
+                    out.push_back(h);
+                }
+            }
+        }
+
+        void EndList(uint32_t) override {}
+
+        std::vector<std::vector<uint32_t>> mCommands;
+    };
+
+    void Scaling(uint32_t draws, uint32_t frames)
+    {
+        printf("scaling: %u draws, %u frames, %u threads\n", draws, frames, WorkerCount());
+        printf("  %5s  %10s  %7s\n", "lists", "ms/frame", "speedup");
+
+        double single = 0.0;
+        for (uint32_t maxLists = 1; maxLists <= (std::max)(2 * WorkerCount(), 2u); maxLists *= 2)
+        {
+            BusyRecorder recorder(maxLists);
+            RecordParallel(recorder, draws, maxLists, 256);   // warm the command vectors
+
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t f = 0; f < frames; ++f)
+                RecordParallel(recorder, draws, maxLists, 256);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+
+            if (maxLists == 1)
+                single = ms;
+            printf("  %5u  %10.3f  %6.2fx\n", maxLists, ms, single / ms);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t draws = argc > 1 ? (uint32_t)atoi(argv[1]) : 50000;
+    uint32_t frames = argc > 2 ? (uint32_t)atoi(argv[2]) : 50;
+
+    Partitions();
+    Recording();
+    Scaling(draws, (std::max)(frames, 1u));
+
+    printf("%s\n", gFailures == 0 ? "passed" : "FAILED");
+    return gFailures == 0 ? 0 : 1;
+}
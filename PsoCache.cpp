@@ -0,0 +1,203 @@
+// PsoCache.cpp
+#include "PsoCache.h"
+#include "Parallel.h"
+#include "ShaderArchive.h"
+#include <chrono>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+    template <typename T>
+    uint64_t HashValue(const T& value, uint64_t h)
+    {
+        return HashBytes(&value, sizeof(value), h);
+    }
+
+    // The blend and depth-stencil structs have padding after their UINT8
+    // masks, which the CD3DX12 constructors leave uninitialised; hash them
+    // field by field so the key is the same from run to run.
+    uint64_t HashBlend(const D3D12_BLEND_DESC& b, uint64_t h)
+    {
+        h = HashValue(b.AlphaToCoverageEnable, h);
+        h = HashValue(b.IndependentBlendEnable, h);
+        for (const D3D12_RENDER_TARGET_BLEND_DESC& rt : b.RenderTarget)
+        {
+            h = HashValue(rt.BlendEnable, h);
+            h = HashValue(rt.LogicOpEnable, h);
+            h = HashValue(rt.SrcBlend, h);
+            h = HashValue(rt.DestBlend, h);
+            h = HashValue(rt.BlendOp, h);
+            h = HashValue(rt.SrcBlendAlpha, h);
+            h = HashValue(rt.DestBlendAlpha, h);
+            h = HashValue(rt.BlendOpAlpha, h);
+            h = HashValue(rt.LogicOp, h);
+            h = HashValue(rt.RenderTargetWriteMask, h);
+        }
+        return h;
+    }
+
+    uint64_t HashStencilOp(const D3D12_DEPTH_STENCILOP_DESC& op, uint64_t h)
+    {
+        h = HashValue(op.StencilFailOp, h);
+        h = HashValue(op.StencilDepthFailOp, h);
+        h = HashValue(op.StencilPassOp, h);
+        return HashValue(op.StencilFunc, h);
+    }
+
+    uint64_t HashDepthStencil(const D3D12_DEPTH_STENCIL_DESC& d, uint64_t h)
+    {
+        h = HashValue(d.DepthEnable, h);
+        h = HashValue(d.DepthWriteMask, h);
+        h = HashValue(d.DepthFunc, h);
+        h = HashValue(d.StencilEnable, h);
+        h = HashValue(d.StencilReadMask, h);
+        h = HashValue(d.StencilWriteMask, h);
+        h = HashStencilOp(d.FrontFace, h);
+        return HashStencilOp(d.BackFace, h);
+    }
+}
+
+PsoCache::PsoCache(ID3D12Device* device, const std::wstring& path)
+    : mDevice(device)
+    , mPath(path)
+{
+    ComPtr<ID3D12Device1> device1;
+    if (FAILED(mDevice->QueryInterface(IID_PPV_ARGS(&device1))))
+        return;
+
+    std::ifstream in(mPath.c_str(), std::ios::binary);
+    if (in)
+        mFileData.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+    // A blob from another driver or adapter is rejected; start over empty.
+    HRESULT hr = E_FAIL;
+    if (!mFileData.empty())
+        hr = device1->CreatePipelineLibrary(mFileData.data(), mFileData.size(), IID_PPV_ARGS(&mLibrary));
+
+    if (FAILED(hr))
+    {
+        mFileData.clear();
+        mLibrary.Reset();
+        if (FAILED(device1->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&mLibrary))))
+            mLibrary.Reset();
+    }
+}
+
+PsoCache::~PsoCache()
+{
+    Save();
+}
+
+uint64_t PsoCache::HashDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash)
+{
+    uint64_t h = HashBytes(&rootSignatureHash, sizeof(rootSignatureHash));
+
+    const D3D12_SHADER_BYTECODE* shaders[] = { &desc.VS, &desc.PS, &desc.DS, &desc.HS, &desc.GS };
+    for (const D3D12_SHADER_BYTECODE* s : shaders)
+    {
+        uint64_t code = s->BytecodeLength ? HashBytes(s->pShaderBytecode, s->BytecodeLength) : 0;
+        h = HashBytes(&code, sizeof(code), h);
+    }
+
+    for (UINT i = 0; i < desc.InputLayout.NumElements; ++i)
+    {
+        const D3D12_INPUT_ELEMENT_DESC& e = desc.InputLayout.pInputElementDescs[i];
+        h = HashBytes(e.SemanticName, strlen(e.SemanticName), h);
+        h = HashBytes(&e.SemanticIndex, sizeof(e) - offsetof(D3D12_INPUT_ELEMENT_DESC, SemanticIndex), h);
+    }
+
+    // The rest is plain data without padding; stream output is not used here.
+    h = HashBlend(desc.BlendState, h);
+    h = HashBytes(&desc.SampleMask, sizeof(desc.SampleMask), h);
+    h = HashBytes(&desc.RasterizerState, sizeof(desc.RasterizerState), h);
+    h = HashDepthStencil(desc.DepthStencilState, h);
+    h = HashBytes(&desc.IBStripCutValue, sizeof(desc.IBStripCutValue), h);
+    h = HashBytes(&desc.PrimitiveTopologyType, sizeof(desc.PrimitiveTopologyType), h);
+    h = HashBytes(&desc.NumRenderTargets, sizeof(desc.NumRenderTargets), h);
+    h = HashBytes(desc.RTVFormats, sizeof(desc.RTVFormats), h);
+    h = HashBytes(&desc.DSVFormat, sizeof(desc.DSVFormat), h);
+    h = HashBytes(&desc.SampleDesc, sizeof(desc.SampleDesc), h);
+    h = HashBytes(&desc.NodeMask, sizeof(desc.NodeMask), h);
+    h = HashBytes(&desc.Flags, sizeof(desc.Flags), h);
+    return h;
+}
+
+ComPtr<ID3D12PipelineState> PsoCache::GetOrCreate(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc,
+                                                  uint64_t rootSignatureHash)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    wchar_t name[17];
+    swprintf_s(name, L"%016llx", (unsigned long long)HashDesc(desc, rootSignatureHash));
+
+    ComPtr<ID3D12PipelineState> pso;
+    bool hit = false;
+
+    if (mLibrary && SUCCEEDED(mLibrary->LoadGraphicsPipeline(name, &desc, IID_PPV_ARGS(&pso))))
+    {
+        hit = true;
+    }
+    else
+    {
+        ThrowIfFailed(mDevice->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&pso)));
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        // Another thread may have stored the same pipeline first.
+        if (mLibrary && SUCCEEDED(mLibrary->StorePipeline(name, pso.Get())))
+            mDirty = true;
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (hit)
+        mStats.Hits++;
+    else
+        mStats.Misses++;
+    mStats.CreateMs += ms;
+    return pso;
+}
+
+std::future<ComPtr<ID3D12PipelineState>> PsoCache::GetOrCreateAsync(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc,
+                                                                    uint64_t rootSignatureHash)
+{
+    // Runs on the shared job system; errors reach the caller through the future.
+    auto promise = std::make_shared<std::promise<ComPtr<ID3D12PipelineState>>>();
+    Jobs().Run([this, desc, rootSignatureHash, promise]()
+        {
+            try
+            {
+                promise->set_value(GetOrCreate(desc, rootSignatureHash));
+            }
+            catch (...)
+            {
+                promise->set_exception(std::current_exception());
+            }
+        });
+    return promise->get_future();
+}
+
+void PsoCache::Save()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mLibrary || !mDirty)
+        return;
+
+    std::vector<char> data(mLibrary->GetSerializedSize());
+    if (FAILED(mLibrary->Serialize(data.data(), data.size())))
+        return;
+
+    std::ofstream out(mPath.c_str(), std::ios::binary);
+    if (out)
+    {
+        out.write(data.data(), data.size());
+        mDirty = false;
+    }
+}
+
+PsoCacheStats PsoCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
@@ -0,0 +1,50 @@
+// PsoCache.h
+#pragma once
+#include "Common.h"
+#include <future>
+#include <mutex>
+
+struct PsoCacheStats
+{
+    uint32_t Hits = 0;     // loaded from the pipeline library
+    uint32_t Misses = 0;   // compiled by the driver and stored
+    double   CreateMs = 0.0;
+};
+
+// Graphics PSOs backed by an ID3D12PipelineLibrary that is read from and
+// written back to disk. Entries are named by a hash of the whole pipeline
+// description, with shaders and the root signature hashed by content, so
+// any change to either gives a new entry rather than a stale hit.
+class PsoCache
+{
+public:
+    PsoCache(ID3D12Device* device, const std::wstring& path);
+    ~PsoCache();
+
+    static uint64_t HashDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash);
+
+    ComPtr<ID3D12PipelineState> GetOrCreate(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc,
+                                            uint64_t rootSignatureHash);
+
+    // Runs GetOrCreate on a worker thread. Everything desc points to must
+    // stay alive until the future is ready.
+    std::future<ComPtr<ID3D12PipelineState>> GetOrCreateAsync(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc,
+                                                             uint64_t rootSignatureHash);
+
+    // Writes the library back if anything was added since it was loaded.
+    void Save();
+
+    PsoCacheStats GetStats() const;
+
+private:
+    ID3D12Device*   mDevice;
+    std::wstring    mPath;
+
+    // The library references this memory for as long as it lives.
+    std::vector<char>              mFileData;
+    ComPtr<ID3D12PipelineLibrary>  mLibrary;
+    bool                           mDirty = false;
+
+    mutable std::mutex mMutex;
+    PsoCacheStats      mStats;
+};
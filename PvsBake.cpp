@@ -0,0 +1,164 @@
+// PvsBake.cpp
+#include "PvsBake.h"
+#include "Bvh.h"
+#include "Parallel.h"
+#include <algorithm>
+
+namespace
+{
+    // PCG32 (O'Neill), seeded per cell and sample.
+    struct Pcg32
+    {
+        uint64_t State;
+        uint64_t Inc;
+
+        Pcg32(uint64_t seed, uint64_t stream)
+            : State(0), Inc((stream << 1u) | 1u)
+        {
+            Next();
+            State += seed;
+            Next();
+        }
+
+        uint32_t Next()
+        {
+            uint64_t old = State;
+            State = old * 6364136223846793005ULL + Inc;
+            uint32_t xorshifted = (uint32_t)(((old >> 18u) ^ old) >> 27u);
+            uint32_t rot = (uint32_t)(old >> 59u);
+            return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+        }
+
+        float NextFloat() { return (Next() >> 8) * (1.0f / 16777216.0f); }
+    };
+
+    Vec3 UniformSphere(Pcg32& rng)
+    {
+        float z = 1.0f - 2.0f * rng.NextFloat();
+        float r = std::sqrt((std::max)(0.0f, 1.0f - z * z));
+        float phi = 6.28318530718f * rng.NextFloat();
+        return { r * std::cos(phi), r * std::sin(phi), z };
+    }
+
+    bool IsSolid(const TriangleBvh& bvh, const Vec3& p)
+    {
+        static const Vec3 dirs[6] = {
+            { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+
+        int backHits = 0;
+        for (const Vec3& d : dirs)
+        {
+            RayHit hit;
+            if (bvh.Intersect(p, d, 1e30f, hit) && hit.BackFace)
+                ++backHits;
+        }
+        return backHits >= 4;
+    }
+}
+
+PvsBakeStats BakePvs(const Vec3* positions, const uint32_t* indices, uint32_t indexCount,
+                     const PvsBakeSettings& settings, PvsData& out)
+{
+    PvsBakeStats stats;
+    const uint32_t triCount = indexCount / 3;
+
+    TriangleBvh bvh;
+    bvh.Build(positions, indices, triCount);
+
+    // Clusters are runs of consecutive triangles, so a visible set maps
+    // straight onto DrawIndexedInstanced ranges.
+    const uint32_t perCluster = (std::max)(settings.TrianglesPerCluster, 1u);
+    std::vector<PvsCluster> clusters;
+    for (uint32_t t = 0; t < triCount; t += perCluster)
+    {
+        uint32_t n = (std::min)(perCluster, triCount - t);
+        PvsCluster c = { t * 3, n * 3, Aabb::Empty() };
+        for (uint32_t i = c.FirstIndex; i < c.FirstIndex + c.IndexCount; ++i)
+            c.Bounds.Grow(positions[indices[i]]);
+        clusters.push_back(c);
+    }
+
+    const uint32_t clusterCount = (uint32_t)clusters.size();
+    const uint32_t words = (clusterCount + 63) / 64;
+
+    PvsGrid grid = {};
+    Aabb bounds = bvh.Bounds();
+    grid.CellSize = settings.CellSize;
+    grid.Origin = bounds.Min;
+    Vec3 ext = bounds.Max - bounds.Min;
+    grid.Dims[0] = (std::max)(1u, (uint32_t)std::ceil(ext.x / grid.CellSize));
+    grid.Dims[1] = (std::max)(1u, (uint32_t)std::ceil(ext.y / grid.CellSize));
+    grid.Dims[2] = (std::max)(1u, (uint32_t)std::ceil(ext.z / grid.CellSize));
+
+    const uint32_t cellCount = grid.CellCount();
+    std::vector<std::vector<uint8_t>> cells(cellCount);
+    std::vector<uint32_t> visibleCounts(cellCount, 0);
+    std::vector<uint8_t> solid(cellCount, 0);
+
+    ParallelFor(cellCount, 1, [&](uint32_t begin, uint32_t end)
+        {
+            std::vector<uint64_t> bits(words);
+            for (uint32_t cell = begin; cell < end; ++cell)
+            {
+                std::fill(bits.begin(), bits.end(), 0);
+                Aabb box = grid.CellBounds(cell);
+
+                if (settings.SkipSolidCells && IsSolid(bvh, box.Center()))
+                {
+                    solid[cell] = 1;
+                }
+                else
+                {
+                    // Anything touching the cell is always visible from it.
+                    for (uint32_t c = 0; c < clusterCount; ++c)
+                    {
+                        if (Overlaps(clusters[c].Bounds, box))
+                            bits[c >> 6] |= 1ULL << (c & 63);
+                    }
+
+                    for (uint32_t s = 0; s < settings.SamplesPerCell; ++s)
+                    {
+                        Pcg32 rng(settings.Seed, (uint64_t)cell * settings.SamplesPerCell + s);
+                        Vec3 o = {
+                            box.Min.x + rng.NextFloat() * grid.CellSize,
+                            box.Min.y + rng.NextFloat() * grid.CellSize,
+                            box.Min.z + rng.NextFloat() * grid.CellSize };
+
+                        for (uint32_t r = 0; r < settings.RaysPerSample; ++r)
+                        {
+                            RayHit hit;
+                            if (bvh.Intersect(o, UniformSphere(rng), 1e30f, hit))
+                            {
+                                uint32_t c = hit.Triangle / perCluster;
+                                bits[c >> 6] |= 1ULL << (c & 63);
+                            }
+                        }
+                    }
+                }
+
+                uint32_t visible = 0;
+                for (uint64_t w : bits)
+                {
+                    for (; w; w &= w - 1)
+                        ++visible;
+                }
+                visibleCounts[cell] = visible;
+
+                PvsData::Compress(bits.data(), words, cells[cell]);
+            }
+        });
+
+    stats.Cells = cellCount;
+    uint64_t visibleSum = 0;
+    for (uint32_t cell = 0; cell < cellCount; ++cell)
+    {
+        stats.SolidCells += solid[cell];
+        visibleSum += visibleCounts[cell];
+    }
+    stats.Rays = (uint64_t)(cellCount - stats.SolidCells) * settings.SamplesPerCell * settings.RaysPerSample;
+    if (cellCount > 0 && clusterCount > 0)
+        stats.AverageVisibleFraction = (double)visibleSum / ((double)cellCount * clusterCount);
+
+    out.Assign(grid, indexCount, std::move(clusters), cells);
+    return stats;
+}
@@ -0,0 +1,27 @@
+// PvsBake.h
+#pragma once
+#include "PvsData.h"
+
+struct PvsBakeSettings
+{
+    float    CellSize = 100.0f;
+    uint32_t TrianglesPerCluster = 256;
+    uint32_t SamplesPerCell = 8;     // ray origins per cell
+    uint32_t RaysPerSample = 512;
+    uint32_t Seed = 1;
+    bool     SkipSolidCells = true;  // cells whose center is enclosed by back faces see nothing
+};
+
+struct PvsBakeStats
+{
+    uint32_t Cells = 0;
+    uint32_t SolidCells = 0;
+    uint64_t Rays = 0;
+    double   AverageVisibleFraction = 0.0;
+};
+
+// Headless PVS bake over an indexed triangle mesh. The result only depends
+// on the mesh and settings: every cell draws its rays from its own seeded
+// sequence, and cells are written back in index order.
+PvsBakeStats BakePvs(const Vec3* positions, const uint32_t* indices, uint32_t indexCount,
+                     const PvsBakeSettings& settings, PvsData& out);
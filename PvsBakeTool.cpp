@@ -0,0 +1,55 @@
+// PvsBakeTool.cpp
+// Offline PVS bake: PvsBakeTool <input.obj> <output.pvs> [cellSize] [samplesPerCell] [raysPerSample]
+// Builds as its own console executable; it creates no window and no device.
+#include "ObjLoader.h"
+#include "PvsBake.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+int wmain(int argc, wchar_t** argv)
+{
+    if (argc < 3)
+    {
+        wprintf(L"usage: %ls <input.obj> <output.pvs> [cellSize] [samplesPerCell] [raysPerSample]\n", argv[0]);
+        return 1;
+    }
+
+    PvsBakeSettings settings;
+    if (argc > 3) settings.CellSize = (float)_wtof(argv[3]);
+    if (argc > 4) settings.SamplesPerCell = (uint32_t)_wtoi(argv[4]);
+    if (argc > 5) settings.RaysPerSample = (uint32_t)_wtoi(argv[5]);
+
+    // Same load path as CubeRenderer so cluster index ranges line up.
+    ObjMeshData mesh;
+    if (!ObjLoader::LoadObjPosNormal(argv[1], mesh, true))
+    {
+        wprintf(L"failed to load %ls\n", argv[1]);
+        return 1;
+    }
+
+    std::vector<Vec3> positions(mesh.Vertices.size());
+    for (size_t i = 0; i < mesh.Vertices.size(); ++i)
+        positions[i] = { mesh.Vertices[i].Pos.x, mesh.Vertices[i].Pos.y, mesh.Vertices[i].Pos.z };
+
+    auto start = std::chrono::steady_clock::now();
+
+    PvsData pvs;
+    PvsBakeStats stats = BakePvs(positions.data(), mesh.Indices.data(), (uint32_t)mesh.Indices.size(), settings, pvs);
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::ofstream out(argv[2], std::ios::binary);
+    if (!out)
+    {
+        wprintf(L"failed to open %ls\n", argv[2]);
+        return 1;
+    }
+    pvs.Write(out);
+
+    wprintf(L"cells: %u (%u solid), clusters: %zu, rays: %llu, visible: %.1f%%, data: %zu bytes, %.2fs\n",
+        stats.Cells, stats.SolidCells, pvs.Clusters().size(), (unsigned long long)stats.Rays,
+        stats.AverageVisibleFraction * 100.0, pvs.CompressedBytes(), seconds);
+
+    return 0;
+}
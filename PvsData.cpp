@@ -0,0 +1,217 @@
+// PvsData.cpp
+#include "PvsData.h"
+#include <istream>
+#include <ostream>
+
+static const uint32_t PvsMagic = 0x31535650; // "PVS1"
+
+// Far beyond what a bake produces; only there to stop a corrupt header
+// from asking for gigabytes.
+static const uint64_t MaxPvsCells = 1u << 24;
+static const uint32_t MaxPvsClusters = 1u << 24;
+
+Aabb PvsGrid::CellBounds(uint32_t cell) const
+{
+    uint32_t x = cell % Dims[0];
+    uint32_t y = (cell / Dims[0]) % Dims[1];
+    uint32_t z = cell / (Dims[0] * Dims[1]);
+
+    Vec3 mn = { Origin.x + x * CellSize, Origin.y + y * CellSize, Origin.z + z * CellSize };
+    return { mn, { mn.x + CellSize, mn.y + CellSize, mn.z + CellSize } };
+}
+
+void PvsData::Assign(const PvsGrid& grid, uint32_t meshIndexCount,
+                     std::vector<PvsCluster> clusters, const std::vector<std::vector<uint8_t>>& cells)
+{
+    mGrid = grid;
+    mMeshIndexCount = meshIndexCount;
+    mClusters = std::move(clusters);
+
+    mCellOffsets.resize(cells.size() + 1);
+    mBlob.clear();
+    for (size_t i = 0; i < cells.size(); ++i)
+    {
+        mCellOffsets[i] = (uint32_t)mBlob.size();
+        mBlob.insert(mBlob.end(), cells[i].begin(), cells[i].end());
+    }
+    mCellOffsets[cells.size()] = (uint32_t)mBlob.size();
+
+    mCachedCell = -1;
+}
+
+void PvsData::Compress(const uint64_t* bits, uint32_t wordCount, std::vector<uint8_t>& out)
+{
+    // Token < 0x80: (token + 1) literal bytes follow.
+    // Token >= 0x80: bit 6 is the fill value, low 6 bits are run length - 1.
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(bits);
+    const size_t size = (size_t)wordCount * 8;
+
+    out.clear();
+    size_t i = 0;
+    while (i < size)
+    {
+        uint8_t b = bytes[i];
+        if (b == 0x00 || b == 0xFF)
+        {
+            size_t run = 1;
+            while (i + run < size && bytes[i + run] == b && run < 64)
+                ++run;
+            out.push_back((uint8_t)(0x80 | (b ? 0x40 : 0x00) | (run - 1)));
+            i += run;
+            continue;
+        }
+
+        size_t start = i;
+        while (i < size && bytes[i] != 0x00 && bytes[i] != 0xFF && i - start < 128)
+            ++i;
+        out.push_back((uint8_t)(i - start - 1));
+        out.insert(out.end(), bytes + start, bytes + i);
+    }
+}
+
+void PvsData::Decompress(const uint8_t* data, size_t size, uint64_t* bits, uint32_t wordCount)
+{
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(bits);
+    const size_t capacity = (size_t)wordCount * 8;
+
+    size_t o = 0;
+    size_t i = 0;
+    while (i < size && o < capacity)
+    {
+        uint8_t token = data[i++];
+        if (token & 0x80)
+        {
+            size_t run = (size_t)(token & 0x3F) + 1;
+            uint8_t fill = (token & 0x40) ? 0xFF : 0x00;
+            for (size_t k = 0; k < run && o < capacity; ++k)
+                bytes[o++] = fill;
+        }
+        else
+        {
+            size_t n = (size_t)token + 1;
+            for (size_t k = 0; k < n && i < size && o < capacity; ++k)
+                bytes[o++] = data[i++];
+        }
+    }
+
+    while (o < capacity)
+        bytes[o++] = 0;
+}
+
+const uint64_t* PvsData::Lookup(const Vec3& p)
+{
+    if (mClusters.empty())
+        return nullptr;
+
+    float inv = 1.0f / mGrid.CellSize;
+    float fx = std::floor((p.x - mGrid.Origin.x) * inv);
+    float fy = std::floor((p.y - mGrid.Origin.y) * inv);
+    float fz = std::floor((p.z - mGrid.Origin.z) * inv);
+
+    if (fx < 0.0f || fy < 0.0f || fz < 0.0f ||
+        fx >= (float)mGrid.Dims[0] || fy >= (float)mGrid.Dims[1] || fz >= (float)mGrid.Dims[2])
+        return nullptr;
+
+    int64_t cell = ((int64_t)fz * mGrid.Dims[1] + (int64_t)fy) * mGrid.Dims[0] + (int64_t)fx;
+    if (cell != mCachedCell)
+    {
+        uint32_t words = ((uint32_t)mClusters.size() + 63) / 64;
+        mCachedBits.resize(words);
+
+        uint32_t begin = mCellOffsets[(size_t)cell];
+        uint32_t end = mCellOffsets[(size_t)cell + 1];
+        Decompress(mBlob.data() + begin, end - begin, mCachedBits.data(), words);
+        mCachedCell = cell;
+    }
+
+    return mCachedBits.data();
+}
+
+template <typename T>
+static void WritePod(std::ostream& out, const T& v)
+{
+    out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template <typename T>
+static bool ReadPod(std::istream& in, T& v)
+{
+    in.read(reinterpret_cast<char*>(&v), sizeof(T));
+    return (bool)in;
+}
+
+void PvsData::Write(std::ostream& out) const
+{
+    WritePod(out, PvsMagic);
+    WritePod(out, mGrid);
+    WritePod(out, mMeshIndexCount);
+
+    WritePod(out, (uint32_t)mClusters.size());
+    out.write(reinterpret_cast<const char*>(mClusters.data()), mClusters.size() * sizeof(PvsCluster));
+
+    out.write(reinterpret_cast<const char*>(mCellOffsets.data()), mCellOffsets.size() * sizeof(uint32_t));
+
+    WritePod(out, (uint32_t)mBlob.size());
+    out.write(reinterpret_cast<const char*>(mBlob.data()), mBlob.size());
+}
+
+bool PvsData::Read(std::istream& in)
+{
+    // Whatever fails validation leaves the data empty, which Lookup treats
+    // as no PVS at all.
+    *this = PvsData();
+
+    uint32_t magic = 0;
+    if (!ReadPod(in, magic) || magic != PvsMagic)
+        return false;
+
+    PvsGrid grid;
+    uint32_t meshIndexCount = 0;
+    uint32_t clusterCount = 0;
+    if (!ReadPod(in, grid) || !ReadPod(in, meshIndexCount) || !ReadPod(in, clusterCount))
+        return false;
+
+    // Bound the sizes before allocating for them. A cluster holds at least
+    // one index, and the grid has to be one Lookup can address.
+    const uint64_t cellCount = (uint64_t)grid.Dims[0] * grid.Dims[1] * grid.Dims[2];
+    if (!(grid.CellSize > 0.0f) || !std::isfinite(grid.CellSize) || !std::isfinite(grid.Origin.x) ||
+        !std::isfinite(grid.Origin.y) || !std::isfinite(grid.Origin.z) ||
+        cellCount == 0 || cellCount > MaxPvsCells || clusterCount > meshIndexCount || clusterCount > MaxPvsClusters)
+        return false;
+
+    std::vector<PvsCluster> clusters(clusterCount);
+    if (!in.read(reinterpret_cast<char*>(clusters.data()), clusterCount * sizeof(PvsCluster)))
+        return false;
+    for (const PvsCluster& c : clusters)
+    {
+        if (c.IndexCount == 0 || (uint64_t)c.FirstIndex + c.IndexCount > meshIndexCount)
+            return false;
+    }
+
+    std::vector<uint32_t> offsets((size_t)cellCount + 1);
+    uint32_t blobSize = 0;
+    if (!in.read(reinterpret_cast<char*>(offsets.data()), offsets.size() * sizeof(uint32_t)) || !ReadPod(in, blobSize))
+        return false;
+
+    // Every cell's range must lie in the blob, or Lookup decodes past it.
+    // No cell compresses to more than twice its bitset plus a token.
+    const uint64_t maxCellBytes = ((uint64_t)clusterCount + 63) / 64 * 16 + 1;
+    if (offsets[0] != 0 || offsets.back() != blobSize || blobSize > cellCount * maxCellBytes)
+        return false;
+    for (size_t i = 0; i + 1 < offsets.size(); ++i)
+    {
+        if (offsets[i] > offsets[i + 1])
+            return false;
+    }
+
+    std::vector<uint8_t> blob(blobSize);
+    if (!in.read(reinterpret_cast<char*>(blob.data()), blobSize))
+        return false;
+
+    mGrid = grid;
+    mMeshIndexCount = meshIndexCount;
+    mClusters = std::move(clusters);
+    mCellOffsets = std::move(offsets);
+    mBlob = std::move(blob);
+    return true;
+}
@@ -0,0 +1,61 @@
+// PvsData.h
+#pragma once
+#include "SceneMath.h"
+#include <iosfwd>
+#include <vector>
+
+// Contiguous index range of the source mesh that is culled as one unit.
+struct PvsCluster
+{
+    uint32_t FirstIndex;
+    uint32_t IndexCount;
+    Aabb     Bounds;
+};
+
+struct PvsGrid
+{
+    Vec3     Origin;
+    float    CellSize;
+    uint32_t Dims[3];
+
+    uint32_t CellCount() const { return Dims[0] * Dims[1] * Dims[2]; }
+    Aabb     CellBounds(uint32_t cell) const;
+};
+
+// Precomputed visibility: one compressed cluster bitset per grid cell.
+// Positions are in the mesh's local space.
+class PvsData
+{
+public:
+    void Assign(const PvsGrid& grid, uint32_t meshIndexCount,
+                std::vector<PvsCluster> clusters, const std::vector<std::vector<uint8_t>>& cells);
+
+    bool Read(std::istream& in);
+    void Write(std::ostream& out) const;
+
+    bool Empty() const { return mClusters.empty(); }
+
+    // Bitset of clusters visible from the cell containing p, or nullptr if p
+    // is outside the grid. Decoding happens only when the cell changes.
+    const uint64_t* Lookup(const Vec3& p);
+
+    const PvsGrid&                 Grid() const { return mGrid; }
+    const std::vector<PvsCluster>& Clusters() const { return mClusters; }
+    uint32_t MeshIndexCount() const { return mMeshIndexCount; }
+    size_t   CompressedBytes() const { return mBlob.size(); }
+
+    // Run-length coding of bitset bytes: runs of 0x00/0xFF become one token.
+    static void Compress(const uint64_t* bits, uint32_t wordCount, std::vector<uint8_t>& out);
+    static void Decompress(const uint8_t* data, size_t size, uint64_t* bits, uint32_t wordCount);
+
+private:
+    PvsGrid  mGrid = {};
+    uint32_t mMeshIndexCount = 0;
+
+    std::vector<PvsCluster> mClusters;
+    std::vector<uint32_t>   mCellOffsets; // CellCount() + 1 entries into mBlob
+    std::vector<uint8_t>    mBlob;
+
+    int64_t               mCachedCell = -1;
+    std::vector<uint64_t> mCachedBits;
+};
@@ -0,0 +1,100 @@
+// RawMouseInput.cpp
+#include "RawMouseInput.h"
+#include "Timer.h"
+
+RawMouseInput::RawMouseInput()
+{
+    // Shared so the thread may still be inside set_value when this returns.
+    auto started = std::make_shared<std::promise<bool>>();
+    std::future<bool> result = started->get_future();
+    mThread = std::thread([this, started]() { ThreadMain(started.get()); });
+
+    mActive = result.get();
+    mThreadId = GetThreadId(mThread.native_handle());
+    if (!mActive)
+        mThread.join();
+}
+
+RawMouseInput::~RawMouseInput()
+{
+    if (mActive)
+    {
+        PostThreadMessageW(mThreadId, WM_QUIT, 0, 0);
+        mThread.join();
+    }
+}
+
+void RawMouseInput::ThreadMain(std::promise<bool>* started)
+{
+    // Above the render and job threads, so reports are read as they come.
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+
+    HINSTANCE instance = GetModuleHandleW(nullptr);
+    WNDCLASSW wc = {};
+    wc.lpfnWndProc = DefWindowProcW;
+    wc.hInstance = instance;
+    wc.lpszClassName = L"RawMouseInputWindow";
+    RegisterClassW(&wc);
+
+    HWND hwnd = CreateWindowExW(0, wc.lpszClassName, L"", 0, 0, 0, 0, 0, HWND_MESSAGE, nullptr, instance, nullptr);
+
+    // Message-only windows are never in the foreground, hence INPUTSINK.
+    RAWINPUTDEVICE device = {};
+    device.usUsagePage = 0x01;   // generic desktop
+    device.usUsage = 0x02;       // mouse
+    device.dwFlags = RIDEV_INPUTSINK;
+    device.hwndTarget = hwnd;
+
+    if (!hwnd || !RegisterRawInputDevices(&device, 1, sizeof(device)))
+    {
+        if (hwnd)
+            DestroyWindow(hwnd);
+        started->set_value(false);
+        return;
+    }
+
+    // Creating the window gave this thread its message queue, so the
+    // WM_QUIT from the destructor cannot be lost.
+    started->set_value(true);
+
+    MSG msg = {};
+    while (GetMessageW(&msg, nullptr, 0, 0) > 0)
+    {
+        if (msg.message == WM_INPUT)
+            OnInput((HRAWINPUT)msg.lParam);
+        DispatchMessageW(&msg);   // DefWindowProc releases the WM_INPUT data
+    }
+
+    device.dwFlags = RIDEV_REMOVE;
+    device.hwndTarget = nullptr;
+    RegisterRawInputDevices(&device, 1, sizeof(device));
+    DestroyWindow(hwnd);
+}
+
+void RawMouseInput::OnInput(HRAWINPUT handle)
+{
+    const int64_t time = GameTimer::Counter();
+
+    RAWINPUT raw;
+    UINT size = sizeof(raw);
+    if (GetRawInputData(handle, RID_INPUT, &raw, &size, sizeof(RAWINPUTHEADER)) == (UINT)-1)
+        return;
+    if (raw.header.dwType != RIM_TYPEMOUSE || (raw.data.mouse.usFlags & MOUSE_MOVE_ABSOLUTE))
+        return;
+    if (raw.data.mouse.lLastX == 0 && raw.data.mouse.lLastY == 0)
+        return;   // button or wheel only; those still come through window messages
+
+    if (!mQueue.TryPush({ raw.data.mouse.lLastX, raw.data.mouse.lLastY, time }))
+        mDropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RawMouseInput::Drain(int64_t until, InputDevice& input)
+{
+    while (const RawMouseSample* sample = mQueue.Front())
+    {
+        if (sample->Time > until)
+            break;
+        input.OnRawMouse(sample->Dx, sample->Dy, sample->Time);
+        mQueue.Pop();
+    }
+}
@@ -0,0 +1,53 @@
+// RawMouseInput.h
+#pragma once
+#include <Windows.h>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <thread>
+#include "InputDevice.h"
+#include "SpscQueue.h"
+
+struct RawMouseSample
+{
+    int32_t Dx;
+    int32_t Dy;
+    int64_t Time;   // GameTimer::Counter()
+};
+
+// Relative mouse motion from WM_INPUT, read on a thread of its own so that
+// neither the message pump nor a long frame delays or coalesces it. The
+// thread owns a message-only window registered for raw mouse input and
+// queues each report; the main thread drains the queue into an InputDevice.
+class RawMouseInput
+{
+public:
+    RawMouseInput();
+    ~RawMouseInput();
+
+    RawMouseInput(const RawMouseInput&) = delete;
+    RawMouseInput& operator=(const RawMouseInput&) = delete;
+
+    // False when raw input could not be registered; callers keep using
+    // cursor deltas then.
+    bool Active() const { return mActive; }
+
+    // Main thread: hands samples stamped at or before until to input.
+    // Later samples stay queued for the next call.
+    void Drain(int64_t until, InputDevice& input);
+
+    uint64_t Dropped() const { return mDropped.load(std::memory_order_relaxed); }
+
+private:
+    static const uint32_t QueueCapacity = 8192;   // about a second at 8 kHz
+
+    void ThreadMain(std::promise<bool>* started);
+    void OnInput(HRAWINPUT handle);
+
+    std::thread mThread;
+    DWORD mThreadId = 0;
+    bool  mActive = false;
+
+    SpscQueue<RawMouseSample> mQueue{ QueueCapacity };
+    std::atomic<uint64_t> mDropped{ 0 };
+};
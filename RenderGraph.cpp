@@ -0,0 +1,350 @@
+// RenderGraph.cpp
+#include "RenderGraph.h"
+#include <algorithm>
+#include <stdexcept>
+
+static const uint32_t NoPass = UINT32_MAX;
+
+static uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+    return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+}
+
+void RenderGraph::PassBuilder::Read(GraphResource resource, uint32_t access)
+{
+    mGraph.mPasses[mPass].Uses.push_back({ resource, access, false });
+}
+
+void RenderGraph::PassBuilder::Write(GraphResource resource, uint32_t access)
+{
+    mGraph.mPasses[mPass].Uses.push_back({ resource, access, true });
+}
+
+void RenderGraph::PassBuilder::SideEffect()
+{
+    mGraph.mPasses[mPass].SideEffect = true;
+}
+
+GraphResource RenderGraph::CreateTexture(const std::string& name, const GraphTextureDesc& desc)
+{
+    Resource r;
+    r.Name = name;
+    r.Desc = desc;
+    mResources.push_back(r);
+    return (GraphResource)mResources.size() - 1;
+}
+
+GraphResource RenderGraph::ImportTexture(const std::string& name, uint32_t initialAccess, uint32_t finalAccess)
+{
+    Resource r;
+    r.Name = name;
+    r.Imported = true;
+    r.InitialAccess = initialAccess;
+    r.FinalAccess = finalAccess;
+    mResources.push_back(r);
+    return (GraphResource)mResources.size() - 1;
+}
+
+uint32_t RenderGraph::AddPass(const std::string& name, const std::function<void(PassBuilder&)>& setup,
+    std::function<void()> execute)
+{
+    mPasses.emplace_back();
+    mPasses.back().Name = name;
+    mPasses.back().Execute = std::move(execute);
+
+    uint32_t index = (uint32_t)mPasses.size() - 1;
+    PassBuilder builder(*this, index);
+    setup(builder);
+    return index;
+}
+
+void RenderGraph::Compile(IRenderGraphBackend& backend)
+{
+    mStats = RenderGraphStats();
+    mFinalBarriers.clear();
+    for (Pass& p : mPasses)
+        p.Barriers.clear();
+
+    CullPasses();
+
+    std::vector<uint32_t> kept;
+    for (uint32_t i = 0; i < (uint32_t)mPasses.size(); ++i)
+    {
+        if (!mPasses[i].Culled)
+            kept.push_back(i);
+    }
+
+    ComputeLifetimes(kept);
+    PlaceTransients(backend);
+    BuildBarriers(kept);
+
+    mStats.Passes = (uint32_t)kept.size();
+    mStats.CulledPasses = (uint32_t)(mPasses.size() - kept.size());
+    for (uint32_t k : kept)
+    {
+        if (!mPasses[k].Barriers.empty())
+            mStats.BarrierBatches++;
+    }
+    if (!mFinalBarriers.empty())
+        mStats.BarrierBatches++;
+}
+
+void RenderGraph::CullPasses()
+{
+    // Walking backwards, a write satisfies the pending reads of a resource
+    // and a kept pass's reads make earlier writers necessary.
+    std::vector<bool> needed(mResources.size(), false);
+
+    for (size_t i = mPasses.size(); i-- > 0;)
+    {
+        Pass& pass = mPasses[i];
+
+        bool keep = pass.SideEffect;
+        for (const Use& u : pass.Uses)
+        {
+            if (u.Write && (mResources[u.Resource].Imported || needed[u.Resource]))
+                keep = true;
+        }
+
+        pass.Culled = !keep;
+        if (!keep)
+            continue;
+
+        for (const Use& u : pass.Uses)
+        {
+            if (u.Write) needed[u.Resource] = false;
+        }
+        for (const Use& u : pass.Uses)
+        {
+            if (!u.Write) needed[u.Resource] = true;
+        }
+    }
+}
+
+void RenderGraph::ComputeLifetimes(const std::vector<uint32_t>& kept)
+{
+    for (Resource& r : mResources)
+    {
+        r.Usage = r.InitialAccess | r.FinalAccess;
+        r.FirstAccess = Access_None;
+        r.LastAccess = Access_None;
+        r.FirstPass = NoPass;
+        r.LastPass = 0;
+        r.Offset = 0;
+        r.Size = 0;
+    }
+
+    for (uint32_t k = 0; k < (uint32_t)kept.size(); ++k)
+    {
+        const Pass& pass = mPasses[kept[k]];
+
+        // A transient's first pass must write it; any read there would see garbage.
+        for (const Use& u : pass.Uses)
+        {
+            Resource& r = mResources[u.Resource];
+            if (!r.Imported && r.FirstPass == NoPass && !u.Write)
+            {
+                bool written = false;
+                for (const Use& w : pass.Uses)
+                    written |= w.Resource == u.Resource && w.Write;
+                if (!written)
+                    throw std::logic_error("Render graph: '" + r.Name + "' read before written by '" + pass.Name + "'");
+            }
+        }
+
+        for (const Use& u : pass.Uses)
+        {
+            Resource& r = mResources[u.Resource];
+            r.Usage |= u.Access;
+            if (r.FirstPass == NoPass || r.FirstPass == k)
+            {
+                r.FirstAccess |= u.Access;
+                r.FirstPass = k;
+            }
+            r.LastAccess = r.LastPass == k ? r.LastAccess | u.Access : u.Access;
+            r.LastPass = k;
+        }
+    }
+}
+
+void RenderGraph::PlaceTransients(IRenderGraphBackend& backend)
+{
+    std::vector<GraphResource> transients;
+    std::vector<uint64_t> alignments(mResources.size(), 1);
+
+    for (GraphResource id = 0; id < (GraphResource)mResources.size(); ++id)
+    {
+        Resource& r = mResources[id];
+        if (r.Imported || r.FirstPass == NoPass)
+            continue;
+
+        GraphMemory memory = backend.GetTextureMemory(r.Desc, r.Usage);
+        r.Size = memory.Size;
+        alignments[id] = memory.Alignment;
+        mStats.UnaliasedBytes += memory.Size;
+        transients.push_back(id);
+    }
+
+    // Largest first, each at the lowest offset that does not collide with a
+    // placed texture whose lifetime overlaps.
+    std::sort(transients.begin(), transients.end(), [&](GraphResource a, GraphResource b)
+        {
+            if (mResources[a].Size != mResources[b].Size) return mResources[a].Size > mResources[b].Size;
+            return a < b;
+        });
+
+    std::vector<GraphResource> placed;
+    std::vector<GraphResource> live;
+    uint64_t heapSize = 0;
+
+    for (GraphResource id : transients)
+    {
+        Resource& r = mResources[id];
+
+        live.clear();
+        for (GraphResource p : placed)
+        {
+            const Resource& o = mResources[p];
+            if (o.FirstPass <= r.LastPass && r.FirstPass <= o.LastPass)
+                live.push_back(p);
+        }
+        std::sort(live.begin(), live.end(), [&](GraphResource a, GraphResource b)
+            {
+                return mResources[a].Offset < mResources[b].Offset;
+            });
+
+        uint64_t offset = 0;
+        for (GraphResource p : live)
+        {
+            const Resource& o = mResources[p];
+            if (AlignUp(offset, alignments[id]) + r.Size <= o.Offset)
+                break;
+            offset = (std::max)(offset, o.Offset + o.Size);
+        }
+
+        r.Offset = AlignUp(offset, alignments[id]);
+        heapSize = (std::max)(heapSize, r.Offset + r.Size);
+        placed.push_back(id);
+    }
+
+    mStats.TransientBytes = heapSize;
+    if (heapSize == 0)
+        return;
+
+    backend.CreateTransientHeap(heapSize);
+    for (GraphResource id : placed)
+    {
+        const Resource& r = mResources[id];
+        backend.PlaceTexture(id, r.Desc, r.Usage, r.Offset, r.LastAccess);
+    }
+}
+
+void RenderGraph::BuildBarriers(const std::vector<uint32_t>& kept)
+{
+    const uint32_t resourceCount = (uint32_t)mResources.size();
+    std::vector<uint32_t> state(resourceCount);
+    std::vector<uint32_t> lastUse(resourceCount, NoPass);
+
+    // Transients enter the frame as the previous frame left them.
+    for (uint32_t i = 0; i < resourceCount; ++i)
+        state[i] = mResources[i].Imported ? mResources[i].InitialAccess : mResources[i].LastAccess;
+
+    // Begins right after the previous use when passes sit in between. A
+    // transient's first transition cannot start early: until its aliasing
+    // barrier the memory belongs to someone else.
+    auto transition = [&](GraphResource id, uint32_t after, uint32_t k, std::vector<GraphBarrier>& at)
+        {
+            bool canSplit = mResources[id].Imported || lastUse[id] != NoPass;
+            uint32_t begin = lastUse[id] == NoPass ? 0 : lastUse[id] + 1;
+            GraphBarrier b = { GraphBarrier::Transition, BarrierSplit::None, id, InvalidGraphResource, state[id], after };
+
+            if (canSplit && begin < k)
+            {
+                b.Split = BarrierSplit::Begin;
+                mPasses[kept[begin]].Barriers.push_back(b);
+                b.Split = BarrierSplit::End;
+                mStats.SplitBarriers++;
+            }
+            at.push_back(b);
+            mStats.Barriers++;
+            state[id] = after;
+        };
+
+    std::vector<std::pair<GraphResource, uint32_t>> required;
+    for (uint32_t k = 0; k < (uint32_t)kept.size(); ++k)
+    {
+        Pass& pass = mPasses[kept[k]];
+
+        required.clear();
+        for (const Use& u : pass.Uses)
+        {
+            auto it = std::find_if(required.begin(), required.end(),
+                [&](const std::pair<GraphResource, uint32_t>& r) { return r.first == u.Resource; });
+            if (it != required.end())
+                it->second |= u.Access;
+            else
+                required.push_back({ u.Resource, u.Access });
+        }
+
+        // Memory that held another transient needs an aliasing barrier before
+        // its new owner's first use. The owner before it in this frame is
+        // named; otherwise it was a texture from the end of the last frame.
+        for (const auto& req : required)
+        {
+            const Resource& r = mResources[req.first];
+            if (r.Imported || r.FirstPass != k)
+                continue;
+
+            bool overlaps = false;
+            GraphResource before = InvalidGraphResource;
+            for (GraphResource o = 0; o < resourceCount; ++o)
+            {
+                const Resource& other = mResources[o];
+                if (o == req.first || other.Imported || other.FirstPass == NoPass ||
+                    other.Offset >= r.Offset + r.Size || r.Offset >= other.Offset + other.Size)
+                    continue;
+
+                overlaps = true;
+                if (other.LastPass < k && (before == InvalidGraphResource || other.LastPass > mResources[before].LastPass))
+                    before = o;
+            }
+
+            if (overlaps)
+            {
+                pass.Barriers.push_back({ GraphBarrier::Aliasing, BarrierSplit::None, req.first, before, 0, 0 });
+                mStats.Barriers++;
+                mStats.AliasingBarriers++;
+            }
+        }
+
+        for (const auto& req : required)
+        {
+            if (state[req.first] != req.second)
+                transition(req.first, req.second, k, pass.Barriers);
+            lastUse[req.first] = k;
+        }
+    }
+
+    for (GraphResource id = 0; id < resourceCount; ++id)
+    {
+        if (mResources[id].Imported && state[id] != mResources[id].FinalAccess)
+            transition(id, mResources[id].FinalAccess, (uint32_t)kept.size(), mFinalBarriers);
+    }
+}
+
+void RenderGraph::Execute(IRenderGraphBackend& backend) const
+{
+    for (const Pass& pass : mPasses)
+    {
+        if (pass.Culled)
+            continue;
+
+        if (!pass.Barriers.empty())
+            backend.Barriers(pass.Barriers.data(), (uint32_t)pass.Barriers.size());
+        if (pass.Execute)
+            pass.Execute();
+    }
+
+    if (!mFinalBarriers.empty())
+        backend.Barriers(mFinalBarriers.data(), (uint32_t)mFinalBarriers.size());
+}
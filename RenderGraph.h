@@ -0,0 +1,184 @@
+// RenderGraph.h
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// How a pass uses a resource. Backends map these to API states; read
+// accesses of one pass may be combined.
+enum GraphAccess : uint32_t
+{
+    Access_None            = 0,
+    Access_RenderTarget    = 1 << 0,
+    Access_DepthWrite      = 1 << 1,
+    Access_DepthRead       = 1 << 2,
+    Access_ShaderRead      = 1 << 3,
+    Access_UnorderedAccess = 1 << 4,
+    Access_CopySource      = 1 << 5,
+    Access_CopyDest        = 1 << 6,
+    Access_Present         = 1 << 7,
+};
+
+using GraphResource = uint32_t;
+const GraphResource InvalidGraphResource = 0xFFFFFFFFu;
+
+struct GraphTextureDesc
+{
+    uint32_t Width;
+    uint32_t Height;
+    uint32_t Format;   // backend-defined, DXGI_FORMAT for D3D12
+};
+
+struct GraphMemory
+{
+    uint64_t Size;
+    uint64_t Alignment;
+};
+
+enum class BarrierSplit : uint8_t
+{
+    None,
+    Begin,
+    End,
+};
+
+struct GraphBarrier
+{
+    enum Kind : uint8_t { Transition, Aliasing };
+
+    Kind          Type;
+    BarrierSplit  Split;
+    GraphResource Resource;
+    GraphResource AliasBefore; // aliasing: last user of the memory, or InvalidGraphResource
+    uint32_t      Before;      // transition accesses
+    uint32_t      After;
+};
+
+// What the graph needs from an API. Compile asks for memory sizes and
+// places transients; Execute hands over one barrier batch per call.
+class IRenderGraphBackend
+{
+public:
+    virtual ~IRenderGraphBackend() = default;
+
+    // usage is every access the texture sees in the graph.
+    virtual GraphMemory GetTextureMemory(const GraphTextureDesc& desc, uint32_t usage) = 0;
+
+    virtual void CreateTransientHeap(uint64_t size) = 0;
+    virtual void PlaceTexture(GraphResource id, const GraphTextureDesc& desc, uint32_t usage,
+                              uint64_t offset, uint32_t initialAccess) = 0;
+
+    virtual void Barriers(const GraphBarrier* barriers, uint32_t count) = 0;
+};
+
+struct RenderGraphStats
+{
+    uint32_t Passes = 0;
+    uint32_t CulledPasses = 0;
+    uint32_t Barriers = 0;
+    uint32_t BarrierBatches = 0;   // ResourceBarrier calls per execution
+    uint32_t SplitBarriers = 0;    // begin/end pairs
+    uint32_t AliasingBarriers = 0;
+    uint64_t TransientBytes = 0;   // heap size after aliasing
+    uint64_t UnaliasedBytes = 0;   // sum of transient sizes
+};
+
+// Passes declare their reads and writes; Compile works out which passes
+// are needed, the barriers between them and where transient textures live.
+//
+// - A pass is kept if it has a side effect, writes an imported resource or
+//   writes something a kept pass later reads.
+// - A resource changes state as late as possible: when passes that do not
+//   touch it sit between its last use and the next, the transition is split
+//   and begins right after the last use. Barriers due at the same point go
+//   out in one batch.
+// - Transients that are never alive at the same time share heap memory.
+//   Their first pass must fully overwrite them (clear, discard or copy).
+//   A transient is created in the state of its last use and moved to its
+//   first-use state right after its aliasing barrier, and imports are
+//   returned to their final state, so the compiled graph can execute
+//   every frame.
+class RenderGraph
+{
+public:
+    class PassBuilder
+    {
+    public:
+        void Read(GraphResource resource, uint32_t access);
+        void Write(GraphResource resource, uint32_t access);
+
+        // Keeps the pass even if nothing reads what it writes.
+        void SideEffect();
+
+    private:
+        friend class RenderGraph;
+        PassBuilder(RenderGraph& graph, uint32_t pass) : mGraph(graph), mPass(pass) {}
+
+        RenderGraph& mGraph;
+        uint32_t     mPass;
+    };
+
+    GraphResource CreateTexture(const std::string& name, const GraphTextureDesc& desc);
+    GraphResource ImportTexture(const std::string& name, uint32_t initialAccess, uint32_t finalAccess);
+
+    uint32_t AddPass(const std::string& name, const std::function<void(PassBuilder&)>& setup,
+                     std::function<void()> execute);
+
+    // Throws std::logic_error when a transient is read before any pass writes it.
+    void Compile(IRenderGraphBackend& backend);
+    void Execute(IRenderGraphBackend& backend) const;
+
+    bool IsCulled(uint32_t pass) const { return mPasses[pass].Culled; }
+    const std::vector<GraphBarrier>& BarriersBefore(uint32_t pass) const { return mPasses[pass].Barriers; }
+    const std::vector<GraphBarrier>& FinalBarriers() const { return mFinalBarriers; }
+    uint64_t TransientOffset(GraphResource resource) const { return mResources[resource].Offset; }
+
+    const RenderGraphStats& GetStats() const { return mStats; }
+
+private:
+    struct Use
+    {
+        GraphResource Resource;
+        uint32_t      Access;
+        bool          Write;
+    };
+
+    struct Pass
+    {
+        std::string           Name;
+        std::vector<Use>      Uses;
+        std::function<void()> Execute;
+        bool                  SideEffect = false;
+        bool                  Culled = false;
+        std::vector<GraphBarrier> Barriers; // issued before the pass runs
+    };
+
+    struct Resource
+    {
+        std::string      Name;
+        GraphTextureDesc Desc = {};
+        bool             Imported = false;
+        uint32_t         InitialAccess = Access_None;
+        uint32_t         FinalAccess = Access_None;
+
+        // Filled by Compile, over kept passes only
+        uint32_t Usage = 0;
+        uint32_t FirstAccess = Access_None;
+        uint32_t LastAccess = Access_None;
+        uint32_t FirstPass = UINT32_MAX;   // positions in the kept pass list
+        uint32_t LastPass = 0;
+        uint64_t Offset = 0;
+        uint64_t Size = 0;
+    };
+
+    void CullPasses();
+    void ComputeLifetimes(const std::vector<uint32_t>& kept);
+    void PlaceTransients(IRenderGraphBackend& backend);
+    void BuildBarriers(const std::vector<uint32_t>& kept);
+
+    std::vector<Pass>     mPasses;
+    std::vector<Resource> mResources;
+    std::vector<GraphBarrier> mFinalBarriers;
+    RenderGraphStats      mStats;
+};
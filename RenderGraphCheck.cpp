@@ -0,0 +1,209 @@
+// RenderGraphCheck.cpp
+// Checks for RenderGraph against a recording backend: RenderGraphCheck
+// Builds a small deferred frame with one dead pass and checks culling,
+// transient placement (no two live transients share memory, dead ones do),
+// aliasing barriers naming the previous owner, the split transition of the
+// imported back buffer, and what Execute hands to the backend.
+// Standard library only; on Linux:
+//   g++ -O2 -std=c++17 RenderGraphCheck.cpp RenderGraph.cpp -o RenderGraphCheck
+#include "RenderGraph.h"
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    int gFailures = 0;
+
+    void Check(bool ok, const char* what, long long a = 0, long long b = 0)
+    {
+        if (!ok && gFailures++ < 10)
+            printf("FAIL: %s (%lld, %lld)\n", what, a, b);
+    }
+
+    // Four bytes a texel, 64 KB placement alignment; records every call.
+    class RecordingBackend : public IRenderGraphBackend
+    {
+    public:
+        GraphMemory GetTextureMemory(const GraphTextureDesc& desc, uint32_t) override
+        {
+            return { (uint64_t)desc.Width * desc.Height * 4, 64 << 10 };
+        }
+
+        void CreateTransientHeap(uint64_t size) override { HeapSize = size; }
+
+        void PlaceTexture(GraphResource id, const GraphTextureDesc&, uint32_t, uint64_t offset, uint32_t initialAccess) override
+        {
+            Placed.push_back({ id, offset, initialAccess });
+        }
+
+        void Barriers(const GraphBarrier* barriers, uint32_t count) override
+        {
+            Batches.emplace_back(barriers, barriers + count);
+        }
+
+        struct Placement { GraphResource Id; uint64_t Offset; uint32_t InitialAccess; };
+
+        uint64_t HeapSize = 0;
+        std::vector<Placement> Placed;
+        std::vector<std::vector<GraphBarrier>> Batches;
+    };
+
+    const GraphBarrier* FindBarrier(const std::vector<GraphBarrier>& list, GraphBarrier::Kind kind,
+                                    GraphResource resource, BarrierSplit split = BarrierSplit::None)
+    {
+        for (const GraphBarrier& b : list)
+        {
+            if (b.Type == kind && b.Resource == resource && (kind == GraphBarrier::Aliasing || b.Split == split))
+                return &b;
+        }
+        return nullptr;
+    }
+
+    void DeferredFrame()
+    {
+        RenderGraph graph;
+        const GraphTextureDesc desc = { 256, 256, 0 };
+        const uint64_t size = 256 * 256 * 4;
+
+        GraphResource backBuffer = graph.ImportTexture("BackBuffer", Access_Present, Access_Present);
+        GraphResource albedo = graph.CreateTexture("Albedo", desc);
+        GraphResource depth = graph.CreateTexture("Depth", desc);
+        GraphResource lit = graph.CreateTexture("Lit", desc);
+        GraphResource bloom = graph.CreateTexture("Bloom", desc);
+        GraphResource unused = graph.CreateTexture("Unused", desc);
+
+        std::vector<std::string> ran;
+        auto record = [&ran](const char* name) { return [&ran, name]() { ran.push_back(name); }; };
+
+        uint32_t dead = graph.AddPass("Dead", [&](RenderGraph::PassBuilder& b)
+            {
+                b.Write(unused, Access_RenderTarget);
+            }, record("Dead"));
+        uint32_t gbuffer = graph.AddPass("GBuffer", [&](RenderGraph::PassBuilder& b)
+            {
+                b.Write(albedo, Access_RenderTarget);
+                b.Write(depth, Access_DepthWrite);
+            }, record("GBuffer"));
+        uint32_t lighting = graph.AddPass("Lighting", [&](RenderGraph::PassBuilder& b)
+            {
+                b.Read(albedo, Access_ShaderRead);
+                b.Read(depth, Access_DepthRead);
+                b.Write(lit, Access_RenderTarget);
+            }, record("Lighting"));
+        uint32_t blur = graph.AddPass("Bloom", [&](RenderGraph::PassBuilder& b)
+            {
+                b.Read(lit, Access_ShaderRead);
+                b.Write(bloom, Access_RenderTarget);
+            }, record("Bloom"));
+        uint32_t post = graph.AddPass("Post", [&](RenderGraph::PassBuilder& b)
+            {
+                b.Read(bloom, Access_ShaderRead);
+                b.Write(backBuffer, Access_RenderTarget);
+            }, record("Post"));
+
+        RecordingBackend backend;
+        graph.Compile(backend);
+
+        // Culling: only the pass whose output nobody reads goes.
+        Check(graph.IsCulled(dead), "dead pass culled");
+        Check(!graph.IsCulled(gbuffer) && !graph.IsCulled(lighting) && !graph.IsCulled(blur) && !graph.IsCulled(post), "live passes kept");
+        Check(graph.GetStats().Passes == 4 && graph.GetStats().CulledPasses == 1, "pass stats",
+              graph.GetStats().Passes, graph.GetStats().CulledPasses);
+
+        // Placement: four transients of one size. Albedo and Depth live over
+        // GBuffer..Lighting, Lit over Lighting..Bloom, Bloom over Bloom..Post,
+        // so Bloom can take the memory of the G-buffer and three slots do.
+        Check(backend.Placed.size() == 4, "culled transient not placed", backend.Placed.size());
+        Check(graph.GetStats().UnaliasedBytes == 4 * size, "unaliased bytes", graph.GetStats().UnaliasedBytes);
+        Check(backend.HeapSize == 3 * size && graph.GetStats().TransientBytes == 3 * size, "aliased heap",
+              backend.HeapSize, 3 * size);
+
+        const GraphResource transients[] = { albedo, depth, lit, bloom };
+        const uint32_t first[] = { 0, 0, 1, 2 };
+        const uint32_t last[] = { 1, 1, 2, 3 };
+        for (int i = 0; i < 4; ++i)
+        {
+            const uint64_t a = graph.TransientOffset(transients[i]);
+            Check(a % (64 << 10) == 0, "placement alignment", a);
+            for (int j = i + 1; j < 4; ++j)
+            {
+                const uint64_t b = graph.TransientOffset(transients[j]);
+                const bool liveTogether = first[i] <= last[j] && first[j] <= last[i];
+                const bool shareMemory = a < b + size && b < a + size;
+                Check(!(liveTogether && shareMemory), "live transients overlap", transients[i], transients[j]);
+            }
+        }
+        Check(graph.TransientOffset(bloom) == graph.TransientOffset(albedo), "bloom reuses the albedo memory",
+              graph.TransientOffset(bloom), graph.TransientOffset(albedo));
+
+        // Bloom's memory held Albedo earlier in the frame, and the aliasing
+        // barrier names it.
+        const std::vector<GraphBarrier>& atBlur = graph.BarriersBefore(blur);
+        const GraphBarrier* alias = FindBarrier(atBlur, GraphBarrier::Aliasing, bloom);
+        Check(alias && alias->AliasBefore == albedo, "aliasing barrier names the previous owner",
+              alias ? alias->AliasBefore : -1, albedo);
+        Check(!FindBarrier(graph.BarriersBefore(lighting), GraphBarrier::Aliasing, lit), "lit shares no memory");
+
+        // Transients are placed in their last state, so the G-buffer writes
+        // start with a transition only where the first use differs.
+        for (const RecordingBackend::Placement& p : backend.Placed)
+        {
+            if (p.Id == albedo)
+                Check(p.InitialAccess == Access_ShaderRead, "placed in last-use state", p.InitialAccess);
+        }
+
+        // The back buffer is idle until Post: its transition to render target
+        // begins with the first kept pass and ends before Post, and it goes
+        // back to present after the frame.
+        const GraphBarrier* begin = FindBarrier(graph.BarriersBefore(gbuffer), GraphBarrier::Transition, backBuffer, BarrierSplit::Begin);
+        const GraphBarrier* end = FindBarrier(graph.BarriersBefore(post), GraphBarrier::Transition, backBuffer, BarrierSplit::End);
+        Check(begin && end, "back buffer transition split across the idle passes");
+        Check(end && end->Before == Access_Present && end->After == Access_RenderTarget, "split transition states");
+        const GraphBarrier* back = FindBarrier(graph.FinalBarriers(), GraphBarrier::Transition, backBuffer);
+        Check(back && back->After == Access_Present, "back buffer returned to present");
+
+        // Execute runs the kept passes in order, one barrier batch at a time.
+        graph.Execute(backend);
+        Check(ran.size() == 4 && ran[0] == "GBuffer" && ran[3] == "Post", "execution order", ran.size());
+        Check(backend.Batches.size() == graph.GetStats().BarrierBatches, "one batch per call",
+              backend.Batches.size(), graph.GetStats().BarrierBatches);
+
+        uint32_t handed = 0;
+        for (const std::vector<GraphBarrier>& batch : backend.Batches)
+            handed += (uint32_t)batch.size();
+        Check(handed == graph.GetStats().Barriers + graph.GetStats().SplitBarriers, "every barrier handed over",
+              handed, graph.GetStats().Barriers);
+
+        // Compiling again gives the same result.
+        RecordingBackend again;
+        graph.Compile(again);
+        Check(again.HeapSize == backend.HeapSize && graph.BarriersBefore(blur).size() == atBlur.size(), "recompile is stable");
+    }
+
+    void ReadBeforeWrite()
+    {
+        RenderGraph graph;
+        GraphResource t = graph.CreateTexture("Garbage", { 64, 64, 0 });
+        graph.AddPass("Reader", [&](RenderGraph::PassBuilder& b)
+            {
+                b.Read(t, Access_ShaderRead);
+                b.SideEffect();
+            }, nullptr);
+
+        RecordingBackend backend;
+        bool threw = false;
+        try { graph.Compile(backend); } catch (const std::logic_error&) { threw = true; }
+        Check(threw, "transient read before any write throws");
+    }
+}
+
+int main()
+{
+    DeferredFrame();
+    ReadBeforeWrite();
+
+    printf("%s\n", gFailures == 0 ? "passed" : "FAILED");
+    return gFailures == 0 ? 0 : 1;
+}
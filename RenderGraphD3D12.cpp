@@ -0,0 +1,158 @@
+// RenderGraphD3D12.cpp
+#include "RenderGraphD3D12.h"
+
+D3D12RenderGraphBackend::D3D12RenderGraphBackend(ID3D12Device* device, ResourceStateRegistry& states)
+    : mDevice(device)
+    , mStates(states)
+    , mTracker(states)
+{
+}
+
+D3D12_RESOURCE_STATES D3D12RenderGraphBackend::ToState(uint32_t access)
+{
+    D3D12_RESOURCE_STATES state = D3D12_RESOURCE_STATE_COMMON;
+    if (access & Access_RenderTarget)    state |= D3D12_RESOURCE_STATE_RENDER_TARGET;
+    if (access & Access_DepthWrite)      state |= D3D12_RESOURCE_STATE_DEPTH_WRITE;
+    if (access & Access_DepthRead)       state |= D3D12_RESOURCE_STATE_DEPTH_READ;
+    if (access & Access_ShaderRead)      state |= D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+    if (access & Access_UnorderedAccess) state |= D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+    if (access & Access_CopySource)      state |= D3D12_RESOURCE_STATE_COPY_SOURCE;
+    if (access & Access_CopyDest)        state |= D3D12_RESOURCE_STATE_COPY_DEST;
+    if (access & Access_Present)         state |= D3D12_RESOURCE_STATE_PRESENT;
+    return state;
+}
+
+void D3D12RenderGraphBackend::Bind(GraphResource id, ID3D12Resource* resource)
+{
+    mResources[id] = resource;
+}
+
+ID3D12Resource* D3D12RenderGraphBackend::GetResource(GraphResource id) const
+{
+    auto it = mResources.find(id);
+    return it != mResources.end() ? it->second.Get() : nullptr;
+}
+
+D3D12_RESOURCE_DESC D3D12RenderGraphBackend::TextureDesc(const GraphTextureDesc& desc, uint32_t usage)
+{
+    D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_NONE;
+    if (usage & Access_RenderTarget)
+        flags |= D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+    if (usage & (Access_DepthWrite | Access_DepthRead))
+    {
+        flags |= D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
+        if (!(usage & Access_ShaderRead))
+            flags |= D3D12_RESOURCE_FLAG_DENY_SHADER_RESOURCE;
+    }
+    if (usage & Access_UnorderedAccess)
+        flags |= D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+
+    return CD3DX12_RESOURCE_DESC::Tex2D((DXGI_FORMAT)desc.Format, desc.Width, desc.Height, 1, 1, 1, 0, flags);
+}
+
+GraphMemory D3D12RenderGraphBackend::GetTextureMemory(const GraphTextureDesc& desc, uint32_t usage)
+{
+    D3D12_RESOURCE_DESC rd = TextureDesc(desc, usage);
+    D3D12_RESOURCE_ALLOCATION_INFO info = mDevice->GetResourceAllocationInfo(0, 1, &rd);
+    return { info.SizeInBytes, info.Alignment };
+}
+
+void D3D12RenderGraphBackend::CreateTransientHeap(uint64_t size)
+{
+    // Placed resources of the old heap go with it; imported ones stay bound.
+    for (GraphResource id : mTransients)
+    {
+        mStates.Unregister(mResources[id].Get());
+        mResources.erase(id);
+    }
+    mTransients.clear();
+    mHeap.Reset();
+
+    // Tier 1 heaps cannot mix categories; transients are render or depth targets.
+    CD3DX12_HEAP_DESC heapDesc(size, D3D12_HEAP_TYPE_DEFAULT, 0, D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES);
+    ThrowIfFailed(mDevice->CreateHeap(&heapDesc, IID_PPV_ARGS(&mHeap)));
+}
+
+void D3D12RenderGraphBackend::PlaceTexture(GraphResource id, const GraphTextureDesc& desc, uint32_t usage,
+    uint64_t offset, uint32_t initialAccess)
+{
+    if (!(usage & (Access_RenderTarget | Access_DepthWrite | Access_DepthRead)))
+        throw std::logic_error("Transient textures must be render or depth targets");
+
+    D3D12_RESOURCE_DESC rd = TextureDesc(desc, usage);
+
+    ComPtr<ID3D12Resource> resource;
+    ThrowIfFailed(mDevice->CreatePlacedResource(mHeap.Get(), offset, &rd, ToState(initialAccess),
+        nullptr, IID_PPV_ARGS(&resource)));
+
+    mStates.Register(resource.Get(), 1, ToState(initialAccess));
+    mResources[id] = resource;
+    mTransients.push_back(id);
+}
+
+void D3D12RenderGraphBackend::AppendTracked(const std::vector<StateBarrier>& tracked)
+{
+    for (const StateBarrier& b : tracked)
+    {
+        mBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition((ID3D12Resource*)b.Resource,
+            (D3D12_RESOURCE_STATES)b.Before, (D3D12_RESOURCE_STATES)b.After, b.Subresource));
+    }
+}
+
+void D3D12RenderGraphBackend::Barriers(const GraphBarrier* barriers, uint32_t count)
+{
+    mBarriers.clear();
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const GraphBarrier& b = barriers[i];
+        ID3D12Resource* resource = GetResource(b.Resource);
+
+        if (b.Type == GraphBarrier::Transition && b.Split == BarrierSplit::None)
+        {
+            mTracker.Transition(resource, ToState(b.After));
+            continue;
+        }
+
+        // Aliasing and split barriers go out as given, after whatever the
+        // tracker has queued so far.
+        mTracked.clear();
+        mTracker.FlushBatch(mTracked);
+        AppendTracked(mTracked);
+
+        if (b.Type == GraphBarrier::Aliasing)
+        {
+            ID3D12Resource* before = b.AliasBefore != InvalidGraphResource ? GetResource(b.AliasBefore) : nullptr;
+            mBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Aliasing(before, resource));
+            continue;
+        }
+
+        if (b.Split == BarrierSplit::Begin)
+            mTracker.NoteTransition(resource, ToState(b.Before), ToState(b.After));
+
+        D3D12_RESOURCE_BARRIER_FLAGS flags = b.Split == BarrierSplit::Begin ?
+            D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY : D3D12_RESOURCE_BARRIER_FLAG_END_ONLY;
+        mBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(resource,
+            ToState(b.Before), ToState(b.After), D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, flags));
+    }
+
+    mTracked.clear();
+    mTracker.FlushBatch(mTracked);
+    AppendTracked(mTracked);
+
+    if (!mBarriers.empty())
+        mCmdList->ResourceBarrier((UINT)mBarriers.size(), mBarriers.data());
+}
+
+bool D3D12RenderGraphBackend::RecordPendingTransitions(ID3D12GraphicsCommandList* cmdList)
+{
+    mTracked.clear();
+    mTracker.ResolvePending(mTracked);
+
+    mBarriers.clear();
+    AppendTracked(mTracked);
+    if (mBarriers.empty())
+        return false;
+
+    cmdList->ResourceBarrier((UINT)mBarriers.size(), mBarriers.data());
+    return true;
+}
@@ -0,0 +1,61 @@
+// RenderGraphD3D12.h
+#pragma once
+#include "Common.h"
+#include "RenderGraph.h"
+#include "ResourceStateTracker.h"
+#include <unordered_map>
+
+// Runs a RenderGraph on D3D12. Imported resources are bound by the caller
+// every frame; transients are placed resources in one heap the graph sizes.
+// Barriers go to whichever command list is current, so passes that switch
+// lists call SetCommandList before the next batch is due.
+//
+// Whole transitions go through a ResourceStateTracker: their before state
+// comes from tracking rather than from the graph's assumptions, no-ops
+// are dropped, and the state each resource needs on entry is resolved
+// against the registry when the frame is submitted.
+class D3D12RenderGraphBackend : public IRenderGraphBackend
+{
+public:
+    D3D12RenderGraphBackend(ID3D12Device* device, ResourceStateRegistry& states);
+
+    static D3D12_RESOURCE_STATES ToState(uint32_t access);
+
+    void Bind(GraphResource id, ID3D12Resource* resource);
+    ID3D12Resource* GetResource(GraphResource id) const;
+
+    void SetCommandList(ID3D12GraphicsCommandList* cmdList) { mCmdList = cmdList; }
+
+    // Submit time: records the entry transitions into cmdList, which must
+    // execute ahead of the frame's lists. Returns false if none were needed.
+    bool RecordPendingTransitions(ID3D12GraphicsCommandList* cmdList);
+    // After ExecuteCommandLists: publishes the frame's final states.
+    void Commit() { mTracker.Commit(mStates); }
+
+    const StateTrackerStats& GetStateStats() const { return mTracker.GetStats(); }
+
+    virtual GraphMemory GetTextureMemory(const GraphTextureDesc& desc, uint32_t usage) override;
+
+    // Releases earlier transients; only call with no frame in flight.
+    virtual void CreateTransientHeap(uint64_t size) override;
+    virtual void PlaceTexture(GraphResource id, const GraphTextureDesc& desc, uint32_t usage,
+                              uint64_t offset, uint32_t initialAccess) override;
+
+    virtual void Barriers(const GraphBarrier* barriers, uint32_t count) override;
+
+private:
+    static D3D12_RESOURCE_DESC TextureDesc(const GraphTextureDesc& desc, uint32_t usage);
+    void AppendTracked(const std::vector<StateBarrier>& tracked);
+
+    ID3D12Device* mDevice;
+    ResourceStateRegistry& mStates;
+    ResourceStateTracker mTracker;
+    ID3D12GraphicsCommandList* mCmdList = nullptr;
+
+    ComPtr<ID3D12Heap> mHeap;
+    std::unordered_map<GraphResource, ComPtr<ID3D12Resource>> mResources;
+    std::vector<GraphResource> mTransients;
+
+    std::vector<StateBarrier> mTracked;
+    std::vector<D3D12_RESOURCE_BARRIER> mBarriers;
+};
@@ -0,0 +1,189 @@
+// ResourceStateTracker.cpp
+#include "ResourceStateTracker.h"
+#include <algorithm>
+#include <stdexcept>
+
+const uint32_t ResourceStateTracker::Unknown;
+
+void ResourceStateRegistry::Register(TrackedResource resource, uint32_t subresourceCount, uint32_t state)
+{
+    mStates[resource].assign((std::max)(subresourceCount, 1u), state);
+}
+
+void ResourceStateRegistry::Unregister(TrackedResource resource)
+{
+    mStates.erase(resource);
+}
+
+uint32_t ResourceStateRegistry::SubresourceCount(TrackedResource resource) const
+{
+    auto it = mStates.find(resource);
+    if (it == mStates.end())
+        throw std::logic_error("Resource is not registered for state tracking");
+    return (uint32_t)it->second.size();
+}
+
+uint32_t ResourceStateRegistry::GetState(TrackedResource resource, uint32_t subresource) const
+{
+    auto it = mStates.find(resource);
+    if (it == mStates.end())
+        throw std::logic_error("Resource is not registered for state tracking");
+    return it->second[subresource];
+}
+
+void ResourceStateRegistry::SetState(TrackedResource resource, uint32_t subresource, uint32_t state)
+{
+    auto it = mStates.find(resource);
+    if (it != mStates.end())
+        it->second[subresource] = state;
+}
+
+ResourceStateTracker::LocalState& ResourceStateTracker::Local(TrackedResource resource)
+{
+    auto it = mLocal.find(resource);
+    if (it != mLocal.end())
+        return it->second;
+
+    uint32_t count = mRegistry.SubresourceCount(resource);
+    LocalState& local = mLocal[resource];
+    local.Current.assign(count, Unknown);
+    local.Initial.assign(count, Unknown);
+    mOrder.push_back(resource);
+    return local;
+}
+
+void ResourceStateTracker::Transition(TrackedResource resource, uint32_t state, uint32_t subresource)
+{
+    LocalState& local = Local(resource);
+    const uint32_t count = (uint32_t)local.Current.size();
+    const uint32_t first = subresource == AllSubresources ? 0 : subresource;
+    const uint32_t last = subresource == AllSubresources ? count : subresource + 1;
+
+    for (uint32_t s = first; s < last; ++s)
+    {
+        mStats.Requested++;
+        uint32_t& current = local.Current[s];
+
+        if (current == Unknown)
+        {
+            local.Initial[s] = state;
+            current = state;
+            continue;
+        }
+        if (current == state)
+        {
+            mStats.Removed++;
+            continue;
+        }
+
+        auto pending = std::find_if(mBatch.begin(), mBatch.end(), [&](const StateBarrier& b)
+            {
+                return b.Resource == resource && b.Subresource == s;
+            });
+
+        if (pending == mBatch.end())
+        {
+            mBatch.push_back({ resource, s, current, state });
+        }
+        else
+        {
+            // A->B then B->C in one batch is A->C; A->B->A is nothing.
+            mStats.Removed++;
+            pending->After = state;
+            if (pending->Before == pending->After)
+            {
+                mBatch.erase(pending);
+                mStats.Removed++;
+            }
+        }
+        current = state;
+    }
+}
+
+void ResourceStateTracker::NoteTransition(TrackedResource resource, uint32_t before, uint32_t after,
+    uint32_t subresource)
+{
+    LocalState& local = Local(resource);
+    const uint32_t count = (uint32_t)local.Current.size();
+    const uint32_t first = subresource == AllSubresources ? 0 : subresource;
+    const uint32_t last = subresource == AllSubresources ? count : subresource + 1;
+
+    for (uint32_t s = first; s < last; ++s)
+    {
+        if (local.Current[s] == Unknown)
+            local.Initial[s] = before;
+        local.Current[s] = after;
+    }
+}
+
+void ResourceStateTracker::Append(const std::vector<StateBarrier>& barriers, std::vector<StateBarrier>& out)
+{
+    // Collapse a resource whose every subresource has the same transition.
+    for (size_t i = 0; i < barriers.size();)
+    {
+        const StateBarrier& b = barriers[i];
+        const uint32_t count = (uint32_t)mLocal[b.Resource].Current.size();
+
+        size_t run = 1;
+        while (i + run < barriers.size() && barriers[i + run].Resource == b.Resource &&
+            barriers[i + run].Before == b.Before && barriers[i + run].After == b.After)
+            ++run;
+
+        if (run == count)
+        {
+            out.push_back({ b.Resource, AllSubresources, b.Before, b.After });
+            mStats.Emitted++;
+            i += run;
+        }
+        else
+        {
+            out.push_back(b);
+            mStats.Emitted++;
+            ++i;
+        }
+    }
+}
+
+void ResourceStateTracker::FlushBatch(std::vector<StateBarrier>& out)
+{
+    Append(mBatch, out);
+    mBatch.clear();
+}
+
+void ResourceStateTracker::ResolvePending(std::vector<StateBarrier>& out)
+{
+    mScratch.clear();
+    for (TrackedResource resource : mOrder)
+    {
+        const LocalState& local = mLocal[resource];
+        for (uint32_t s = 0; s < (uint32_t)local.Initial.size(); ++s)
+        {
+            if (local.Initial[s] == Unknown)
+                continue;
+
+            uint32_t known = mRegistry.GetState(resource, s);
+            if (known == local.Initial[s])
+                mStats.Removed++;
+            else
+                mScratch.push_back({ resource, s, known, local.Initial[s] });
+        }
+    }
+    Append(mScratch, out);
+}
+
+void ResourceStateTracker::Commit(ResourceStateRegistry& registry)
+{
+    for (TrackedResource resource : mOrder)
+    {
+        const LocalState& local = mLocal[resource];
+        for (uint32_t s = 0; s < (uint32_t)local.Current.size(); ++s)
+        {
+            if (local.Current[s] != Unknown)
+                registry.SetState(resource, s, local.Current[s]);
+        }
+    }
+
+    mLocal.clear();
+    mOrder.clear();
+    mBatch.clear();
+}
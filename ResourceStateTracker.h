@@ -0,0 +1,104 @@
+// ResourceStateTracker.h
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Resources are identified by address (the ID3D12Resource* for D3D12) and
+// states are plain bit masks, so the tracking logic runs without a device.
+using TrackedResource = const void*;
+const uint32_t AllSubresources = 0xFFFFFFFFu;
+
+struct StateBarrier
+{
+    TrackedResource Resource;
+    uint32_t        Subresource; // AllSubresources when every subresource moves together
+    uint32_t        Before;
+    uint32_t        After;
+};
+
+struct StateTrackerStats
+{
+    uint64_t Requested = 0; // per-subresource transition requests
+    uint64_t Emitted = 0;   // barriers handed out, including resolved ones
+    uint64_t Removed = 0;   // requests that were no-ops, merged or cancelled
+};
+
+// States of every resource as of the last committed submission. Owned by
+// the thread that submits.
+class ResourceStateRegistry
+{
+public:
+    void Register(TrackedResource resource, uint32_t subresourceCount, uint32_t state);
+    void Unregister(TrackedResource resource);
+
+    bool     IsRegistered(TrackedResource resource) const { return mStates.count(resource) != 0; }
+    uint32_t SubresourceCount(TrackedResource resource) const;
+    uint32_t GetState(TrackedResource resource, uint32_t subresource) const;
+    void     SetState(TrackedResource resource, uint32_t subresource, uint32_t state);
+
+private:
+    std::unordered_map<TrackedResource, std::vector<uint32_t>> mStates;
+};
+
+// Tracks states while command lists are recorded, for lists that will be
+// submitted together and in order. The first state a resource needs is
+// not known while recording, since earlier submissions may still change
+// it; it is kept as a pending initial state and turned into barriers by
+// ResolvePending at submit time. Later transitions are checked against
+// the locally known state:
+//   - a transition to the current state is dropped,
+//   - transitions of one subresource in the same batch are folded into one,
+//     and dropped if they end where they started,
+//   - a batch comes out as one list, with per-subresource barriers merged
+//     into one AllSubresources barrier when every subresource moves alike.
+//
+// Transition may run on a recording thread while other trackers do the
+// same, as long as nothing registers or commits meanwhile.
+class ResourceStateTracker
+{
+public:
+    explicit ResourceStateTracker(const ResourceStateRegistry& registry) : mRegistry(registry) {}
+
+    // Throws std::logic_error for resources the registry does not know.
+    void Transition(TrackedResource resource, uint32_t state, uint32_t subresource = AllSubresources);
+
+    // For barriers the caller issues itself (split or aliasing-related):
+    // keeps the local state right without queuing anything.
+    void NoteTransition(TrackedResource resource, uint32_t before, uint32_t after,
+                        uint32_t subresource = AllSubresources);
+
+    // Appends the batched barriers and starts a new batch.
+    void FlushBatch(std::vector<StateBarrier>& out);
+
+    // Submit time, before Commit: barriers from the registry's states to
+    // the states the recorded lists expect on entry.
+    void ResolvePending(std::vector<StateBarrier>& out);
+
+    // After submission: records final states in the registry and clears
+    // the tracker for the next recording.
+    void Commit(ResourceStateRegistry& registry);
+
+    const StateTrackerStats& GetStats() const { return mStats; }
+
+private:
+    static const uint32_t Unknown = 0xFFFFFFFFu;
+
+    struct LocalState
+    {
+        std::vector<uint32_t> Current;
+        std::vector<uint32_t> Initial;
+    };
+
+    LocalState& Local(TrackedResource resource);
+    void Append(const std::vector<StateBarrier>& barriers, std::vector<StateBarrier>& out);
+
+    const ResourceStateRegistry& mRegistry;
+
+    std::unordered_map<TrackedResource, LocalState> mLocal;
+    std::vector<TrackedResource> mOrder;   // first-use order, for stable output
+    std::vector<StateBarrier> mBatch;
+    std::vector<StateBarrier> mScratch;
+
+    StateTrackerStats mStats;
+};
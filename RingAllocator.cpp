@@ -0,0 +1,75 @@
+// RingAllocator.cpp
+#include "RingAllocator.h"
+
+const uint64_t RingAllocator::InvalidOffset;
+
+static uint64_t AlignUp(uint64_t v, uint64_t a)
+{
+    return (v + a - 1) & ~(a - 1);
+}
+
+RingAllocator::RingAllocator(uint64_t capacity)
+    : mCapacity(capacity)
+{
+}
+
+uint64_t RingAllocator::Allocate(uint64_t size, uint64_t alignment)
+{
+    if (alignment == 0)
+        alignment = 1;
+
+    if (mUsed == 0)
+        mHead = mTail = 0;
+
+    uint64_t offset = AlignUp(mHead, alignment);
+    uint64_t consumed;
+
+    const bool wrapped = mUsed > 0 && mHead <= mTail;
+    if (!wrapped)
+    {
+        // Live data is [tail, head): free space is [head, cap) then [0, tail).
+        if (offset + size <= mCapacity)
+        {
+            consumed = offset + size - mHead;
+        }
+        else
+        {
+            if (size > mTail)
+                return InvalidOffset;
+            consumed = (mCapacity - mHead) + size;
+            offset = 0;
+        }
+    }
+    else
+    {
+        // Live data wraps around: free space is [head, tail).
+        if (offset + size > mTail)
+            return InvalidOffset;
+        consumed = offset + size - mHead;
+    }
+
+    mHead = offset + size;
+    mUsed += consumed;
+    mOpen += consumed;
+    if (mUsed > mPeakUsed)
+        mPeakUsed = mUsed;
+
+    return offset;
+}
+
+void RingAllocator::EndBatch(uint64_t fence)
+{
+    if (mOpen > 0)
+        mBatches.push_back({ mHead, mOpen, fence });
+    mOpen = 0;
+}
+
+void RingAllocator::Reclaim(uint64_t completedFence)
+{
+    while (!mBatches.empty() && mBatches.front().Fence <= completedFence)
+    {
+        mTail = mBatches.front().End;
+        mUsed -= mBatches.front().Units;
+        mBatches.pop_front();
+    }
+}
@@ -0,0 +1,47 @@
+// RingAllocator.h
+#pragma once
+#include <cstdint>
+#include <deque>
+
+// Offset bookkeeping behind UploadRing and DescriptorRing, in abstract
+// units over [0, capacity). Allocations between two EndBatch calls form a
+// batch tagged with a fence value; Reclaim retires every batch whose fence
+// has completed. An allocation never wraps, so it is always contiguous; the
+// skipped tail counts as used until its batch retires.
+class RingAllocator
+{
+public:
+    static const uint64_t InvalidOffset = ~0ull;
+
+    explicit RingAllocator(uint64_t capacity);
+
+    // alignment is a power of two. InvalidOffset when the in-flight batches
+    // leave no contiguous room.
+    uint64_t Allocate(uint64_t size, uint64_t alignment = 1);
+
+    void EndBatch(uint64_t fence);
+    void Reclaim(uint64_t completedFence);
+
+    uint64_t Capacity() const { return mCapacity; }
+    uint64_t Used() const { return mUsed; }
+    uint64_t PeakUsed() const { return mPeakUsed; }
+    uint32_t BatchesInFlight() const { return (uint32_t)mBatches.size(); }
+
+private:
+    struct Batch
+    {
+        uint64_t End;
+        uint64_t Units;
+        uint64_t Fence;
+    };
+
+    uint64_t mCapacity;
+
+    uint64_t mHead = 0;     // next free unit
+    uint64_t mTail = 0;     // start of the oldest live batch
+    uint64_t mUsed = 0;     // live units including alignment and wrap waste
+    uint64_t mOpen = 0;     // units of the batch still being recorded
+    uint64_t mPeakUsed = 0;
+
+    std::deque<Batch> mBatches;
+};
@@ -0,0 +1,181 @@
+// SceneMath.h
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Plain math types for code that has to run without Windows headers
+// (scene index, culling, bake tools). Matrices use the same row-vector,
+// row-major convention as XMFLOAT4X4 so they can be memcpy'd across.
+
+struct Vec3
+{
+    float x, y, z;
+};
+
+inline Vec3 operator+(const Vec3& a, const Vec3& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+inline Vec3 operator-(const Vec3& a, const Vec3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+inline Vec3 operator*(const Vec3& a, float s) { return { a.x * s, a.y * s, a.z * s }; }
+
+inline float Dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline float Length(const Vec3& a) { return std::sqrt(Dot(a, a)); }
+inline Vec3  Cross(const Vec3& a, const Vec3& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+inline Vec3  Normalize(const Vec3& a) { float l = Length(a); return l > 0.0f ? a * (1.0f / l) : a; }
+inline Vec3  MinVec(const Vec3& a, const Vec3& b) { return { a.x < b.x ? a.x : b.x, a.y < b.y ? a.y : b.y, a.z < b.z ? a.z : b.z }; }
+inline Vec3  MaxVec(const Vec3& a, const Vec3& b) { return { a.x > b.x ? a.x : b.x, a.y > b.y ? a.y : b.y, a.z > b.z ? a.z : b.z }; }
+
+struct Sphere
+{
+    Vec3  Center;
+    float Radius;
+};
+
+struct Aabb
+{
+    Vec3 Min;
+    Vec3 Max;
+
+    static Aabb Empty() { return { { 3.4e38f, 3.4e38f, 3.4e38f }, { -3.4e38f, -3.4e38f, -3.4e38f } }; }
+    void Grow(const Vec3& p) { Min = MinVec(Min, p); Max = MaxVec(Max, p); }
+    void Grow(const Aabb& b) { Min = MinVec(Min, b.Min); Max = MaxVec(Max, b.Max); }
+    Vec3 Center() const { return (Min + Max) * 0.5f; }
+};
+
+inline bool Overlaps(const Aabb& a, const Aabb& b)
+{
+    return a.Min.x <= b.Max.x && a.Max.x >= b.Min.x &&
+           a.Min.y <= b.Max.y && a.Max.y >= b.Min.y &&
+           a.Min.z <= b.Max.z && a.Max.z >= b.Min.z;
+}
+
+// n.p + d >= 0 is the inside half-space.
+struct Plane
+{
+    Vec3  N;
+    float D;
+};
+
+struct Mat4
+{
+    float m[4][4];
+};
+
+enum class CullResult
+{
+    Outside,
+    Intersect,
+    Inside
+};
+
+struct Frustum
+{
+    Plane Planes[6]; // left, right, bottom, top, near, far
+
+    // Planes of a D3D-style (z in [0,1]) view-projection matrix.
+    static Frustum FromViewProj(const Mat4& vp)
+    {
+        Frustum f;
+        auto col = [&](int c, int r) { return vp.m[r][c]; };
+        auto set = [&](int i, float sa, int a, float sb, int b)
+            {
+                Plane& p = f.Planes[i];
+                p.N.x = sa * col(a, 0) + sb * col(b, 0);
+                p.N.y = sa * col(a, 1) + sb * col(b, 1);
+                p.N.z = sa * col(a, 2) + sb * col(b, 2);
+                p.D   = sa * col(a, 3) + sb * col(b, 3);
+            };
+
+        set(0, 1.0f, 3,  1.0f, 0);
+        set(1, 1.0f, 3, -1.0f, 0);
+        set(2, 1.0f, 3,  1.0f, 1);
+        set(3, 1.0f, 3, -1.0f, 1);
+        set(4, 0.0f, 3,  1.0f, 2);
+        set(5, 1.0f, 3, -1.0f, 2);
+
+        for (Plane& p : f.Planes)
+        {
+            float len = Length(p.N);
+            if (len > 0.0f)
+            {
+                float inv = 1.0f / len;
+                p.N = p.N * inv;
+                p.D *= inv;
+            }
+        }
+        return f;
+    }
+
+    bool Intersects(const Sphere& s) const
+    {
+        for (const Plane& p : Planes)
+        {
+            if (Dot(p.N, s.Center) + p.D < -s.Radius)
+                return false;
+        }
+        return true;
+    }
+
+    CullResult Classify(const Aabb& box) const
+    {
+        CullResult result = CullResult::Inside;
+        for (const Plane& p : Planes)
+        {
+            // Corner furthest along the plane normal, and the opposite one.
+            Vec3 pos = { p.N.x >= 0.0f ? box.Max.x : box.Min.x,
+                         p.N.y >= 0.0f ? box.Max.y : box.Min.y,
+                         p.N.z >= 0.0f ? box.Max.z : box.Min.z };
+            Vec3 neg = { p.N.x >= 0.0f ? box.Min.x : box.Max.x,
+                         p.N.y >= 0.0f ? box.Min.y : box.Max.y,
+                         p.N.z >= 0.0f ? box.Min.z : box.Max.z };
+
+            if (Dot(p.N, pos) + p.D < 0.0f)
+                return CullResult::Outside;
+            if (Dot(p.N, neg) + p.D < 0.0f)
+                result = CullResult::Intersect;
+        }
+        return result;
+    }
+};
+
+inline bool Intersects(const Sphere& a, const Sphere& b)
+{
+    Vec3 d = a.Center - b.Center;
+    float r = a.Radius + b.Radius;
+    return Dot(d, d) <= r * r;
+}
+
+inline bool Intersects(const Aabb& box, const Sphere& s)
+{
+    float d2 = 0.0f;
+    const float c[3]  = { s.Center.x, s.Center.y, s.Center.z };
+    const float mn[3] = { box.Min.x, box.Min.y, box.Min.z };
+    const float mx[3] = { box.Max.x, box.Max.y, box.Max.z };
+    for (int i = 0; i < 3; ++i)
+    {
+        if (c[i] < mn[i]) d2 += (mn[i] - c[i]) * (mn[i] - c[i]);
+        else if (c[i] > mx[i]) d2 += (c[i] - mx[i]) * (c[i] - mx[i]);
+    }
+    return d2 <= s.Radius * s.Radius;
+}
+
+inline Vec3 TransformPoint(const Vec3& p, const Mat4& m)
+{
+    return {
+        p.x * m.m[0][0] + p.y * m.m[1][0] + p.z * m.m[2][0] + m.m[3][0],
+        p.x * m.m[0][1] + p.y * m.m[1][1] + p.z * m.m[2][1] + m.m[3][1],
+        p.x * m.m[0][2] + p.y * m.m[1][2] + p.z * m.m[2][2] + m.m[3][2] };
+}
+
+inline Mat4 Mul(const Mat4& a, const Mat4& b)
+{
+    Mat4 r;
+    for (int i = 0; i < 4; ++i)
+    {
+        for (int j = 0; j < 4; ++j)
+        {
+            r.m[i][j] = a.m[i][0] * b.m[0][j] + a.m[i][1] * b.m[1][j] +
+                        a.m[i][2] * b.m[2][j] + a.m[i][3] * b.m[3][j];
+        }
+    }
+    return r;
+}
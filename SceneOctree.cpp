@@ -0,0 +1,351 @@
+// SceneOctree.cpp
+#include "SceneOctree.h"
+#include <algorithm>
+
+SceneOctree::SceneOctree(const Aabb& worldBounds, uint32_t maxDepth)
+    : mMaxDepth(std::min(maxDepth, MaxSupportedDepth))
+{
+    Vec3 extent = worldBounds.Max - worldBounds.Min;
+    mWorldSize = std::max(extent.x, std::max(extent.y, extent.z));
+    if (mWorldSize <= 0.0f)
+        mWorldSize = 1.0f;
+
+    Vec3 center = (worldBounds.Min + worldBounds.Max) * 0.5f;
+    float half = mWorldSize * 0.5f;
+    mOrigin = { center.x - half, center.y - half, center.z - half };
+
+    Clear();
+}
+
+void SceneOctree::Clear()
+{
+    mNodes.clear();
+    mFreeNodes.clear();
+    mNodeLookup.clear();
+    mObjects.clear();
+    mFreeObjects.clear();
+    mStats = Stats();
+
+    // The root always exists; it also holds anything that does not fit the world.
+    AllocNode(MakeKey(0, 0, 0, 0), 0, 0, 0, 0);
+}
+
+uint64_t SceneOctree::MakeKey(uint32_t level, uint32_t x, uint32_t y, uint32_t z)
+{
+    return ((uint64_t)level << 48) | ((uint64_t)x << 32) | ((uint64_t)y << 16) | (uint64_t)z;
+}
+
+int32_t SceneOctree::AllocNode(uint64_t key, uint32_t level, uint32_t x, uint32_t y, uint32_t z)
+{
+    int32_t index;
+    if (!mFreeNodes.empty())
+    {
+        index = mFreeNodes.back();
+        mFreeNodes.pop_back();
+    }
+    else
+    {
+        index = (int32_t)mNodes.size();
+        mNodes.emplace_back();
+    }
+
+    Node& n = mNodes[index];
+    n.Key = key;
+    n.Parent = -1;
+    std::fill(std::begin(n.Children), std::end(n.Children), -1);
+    n.SubtreeCount = 0;
+    n.Objects.clear();
+
+    float cell = mWorldSize / (float)(1u << level);
+    Vec3 cellMin = { mOrigin.x + x * cell, mOrigin.y + y * cell, mOrigin.z + z * cell };
+    float pad = cell * 0.5f;
+    n.Loose.Min = { cellMin.x - pad, cellMin.y - pad, cellMin.z - pad };
+    n.Loose.Max = { cellMin.x + cell + pad, cellMin.y + cell + pad, cellMin.z + cell + pad };
+
+    mNodeLookup[key] = index;
+    mStats.Nodes++;
+    return index;
+}
+
+int32_t SceneOctree::FindOrCreateNode(uint32_t level, uint32_t x, uint32_t y, uint32_t z)
+{
+    uint64_t key = MakeKey(level, x, y, z);
+    auto it = mNodeLookup.find(key);
+    if (it != mNodeLookup.end())
+        return it->second;
+
+    int32_t node = AllocNode(key, level, x, y, z);
+
+    // Chain up to the first ancestor that already exists (at most mMaxDepth steps).
+    int32_t child = node;
+    while (level > 0)
+    {
+        uint32_t slot = (x & 1u) | ((y & 1u) << 1) | ((z & 1u) << 2);
+        --level; x >>= 1; y >>= 1; z >>= 1;
+
+        uint64_t parentKey = MakeKey(level, x, y, z);
+        auto pit = mNodeLookup.find(parentKey);
+        int32_t parent = (pit != mNodeLookup.end()) ? pit->second : AllocNode(parentKey, level, x, y, z);
+
+        mNodes[child].Parent = parent;
+        mNodes[parent].Children[slot] = child;
+
+        if (pit != mNodeLookup.end())
+            break;
+        child = parent;
+    }
+
+    return node;
+}
+
+void SceneOctree::ReleaseEmptyNodes(int32_t node)
+{
+    while (node > 0 && mNodes[node].SubtreeCount == 0)
+    {
+        Node& n = mNodes[node];
+        int32_t parent = n.Parent;
+
+        for (int32_t& c : mNodes[parent].Children)
+        {
+            if (c == node)
+            {
+                c = -1;
+                break;
+            }
+        }
+
+        mNodeLookup.erase(n.Key);
+        mFreeNodes.push_back(node);
+        mStats.Nodes--;
+        node = parent;
+    }
+}
+
+bool SceneOctree::FitsLoose(const Node& node, const Sphere& s) const
+{
+    const float r = s.Radius;
+    return s.Center.x - r >= node.Loose.Min.x && s.Center.x + r <= node.Loose.Max.x &&
+           s.Center.y - r >= node.Loose.Min.y && s.Center.y + r <= node.Loose.Max.y &&
+           s.Center.z - r >= node.Loose.Min.z && s.Center.z + r <= node.Loose.Max.z;
+}
+
+void SceneOctree::Link(uint32_t obj)
+{
+    Object& o = mObjects[obj];
+    const Sphere& s = o.Bounds;
+
+    // Deepest level whose cell half size covers the radius.
+    uint32_t level = 0;
+    if (s.Radius > 0.0f)
+    {
+        float ratio = (mWorldSize * 0.5f) / s.Radius;
+        if (ratio >= 1.0f)
+            level = std::min((uint32_t)std::log2(ratio), mMaxDepth);
+    }
+    else
+    {
+        level = mMaxDepth;
+    }
+
+    int32_t node = 0;
+    if (level > 0)
+    {
+        uint32_t cells = 1u << level;
+        float invCell = (float)cells / mWorldSize;
+        auto cellOf = [&](float v, float origin)
+            {
+                float c = std::floor((v - origin) * invCell);
+                return (uint32_t)std::min(std::max(c, 0.0f), (float)(cells - 1));
+            };
+
+        uint32_t x = cellOf(s.Center.x, mOrigin.x);
+        uint32_t y = cellOf(s.Center.y, mOrigin.y);
+        uint32_t z = cellOf(s.Center.z, mOrigin.z);
+
+        // Centers outside the world get clamped into an edge cell, which may not
+        // hold them; those objects live at the root instead.
+        uint64_t key = MakeKey(level, x, y, z);
+        auto it = mNodeLookup.find(key);
+        if (it != mNodeLookup.end())
+        {
+            node = it->second;
+            if (!FitsLoose(mNodes[node], s))
+                node = 0;
+        }
+        else
+        {
+            float cell = mWorldSize / (float)cells;
+            Node probe;
+            float pad = cell * 0.5f;
+            probe.Loose.Min = { mOrigin.x + x * cell - pad, mOrigin.y + y * cell - pad, mOrigin.z + z * cell - pad };
+            probe.Loose.Max = { probe.Loose.Min.x + 2.0f * cell, probe.Loose.Min.y + 2.0f * cell, probe.Loose.Min.z + 2.0f * cell };
+            node = FitsLoose(probe, s) ? FindOrCreateNode(level, x, y, z) : 0;
+        }
+    }
+
+    Node& n = mNodes[node];
+    o.Node = node;
+    o.IndexInNode = (uint32_t)n.Objects.size();
+    n.Objects.push_back(obj);
+
+    for (int32_t a = node; a >= 0; a = mNodes[a].Parent)
+        mNodes[a].SubtreeCount++;
+}
+
+void SceneOctree::Unlink(uint32_t obj)
+{
+    Object& o = mObjects[obj];
+    Node& n = mNodes[o.Node];
+
+    uint32_t last = n.Objects.back();
+    n.Objects[o.IndexInNode] = last;
+    mObjects[last].IndexInNode = o.IndexInNode;
+    n.Objects.pop_back();
+
+    for (int32_t a = o.Node; a >= 0; a = mNodes[a].Parent)
+        mNodes[a].SubtreeCount--;
+
+    ReleaseEmptyNodes(o.Node);
+    o.Node = -1;
+}
+
+SceneOctree::Handle SceneOctree::Insert(const Sphere& bounds, uint32_t userData)
+{
+    uint32_t obj;
+    if (!mFreeObjects.empty())
+    {
+        obj = mFreeObjects.back();
+        mFreeObjects.pop_back();
+    }
+    else
+    {
+        obj = (uint32_t)mObjects.size();
+        mObjects.emplace_back();
+    }
+
+    mObjects[obj].Bounds = bounds;
+    mObjects[obj].UserData = userData;
+    Link(obj);
+
+    mStats.Objects++;
+    return obj;
+}
+
+void SceneOctree::Move(Handle handle, const Sphere& bounds)
+{
+    Object& o = mObjects[handle];
+    const Node& n = mNodes[o.Node];
+
+    // Still inside the loose cell: nothing but the sphere changes. Objects
+    // that shrank stay a level too high, which only costs a little culling.
+    if (o.Node != 0 && FitsLoose(n, bounds))
+    {
+        o.Bounds = bounds;
+        mStats.MovesInPlace++;
+        return;
+    }
+
+    Unlink(handle);
+    o.Bounds = bounds;
+    Link(handle);
+    mStats.Relinks++;
+}
+
+void SceneOctree::Remove(Handle handle)
+{
+    Unlink(handle);
+    mFreeObjects.push_back(handle);
+    mStats.Objects--;
+}
+
+void SceneOctree::ResetFrameStats()
+{
+    mStats.MovesInPlace = 0;
+    mStats.Relinks = 0;
+    mStats.NodesVisited = 0;
+}
+
+void SceneOctree::CollectSubtree(int32_t node, std::vector<uint32_t>& out) const
+{
+    size_t base = mStack.size();
+    mStack.push_back(node);
+
+    while (mStack.size() > base)
+    {
+        const Node& n = mNodes[mStack.back()];
+        mStack.pop_back();
+        mStats.NodesVisited++;
+
+        for (uint32_t obj : n.Objects)
+            out.push_back(mObjects[obj].UserData);
+
+        for (int32_t c : n.Children)
+            if (c >= 0) mStack.push_back(c);
+    }
+}
+
+void SceneOctree::QueryFrustum(const Frustum& frustum, std::vector<uint32_t>& out, bool testObjects) const
+{
+    mStack.clear();
+    mStack.push_back(0);
+
+    while (!mStack.empty())
+    {
+        int32_t index = mStack.back();
+        mStack.pop_back();
+
+        const Node& n = mNodes[index];
+        if (n.SubtreeCount == 0)
+            continue;
+
+        // The root also holds out-of-world objects, so it is never trivially accepted.
+        CullResult r = (index == 0) ? CullResult::Intersect : frustum.Classify(n.Loose);
+        if (r == CullResult::Outside)
+        {
+            mStats.NodesVisited++;
+            continue;
+        }
+        if (r == CullResult::Inside)
+        {
+            CollectSubtree(index, out);
+            continue;
+        }
+
+        mStats.NodesVisited++;
+        for (uint32_t obj : n.Objects)
+        {
+            if (!testObjects || frustum.Intersects(mObjects[obj].Bounds))
+                out.push_back(mObjects[obj].UserData);
+        }
+
+        for (int32_t c : n.Children)
+            if (c >= 0) mStack.push_back(c);
+    }
+}
+
+void SceneOctree::QuerySphere(const Sphere& sphere, std::vector<uint32_t>& out) const
+{
+    mStack.clear();
+    mStack.push_back(0);
+
+    while (!mStack.empty())
+    {
+        int32_t index = mStack.back();
+        mStack.pop_back();
+
+        const Node& n = mNodes[index];
+        mStats.NodesVisited++;
+
+        if (n.SubtreeCount == 0 || (index != 0 && !Intersects(n.Loose, sphere)))
+            continue;
+
+        for (uint32_t obj : n.Objects)
+        {
+            if (Intersects(mObjects[obj].Bounds, sphere))
+                out.push_back(mObjects[obj].UserData);
+        }
+
+        for (int32_t c : n.Children)
+            if (c >= 0) mStack.push_back(c);
+    }
+}
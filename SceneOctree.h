@@ -0,0 +1,95 @@
+// SceneOctree.h
+#pragma once
+#include "SceneMath.h"
+#include <vector>
+#include <unordered_map>
+
+// Loose octree (looseness k = 2) over a cubic world region.
+// An object is stored at the deepest level whose cell half size still covers
+// its radius, in the cell that contains its center, so insert and relink are
+// a direct computation rather than a descent. Moves that stay inside the
+// node's loose bounds only overwrite the stored sphere.
+class SceneOctree
+{
+public:
+    using Handle = uint32_t;
+    static const Handle InvalidHandle = 0xFFFFFFFFu;
+    static const uint32_t MaxSupportedDepth = 16;
+
+    struct Stats
+    {
+        uint32_t Objects = 0;
+        uint32_t Nodes = 0;
+
+        // Reset by ResetFrameStats()
+        uint32_t MovesInPlace = 0;
+        uint32_t Relinks = 0;
+        uint32_t NodesVisited = 0;
+    };
+
+public:
+    SceneOctree(const Aabb& worldBounds, uint32_t maxDepth = 8);
+
+    Handle Insert(const Sphere& bounds, uint32_t userData);
+    void   Move(Handle handle, const Sphere& bounds);
+    void   Remove(Handle handle);
+    void   Clear();
+
+    const Sphere& GetBounds(Handle handle) const { return mObjects[handle].Bounds; }
+    uint32_t      GetUserData(Handle handle) const { return mObjects[handle].UserData; }
+
+    // Appends the user data of every object that passes the query. With
+    // testObjects false the frustum query stops at node granularity and
+    // leaves per-object tests to the caller's batched kernel.
+    void QueryFrustum(const Frustum& frustum, std::vector<uint32_t>& out, bool testObjects = true) const;
+    void QuerySphere(const Sphere& sphere, std::vector<uint32_t>& out) const;
+
+    const Stats& GetStats() const { return mStats; }
+    void ResetFrameStats();
+
+private:
+    struct Node
+    {
+        uint64_t Key = 0;
+        int32_t  Parent = -1;
+        int32_t  Children[8];
+        uint32_t SubtreeCount = 0;
+        Aabb     Loose = {};
+        std::vector<uint32_t> Objects;
+    };
+
+    struct Object
+    {
+        Sphere   Bounds = {};
+        uint32_t UserData = 0;
+        int32_t  Node = -1;
+        uint32_t IndexInNode = 0;
+    };
+
+    static uint64_t MakeKey(uint32_t level, uint32_t x, uint32_t y, uint32_t z);
+
+    int32_t FindOrCreateNode(uint32_t level, uint32_t x, uint32_t y, uint32_t z);
+    int32_t AllocNode(uint64_t key, uint32_t level, uint32_t x, uint32_t y, uint32_t z);
+    void    ReleaseEmptyNodes(int32_t node);
+
+    void Link(uint32_t obj);
+    void Unlink(uint32_t obj);
+
+    bool FitsLoose(const Node& node, const Sphere& s) const;
+    void CollectSubtree(int32_t node, std::vector<uint32_t>& out) const;
+
+private:
+    Vec3     mOrigin;     // min corner of the cubic world
+    float    mWorldSize;  // edge length of the root cell
+    uint32_t mMaxDepth;
+
+    std::vector<Node>     mNodes;
+    std::vector<int32_t>  mFreeNodes;
+    std::unordered_map<uint64_t, int32_t> mNodeLookup;
+
+    std::vector<Object>   mObjects;
+    std::vector<uint32_t> mFreeObjects;
+
+    mutable std::vector<int32_t> mStack;
+    mutable Stats mStats;
+};
@@ -0,0 +1,157 @@
+// SceneOctreeBench.cpp
+// Dynamic-scene benchmark: SceneOctreeBench [objects] [frames]
+// Moves every object each frame, the way a scene update would, and reports
+// the time per frame with how many moves stayed in place and how many had
+// to relink. Remove plus Insert every frame is timed as the baseline, and a
+// frustum query per frame shows what the moving tree costs to read.
+// Standard library only; on Linux:
+//   g++ -O2 -std=c++17 SceneOctreeBench.cpp SceneOctree.cpp -o SceneOctreeBench
+#include "SceneOctree.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace
+{
+    const float WorldHalf = 1000.0f;
+
+    struct Mover
+    {
+        Sphere Bounds;
+        Vec3   Velocity;
+    };
+
+    std::vector<Mover> MakeScene(uint32_t count)
+    {
+        // Mostly small props with a few large ones; most move slowly, some fast.
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> pos(-WorldHalf, WorldHalf);
+        std::uniform_real_distribution<float> dir(-1.0f, 1.0f);
+        std::vector<Mover> movers(count);
+        for (Mover& m : movers)
+        {
+            const float radius = (rng() % 50 == 0) ? 20.0f + (float)(rng() % 60) : 0.5f + (float)(rng() % 40) * 0.1f;
+            const float speed = (rng() % 10 == 0) ? 60.0f : 4.0f;
+            m.Bounds = { { pos(rng), pos(rng), pos(rng) }, radius };
+            m.Velocity = Normalize({ dir(rng), dir(rng), dir(rng) }) * speed;
+        }
+        return movers;
+    }
+
+    void Step(Mover& m, float dt)
+    {
+        m.Bounds.Center = m.Bounds.Center + m.Velocity * dt;
+        float* c = &m.Bounds.Center.x;
+        float* v = &m.Velocity.x;
+        for (int i = 0; i < 3; ++i)
+        {
+            if (c[i] < -WorldHalf || c[i] > WorldHalf)
+                v[i] = -v[i];
+        }
+    }
+
+    Frustum MakeFrustum()
+    {
+        // A 90 degree view from the world's edge looking at the centre, as
+        // planes through the eye plus a near and a far plane.
+        const Vec3 eye = { 0.0f, 0.0f, -WorldHalf };
+        const float s = 0.70710678f;
+        Frustum f;
+        f.Planes[0] = { {  s, 0.0f, s }, -Dot({  s, 0.0f, s }, eye) };
+        f.Planes[1] = { { -s, 0.0f, s }, -Dot({ -s, 0.0f, s }, eye) };
+        f.Planes[2] = { { 0.0f,  s, s }, -Dot({ 0.0f,  s, s }, eye) };
+        f.Planes[3] = { { 0.0f, -s, s }, -Dot({ 0.0f, -s, s }, eye) };
+        f.Planes[4] = { { 0.0f, 0.0f,  1.0f }, -Dot({ 0.0f, 0.0f,  1.0f }, eye) - 1.0f };
+        f.Planes[5] = { { 0.0f, 0.0f, -1.0f },  Dot({ 0.0f, 0.0f,  1.0f }, eye) + 2.0f * WorldHalf };
+        return f;
+    }
+
+    double Ms(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t objects = argc > 1 ? (uint32_t)atoi(argv[1]) : 100000;
+    uint32_t frames = argc > 2 ? (uint32_t)atoi(argv[2]) : 120;
+    const float dt = 1.0f / 60.0f;
+    const Aabb world = { { -WorldHalf, -WorldHalf, -WorldHalf }, { WorldHalf, WorldHalf, WorldHalf } };
+    const Frustum frustum = MakeFrustum();
+
+    std::vector<uint32_t> visible;
+    visible.reserve(objects);
+
+    // Move in place or relink, as the scene update does it.
+    double moveMs = 0.0, moveMax = 0.0, queryMs = 0.0;
+    uint64_t inPlace = 0, relinks = 0, found = 0;
+    uint32_t nodes = 0;
+    {
+        std::vector<Mover> movers = MakeScene(objects);
+        SceneOctree tree(world, 8);
+        std::vector<SceneOctree::Handle> handles(objects);
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < objects; ++i)
+            handles[i] = tree.Insert(movers[i].Bounds, i);
+        printf("objects %u, frames %u, build %.2f ms, %u nodes\n\n", objects, frames, Ms(start), tree.GetStats().Nodes);
+
+        for (uint32_t f = 0; f < frames; ++f)
+        {
+            tree.ResetFrameStats();
+
+            start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < objects; ++i)
+            {
+                Step(movers[i], dt);
+                tree.Move(handles[i], movers[i].Bounds);
+            }
+            const double ms = Ms(start);
+            moveMs += ms;
+            moveMax = ms > moveMax ? ms : moveMax;
+            inPlace += tree.GetStats().MovesInPlace;
+            relinks += tree.GetStats().Relinks;
+
+            start = std::chrono::steady_clock::now();
+            visible.clear();
+            tree.QueryFrustum(frustum, visible);
+            queryMs += Ms(start);
+            found += visible.size();
+        }
+        nodes = tree.GetStats().Nodes;
+    }
+
+    // Baseline: take every object out and put it back each frame.
+    double reinsertMs = 0.0;
+    {
+        std::vector<Mover> movers = MakeScene(objects);
+        SceneOctree tree(world, 8);
+        std::vector<SceneOctree::Handle> handles(objects);
+        for (uint32_t i = 0; i < objects; ++i)
+            handles[i] = tree.Insert(movers[i].Bounds, i);
+
+        for (uint32_t f = 0; f < frames; ++f)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < objects; ++i)
+            {
+                Step(movers[i], dt);
+                tree.Remove(handles[i]);
+                handles[i] = tree.Insert(movers[i].Bounds, i);
+            }
+            reinsertMs += Ms(start);
+        }
+    }
+
+    const double moves = (double)objects * frames;
+    printf("%-18s %10s %10s\n", "", "ms/frame", "ns/object");
+    printf("%-18s %10.3f %10.1f   (worst frame %.3f ms)\n", "Move", moveMs / frames, moveMs * 1e6 / moves, moveMax);
+    printf("%-18s %10.3f %10.1f\n", "Remove + Insert", reinsertMs / frames, reinsertMs * 1e6 / moves);
+    printf("%-18s %10.3f %10s   (%.0f visible)\n\n", "QueryFrustum", queryMs / frames, "", (double)found / frames);
+    printf("per frame: %.0f moves in place, %.0f relinks (%.2f%%), %u nodes at the end\n",
+           (double)inPlace / frames, (double)relinks / frames, 100.0 * (double)relinks / moves, nodes);
+    return 0;
+}
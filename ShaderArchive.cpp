@@ -0,0 +1,128 @@
+// ShaderArchive.cpp
+#include "ShaderArchive.h"
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <ostream>
+
+static const uint32_t ShaderArchiveMagic = 0x52414853; // "SHAR"
+static const uint32_t ShaderArchiveVersion = 1;
+
+uint64_t HashBytes(const void* data, size_t size, uint64_t seed)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint64_t h = seed;
+    for (size_t i = 0; i < size; ++i)
+    {
+        h ^= p[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+uint64_t MakeShaderKey(const char* file, const char* entry, const char* profile, uint64_t permutation)
+{
+    uint64_t h = HashBytes(file, strlen(file));
+    h = HashBytes("|", 1, h);
+    h = HashBytes(entry, strlen(entry), h);
+    h = HashBytes("|", 1, h);
+    h = HashBytes(profile, strlen(profile), h);
+    return HashBytes(&permutation, sizeof(permutation), h);
+}
+
+template <typename T>
+static void WritePod(std::ostream& out, const T& v)
+{
+    out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template <typename T>
+static bool ReadPod(std::istream& in, T& v)
+{
+    in.read(reinterpret_cast<char*>(&v), sizeof(T));
+    return (bool)in;
+}
+
+void ShaderArchive::Add(uint64_t key, const std::vector<uint8_t>& bytecode, const std::vector<uint8_t>& reflection)
+{
+    Entry e;
+    e.Key = key;
+    e.BytecodeHash = HashBytes(bytecode.data(), bytecode.size());
+    e.Offset = (uint32_t)mData.size();
+    e.Size = (uint32_t)bytecode.size();
+    mData.insert(mData.end(), bytecode.begin(), bytecode.end());
+
+    // Keep bytecode 4-byte aligned for the runtime.
+    mData.resize((mData.size() + 3) & ~(size_t)3);
+
+    e.ReflectionOffset = (uint32_t)mData.size();
+    e.ReflectionSize = (uint32_t)reflection.size();
+    mData.insert(mData.end(), reflection.begin(), reflection.end());
+    mData.resize((mData.size() + 3) & ~(size_t)3);
+
+    auto it = std::lower_bound(mIndex.begin(), mIndex.end(), key,
+        [](const Entry& a, uint64_t k) { return a.Key < k; });
+    if (it != mIndex.end() && it->Key == key)
+        *it = e;
+    else
+        mIndex.insert(it, e);
+}
+
+void ShaderArchive::Write(std::ostream& out) const
+{
+    WritePod(out, ShaderArchiveMagic);
+    WritePod(out, ShaderArchiveVersion);
+    WritePod(out, (uint32_t)mIndex.size());
+    WritePod(out, (uint32_t)mData.size());
+    out.write(reinterpret_cast<const char*>(mIndex.data()), mIndex.size() * sizeof(Entry));
+    out.write(reinterpret_cast<const char*>(mData.data()), mData.size());
+}
+
+bool ShaderArchive::Read(std::istream& in)
+{
+    uint32_t magic = 0, version = 0, count = 0, dataSize = 0;
+    if (!ReadPod(in, magic) || magic != ShaderArchiveMagic ||
+        !ReadPod(in, version) || version != ShaderArchiveVersion ||
+        !ReadPod(in, count) || !ReadPod(in, dataSize))
+        return false;
+
+    mIndex.resize(count);
+    in.read(reinterpret_cast<char*>(mIndex.data()), count * sizeof(Entry));
+
+    mData.resize(dataSize);
+    in.read(reinterpret_cast<char*>(mData.data()), dataSize);
+
+    if (!in)
+    {
+        mIndex.clear();
+        mData.clear();
+        return false;
+    }
+
+    for (const Entry& e : mIndex)
+    {
+        if ((uint64_t)e.Offset + e.Size > dataSize ||
+            (uint64_t)e.ReflectionOffset + e.ReflectionSize > dataSize)
+        {
+            mIndex.clear();
+            mData.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ShaderArchive::Find(uint64_t key, ShaderBlob& out) const
+{
+    auto it = std::lower_bound(mIndex.begin(), mIndex.end(), key,
+        [](const Entry& a, uint64_t k) { return a.Key < k; });
+    if (it == mIndex.end() || it->Key != key)
+        return false;
+
+    out.Bytecode = mData.data() + it->Offset;
+    out.BytecodeSize = it->Size;
+    out.Reflection = it->ReflectionSize ? mData.data() + it->ReflectionOffset : nullptr;
+    out.ReflectionSize = it->ReflectionSize;
+    out.BytecodeHash = it->BytecodeHash;
+    return true;
+}
@@ -0,0 +1,53 @@
+// ShaderArchive.h
+#pragma once
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+// 64-bit FNV-1a; stable across platforms so the offline tool and the
+// runtime agree on keys.
+uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0xcbf29ce484222325ULL);
+
+// Identifies one compiled variant: source file name (no directory), entry
+// point, target profile and permutation bits.
+uint64_t MakeShaderKey(const char* file, const char* entry, const char* profile, uint64_t permutation = 0);
+
+struct ShaderBlob
+{
+    const void* Bytecode = nullptr;
+    size_t      BytecodeSize = 0;
+    const void* Reflection = nullptr; // DXC reflection container, may be empty
+    size_t      ReflectionSize = 0;
+    uint64_t    BytecodeHash = 0;
+};
+
+// Precompiled shaders in one file: a key-sorted index followed by the
+// bytecode and reflection data. Lookups return pointers into the loaded
+// file, so fetching a shader is a binary search and nothing else.
+class ShaderArchive
+{
+public:
+    bool Read(std::istream& in);
+    bool Find(uint64_t key, ShaderBlob& out) const;
+
+    size_t Count() const { return mIndex.size(); }
+    size_t DataBytes() const { return mData.size(); }
+
+    // Build side, used by ShaderBuildTool.
+    void Add(uint64_t key, const std::vector<uint8_t>& bytecode, const std::vector<uint8_t>& reflection);
+    void Write(std::ostream& out) const;
+
+private:
+    struct Entry
+    {
+        uint64_t Key;
+        uint64_t BytecodeHash;
+        uint32_t Offset;
+        uint32_t Size;
+        uint32_t ReflectionOffset;
+        uint32_t ReflectionSize;
+    };
+
+    std::vector<Entry>   mIndex;
+    std::vector<uint8_t> mData;
+};
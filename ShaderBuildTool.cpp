@@ -0,0 +1,124 @@
+// ShaderBuildTool.cpp
+// Offline shader build: ShaderBuildTool <manifest.txt> <output.bin> [dxc]
+// Compiles every manifest entry with DXC at full optimization and packs the
+// results into a ShaderArchive. Uses only the standard library and the dxc
+// command line, so it runs on Windows and Linux build machines alike.
+//
+// Manifest lines: <file.hlsl> <entry> <profile> [permutation...]; '#' starts
+// a comment. Each permutation is a feature bitmask (decimal or 0x hex) and
+// is built as its own variant; none means permutation 0. Files are relative
+// to the manifest's directory.
+// On Linux:
+//   g++ -O2 -std=c++17 ShaderBuildTool.cpp ShaderArchive.cpp -o ShaderBuildTool
+#include "ShaderArchive.h"
+#include "ShaderPermutation.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+static bool ReadFile(const std::string& path, std::vector<uint8_t>& out)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return false;
+    out.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return true;
+}
+
+static std::string DirectoryOf(const std::string& path)
+{
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        printf("usage: %s <manifest.txt> <output.bin> [dxc]\n", argv[0]);
+        return 1;
+    }
+
+    const std::string manifestPath = argv[1];
+    const std::string outputPath = argv[2];
+    const std::string dxc = argc > 3 ? argv[3] : "dxc";
+    const std::string sourceDir = DirectoryOf(manifestPath);
+
+    std::ifstream manifest(manifestPath);
+    if (!manifest)
+    {
+        printf("failed to open %s\n", manifestPath.c_str());
+        return 1;
+    }
+
+    const std::string objPath = outputPath + ".tmp.dxil";
+    const std::string reflPath = outputPath + ".tmp.refl";
+
+    ShaderArchive archive;
+    std::string line;
+    int failures = 0;
+
+    while (std::getline(manifest, line))
+    {
+        line = line.substr(0, line.find('#'));
+
+        std::istringstream fields(line);
+        std::string file, entry, profile;
+        if (!(fields >> file >> entry >> profile))
+            continue;
+
+        std::vector<PermutationKey> permutations;
+        std::string perm;
+        while (fields >> perm)
+            permutations.push_back((PermutationKey)std::stoul(perm, nullptr, 0));
+        if (permutations.empty())
+            permutations.push_back(0);
+
+        for (PermutationKey key : permutations)
+        {
+            // A compile that writes no reflection must not pick up the
+            // previous entry's; start each one without output files.
+            std::remove(objPath.c_str());
+            std::remove(reflPath.c_str());
+
+            // Reflection goes to its own blob and is stripped from the bytecode.
+            std::string cmd = "\"" + dxc + "\" -nologo -O3 -Qstrip_debug -Qstrip_reflect"
+                " -T " + profile + " -E " + entry + PermutationDefineArgs(key) +
+                " -Fo \"" + objPath + "\" -Fre \"" + reflPath + "\"" +
+                " \"" + sourceDir + file + "\"";
+
+            std::vector<uint8_t> bytecode, reflection;
+            if (std::system(cmd.c_str()) != 0 || !ReadFile(objPath, bytecode))
+            {
+                printf("FAILED %s %s %s [0x%x]\n", file.c_str(), entry.c_str(), profile.c_str(), key);
+                ++failures;
+                continue;
+            }
+            ReadFile(reflPath, reflection);
+
+            archive.Add(MakeShaderKey(file.c_str(), entry.c_str(), profile.c_str(), key), bytecode, reflection);
+            printf("%s %s %s [0x%x]: %zu bytes, %zu reflection\n",
+                file.c_str(), entry.c_str(), profile.c_str(), key, bytecode.size(), reflection.size());
+        }
+    }
+
+    std::remove(objPath.c_str());
+    std::remove(reflPath.c_str());
+
+    if (failures > 0)
+        return 1;
+
+    std::ofstream out(outputPath, std::ios::binary);
+    if (!out)
+    {
+        printf("failed to open %s\n", outputPath.c_str());
+        return 1;
+    }
+    archive.Write(out);
+
+    printf("%zu shaders, %zu bytes\n", archive.Count(), archive.DataBytes());
+    return 0;
+}
@@ -0,0 +1,56 @@
+// ShaderPermutation.h
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Material features that select a shader variant at build time instead of
+// branching per pixel. A permutation key is a bitmask of these; each set bit
+// becomes "#define <name> 1" and each clear bit "<name> 0".
+enum ShaderFeature : uint32_t
+{
+    Feature_Specular    = 1u << 0,
+    Feature_AlphaTest   = 1u << 1,
+    Feature_HemiAmbient = 1u << 2,
+};
+
+static const uint32_t ShaderFeatureCount = 3;
+
+using PermutationKey = uint32_t;
+
+constexpr const char* ShaderFeatureDefine(uint32_t bit)
+{
+    return bit == 0 ? "USE_SPECULAR" :
+           bit == 1 ? "USE_ALPHA_TEST" :
+           bit == 2 ? "USE_HEMI_AMBIENT" : "";
+}
+
+// Only the pixel shader reads the features today; masking per stage keeps
+// the vertex shader to a single variant.
+constexpr PermutationKey VertexFeatureMask = 0;
+constexpr PermutationKey PixelFeatureMask = Feature_Specular | Feature_AlphaTest | Feature_HemiAmbient;
+
+constexpr PermutationKey MakePermutation(uint32_t features, PermutationKey stageMask)
+{
+    return features & stageMask;
+}
+
+static_assert(MakePermutation(Feature_Specular | Feature_AlphaTest, VertexFeatureMask) == 0,
+    "vertex shaders have no feature variants");
+
+// Name/value pairs for every feature, for D3D_SHADER_MACRO arrays.
+inline void PermutationDefines(PermutationKey key, std::vector<std::pair<const char*, const char*>>& out)
+{
+    out.clear();
+    for (uint32_t bit = 0; bit < ShaderFeatureCount; ++bit)
+        out.emplace_back(ShaderFeatureDefine(bit), (key & (1u << bit)) ? "1" : "0");
+}
+
+// The same defines as DXC command line arguments.
+inline std::string PermutationDefineArgs(PermutationKey key)
+{
+    std::string args;
+    for (uint32_t bit = 0; bit < ShaderFeatureCount; ++bit)
+        args += std::string(" -D ") + ShaderFeatureDefine(bit) + ((key & (1u << bit)) ? "=1" : "=0");
+    return args;
+}
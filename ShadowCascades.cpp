@@ -0,0 +1,159 @@
+// ShadowCascades.cpp
+#include "ShadowCascades.h"
+#include <algorithm>
+#include <chrono>
+
+static Mat4 LookToLH(const Vec3& dir, const Vec3& upHint)
+{
+    // Light space is anchored at the world origin so texel snapping is not
+    // disturbed by the eye position.
+    Vec3 f = Normalize(dir);
+    Vec3 up = std::fabs(Dot(f, upHint)) > 0.99f ? Vec3{ 1.0f, 0.0f, 0.0f } : upHint;
+    Vec3 r = Normalize(Cross(up, f));
+    Vec3 u = Cross(f, r);
+
+    Mat4 m = { { { r.x, u.x, f.x, 0.0f },
+                 { r.y, u.y, f.y, 0.0f },
+                 { r.z, u.z, f.z, 0.0f },
+                 { 0.0f, 0.0f, 0.0f, 1.0f } } };
+    return m;
+}
+
+static Mat4 OrthoOffCenterLH(float l, float r, float b, float t, float zn, float zf)
+{
+    Mat4 m = { { { 2.0f / (r - l), 0.0f, 0.0f, 0.0f },
+                 { 0.0f, 2.0f / (t - b), 0.0f, 0.0f },
+                 { 0.0f, 0.0f, 1.0f / (zf - zn), 0.0f },
+                 { (l + r) / (l - r), (t + b) / (b - t), zn / (zn - zf), 1.0f } } };
+    return m;
+}
+
+float ShadowCascades::PracticalSplit(float nearZ, float farZ, float lambda, uint32_t i, uint32_t count)
+{
+    float p = (float)i / (float)count;
+    float logSplit = nearZ * std::pow(farZ / nearZ, p);
+    float uniSplit = nearZ + (farZ - nearZ) * p;
+    return lambda * logSplit + (1.0f - lambda) * uniSplit;
+}
+
+void ShadowCascades::Fit(const CascadeCamera& camera, const Vec3& lightDir, const Aabb& sceneBounds)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    mCount = (std::min)((std::max)(mSettings.CascadeCount, 1u), MaxCascades);
+    const float farZ = mSettings.MaxDistance > 0.0f ? (std::min)(mSettings.MaxDistance, camera.FarZ) : camera.FarZ;
+    const float mapSize = (float)mSettings.ShadowMapSize;
+
+    const Vec3 fwd = Normalize(camera.Forward);
+    const Vec3 right = Normalize(Cross(camera.Up, fwd));
+    const Vec3 up = Cross(fwd, right);
+    const float tanY = std::tan(camera.FovY * 0.5f);
+    const float tanX = tanY * camera.Aspect;
+
+    const Mat4 lightView = LookToLH(lightDir, Vec3{ 0.0f, 1.0f, 0.0f });
+
+    // Scene bounds in light space bound both the caster depth range and the slice footprint.
+    Aabb sceneLs = Aabb::Empty();
+    for (int c = 0; c < 8; ++c)
+    {
+        Vec3 p = { (c & 1) ? sceneBounds.Max.x : sceneBounds.Min.x,
+                   (c & 2) ? sceneBounds.Max.y : sceneBounds.Min.y,
+                   (c & 4) ? sceneBounds.Max.z : sceneBounds.Min.z };
+        sceneLs.Grow(TransformPoint(p, lightView));
+    }
+
+    float efficiencySum = 0.0f;
+    for (uint32_t i = 0; i < mCount; ++i)
+    {
+        Cascade& cs = mCascades[i];
+        cs.SplitNear = PracticalSplit(camera.NearZ, farZ, mSettings.Lambda, i, mCount);
+        cs.SplitFar = PracticalSplit(camera.NearZ, farZ, mSettings.Lambda, i + 1, mCount);
+
+        Vec3 corners[8];
+        for (int c = 0; c < 8; ++c)
+        {
+            float z = (c & 4) ? cs.SplitFar : cs.SplitNear;
+            float x = ((c & 1) ? 1.0f : -1.0f) * tanX * z;
+            float y = ((c & 2) ? 1.0f : -1.0f) * tanY * z;
+            corners[c] = camera.Position + fwd * z + right * x + up * y;
+        }
+
+        Aabb sliceLs = Aabb::Empty();
+        for (const Vec3& p : corners)
+            sliceLs.Grow(TransformPoint(p, lightView));
+
+        // Footprint that actually needs shadow texels: slice clipped to the scene.
+        Aabb footprint = { MaxVec(sliceLs.Min, sceneLs.Min), MinVec(sliceLs.Max, sceneLs.Max) };
+        bool empty = footprint.Min.x >= footprint.Max.x || footprint.Min.y >= footprint.Max.y;
+
+        float minX, maxX, minY, maxY;
+        if (mSettings.Stable)
+        {
+            // Bounding sphere of the slice: its radius does not change as the
+            // camera turns, so the texel size stays fixed.
+            Vec3 center = { 0.0f, 0.0f, 0.0f };
+            for (const Vec3& p : corners)
+                center = center + p;
+            center = center * 0.125f;
+
+            float radius = 0.0f;
+            for (const Vec3& p : corners)
+                radius = (std::max)(radius, Length(p - center));
+            radius = std::ceil(radius * 16.0f) / 16.0f;
+
+            // Snapping can move the box down by up to a texel, so the
+            // diameter spans one texel less than the map and the box, a
+            // whole map wide, still reaches past the sphere on the max side.
+            float texel = 2.0f * radius / (std::max)(mapSize - 1.0f, 1.0f);
+            Vec3 c = TransformPoint(center, lightView);
+            minX = std::floor((c.x - radius) / texel) * texel;
+            minY = std::floor((c.y - radius) / texel) * texel;
+            maxX = minX + texel * mapSize;
+            maxY = minY + texel * mapSize;
+        }
+        else
+        {
+            Aabb fit = empty ? sliceLs : footprint;
+            float size = (std::max)(fit.Max.x - fit.Min.x, fit.Max.y - fit.Min.y);
+            float texel = (std::max)(size, 1e-3f) / mapSize;
+            minX = std::floor(fit.Min.x / texel) * texel;
+            minY = std::floor(fit.Min.y / texel) * texel;
+            maxX = std::ceil(fit.Max.x / texel) * texel;
+            maxY = std::ceil(fit.Max.y / texel) * texel;
+        }
+
+        // Casters anywhere between the light and the slice must be in range.
+        float minZ = sceneLs.Min.z;
+        float maxZ = (std::min)(sliceLs.Max.z, sceneLs.Max.z);
+        if (maxZ <= minZ)
+            maxZ = minZ + 1.0f;
+
+        cs.LightView = lightView;
+        cs.LightProj = OrthoOffCenterLH(minX, maxX, minY, maxY, minZ, maxZ);
+        cs.LightViewProj = Mul(cs.LightView, cs.LightProj);
+        cs.TexelWorldSize = (std::max)(maxX - minX, maxY - minY) / mapSize;
+
+        float area = (maxX - minX) * (maxY - minY);
+        float used = empty ? 0.0f : (footprint.Max.x - footprint.Min.x) * (footprint.Max.y - footprint.Min.y);
+        cs.FitEfficiency = area > 0.0f ? (std::min)(used / area, 1.0f) : 0.0f;
+        efficiencySum += cs.FitEfficiency;
+    }
+
+    mStats.FitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    mStats.AverageEfficiency = efficiencySum / (float)mCount;
+}
+
+void ShadowCascades::CullCasters(CullPipeline& cull, const SceneOctree& scene, const Sphere* bounds)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    mStats.TotalCasters = 0;
+    for (uint32_t i = 0; i < mCount; ++i)
+    {
+        Cascade& cs = mCascades[i];
+        cull.CullFrustum(scene, Frustum::FromViewProj(cs.LightViewProj), bounds, cs.Casters);
+        mStats.TotalCasters += (uint32_t)cs.Casters.size();
+    }
+
+    mStats.CullMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,74 @@
+// ShadowCascades.h
+#pragma once
+#include "CullPipeline.h"
+
+struct CascadeCamera
+{
+    Vec3  Position;
+    Vec3  Forward;
+    Vec3  Up;
+    float FovY;
+    float Aspect;
+    float NearZ;
+    float FarZ;
+};
+
+struct CascadeSettings
+{
+    uint32_t CascadeCount = 4;
+    float    Lambda = 0.8f;          // 0 = uniform splits, 1 = logarithmic
+    float    MaxDistance = 0.0f;     // 0 = camera far plane
+    uint32_t ShadowMapSize = 2048;
+    bool     Stable = true;          // sphere fit + texel snapping, no shimmer on rotation
+};
+
+struct Cascade
+{
+    float SplitNear;
+    float SplitFar;
+
+    Mat4  LightView;
+    Mat4  LightProj;
+    Mat4  LightViewProj;
+
+    float TexelWorldSize;
+    float FitEfficiency;  // slice footprint / shadow map footprint, 1 is perfect
+
+    std::vector<uint32_t> Casters;
+};
+
+struct CascadeStats
+{
+    double   FitMs = 0.0;
+    double   CullMs = 0.0;
+    float    AverageEfficiency = 0.0f;
+    uint32_t TotalCasters = 0;
+};
+
+// CPU side of cascaded shadow maps: practical split scheme, light
+// projections fitted to each slice clipped against the scene bounds, and
+// caster culling per cascade with the cull pipeline's frustum kernel.
+class ShadowCascades
+{
+public:
+    static const uint32_t MaxCascades = 8;
+
+    void SetSettings(const CascadeSettings& settings) { mSettings = settings; }
+    const CascadeSettings& GetSettings() const { return mSettings; }
+
+    void Fit(const CascadeCamera& camera, const Vec3& lightDir, const Aabb& sceneBounds);
+    void CullCasters(CullPipeline& cull, const SceneOctree& scene, const Sphere* bounds);
+
+    uint32_t       CascadeCount() const { return mCount; }
+    const Cascade& GetCascade(uint32_t i) const { return mCascades[i]; }
+    const CascadeStats& GetStats() const { return mStats; }
+
+    static float PracticalSplit(float nearZ, float farZ, float lambda, uint32_t i, uint32_t count);
+
+private:
+    CascadeSettings mSettings;
+    CascadeStats    mStats;
+
+    uint32_t mCount = 0;
+    Cascade  mCascades[MaxCascades];
+};
@@ -0,0 +1,187 @@
+// ShadowCascadesCheck.cpp
+// Checks for ShadowCascades fitted headlessly: ShadowCascadesCheck
+// Fits cascades for a few camera poses in both modes and checks the fitted
+// volumes: splits increasing and tiling near to far, every slice's frustum
+// corners inside its light projection, and in stable mode a texel size that
+// survives rotation and an origin that stays on the texel grid, unmoved by
+// a sub-texel camera move.
+// Standard library only; on Linux:
+//   g++ -O2 -std=c++17 ShadowCascadesCheck.cpp ShadowCascades.cpp CullPipeline.cpp SceneOctree.cpp -o ShadowCascadesCheck
+#include "ShadowCascades.h"
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+    int gFailures = 0;
+
+    void Check(bool ok, const char* what, double a = 0, double b = 0)
+    {
+        if (!ok && gFailures++ < 10)
+            printf("FAIL: %s (%g, %g)\n", what, a, b);
+    }
+
+    const Vec3 LightDir = { 0.4f, -1.0f, 0.3f };
+
+    // Large enough to hold every slice, so nothing is clipped to the scene.
+    const Aabb World = { { -1000.0f, -1000.0f, -1000.0f }, { 1000.0f, 1000.0f, 1000.0f } };
+
+    CascadeCamera MakeCamera(const Vec3& position, float yaw)
+    {
+        CascadeCamera camera;
+        camera.Position = position;
+        camera.Forward = { std::sin(yaw), -0.2f, std::cos(yaw) };
+        camera.Up = { 0.0f, 1.0f, 0.0f };
+        camera.FovY = 1.0f;
+        camera.Aspect = 16.0f / 9.0f;
+        camera.NearZ = 0.1f;
+        camera.FarZ = 400.0f;
+        return camera;
+    }
+
+    // Same slice corners as the fit: left-handed, right = up x forward.
+    void SliceCorners(const CascadeCamera& camera, float nearZ, float farZ, Vec3 corners[8])
+    {
+        const Vec3 fwd = Normalize(camera.Forward);
+        const Vec3 right = Normalize(Cross(camera.Up, fwd));
+        const Vec3 up = Cross(fwd, right);
+        const float tanY = std::tan(camera.FovY * 0.5f);
+        const float tanX = tanY * camera.Aspect;
+        for (int c = 0; c < 8; ++c)
+        {
+            float z = (c & 4) ? farZ : nearZ;
+            float x = ((c & 1) ? 1.0f : -1.0f) * tanX * z;
+            float y = ((c & 2) ? 1.0f : -1.0f) * tanY * z;
+            corners[c] = camera.Position + fwd * z + right * x + up * y;
+        }
+    }
+
+    // Light-space x of the projection's left edge; the ortho matrix maps it to -1.
+    float ProjLeft(const Mat4& proj) { return (-1.0f - proj.m[3][0]) / proj.m[0][0]; }
+    float ProjBottom(const Mat4& proj) { return (-1.0f - proj.m[3][1]) / proj.m[1][1]; }
+
+    void Splits(const CascadeCamera& camera, float maxDistance)
+    {
+        ShadowCascades cascades;
+        CascadeSettings settings;
+        settings.CascadeCount = 4;
+        settings.MaxDistance = maxDistance;
+        cascades.SetSettings(settings);
+        cascades.Fit(camera, LightDir, World);
+
+        const float farZ = maxDistance > 0.0f ? maxDistance : camera.FarZ;
+        Check(cascades.CascadeCount() == 4, "cascade count", cascades.CascadeCount());
+        Check(std::fabs(cascades.GetCascade(0).SplitNear - camera.NearZ) < 1e-5f, "first split at near",
+              cascades.GetCascade(0).SplitNear);
+        Check(std::fabs(cascades.GetCascade(3).SplitFar - farZ) < farZ * 1e-5f, "last split at far",
+              cascades.GetCascade(3).SplitFar, farZ);
+        for (uint32_t i = 0; i < cascades.CascadeCount(); ++i)
+        {
+            const Cascade& cs = cascades.GetCascade(i);
+            Check(cs.SplitFar > cs.SplitNear, "split increases", i, cs.SplitFar - cs.SplitNear);
+            if (i > 0)
+                Check(cs.SplitNear == cascades.GetCascade(i - 1).SplitFar, "slices tile", i);
+        }
+
+        // Lambda 0 is uniform.
+        Check(std::fabs(ShadowCascades::PracticalSplit(1.0f, 101.0f, 0.0f, 1, 4) - 26.0f) < 1e-4f, "uniform split");
+        Check(std::fabs(ShadowCascades::PracticalSplit(1.0f, 100.0f, 1.0f, 2, 4) - 10.0f) < 1e-4f, "log split");
+    }
+
+    void Containment(const CascadeCamera& camera, bool stable)
+    {
+        ShadowCascades cascades;
+        CascadeSettings settings;
+        settings.Stable = stable;
+        settings.ShadowMapSize = 1024;
+        cascades.SetSettings(settings);
+        cascades.Fit(camera, LightDir, World);
+
+        const float eps = 1e-4f;
+        for (uint32_t i = 0; i < cascades.CascadeCount(); ++i)
+        {
+            const Cascade& cs = cascades.GetCascade(i);
+            Vec3 corners[8];
+            SliceCorners(camera, cs.SplitNear, cs.SplitFar, corners);
+            for (const Vec3& p : corners)
+            {
+                Vec3 ndc = TransformPoint(p, cs.LightViewProj);
+                bool inside = ndc.x >= -1.0f - eps && ndc.x <= 1.0f + eps &&
+                              ndc.y >= -1.0f - eps && ndc.y <= 1.0f + eps &&
+                              ndc.z >= -eps && ndc.z <= 1.0f + eps;
+                Check(inside, stable ? "stable: corner inside light volume" : "tight: corner inside light volume", i,
+                      (std::max)(std::fabs(ndc.x), std::fabs(ndc.y)));
+            }
+            Check(cs.FitEfficiency > 0.0f && cs.FitEfficiency <= 1.0f, "efficiency in range", cs.FitEfficiency);
+        }
+    }
+
+    void Stability()
+    {
+        CascadeSettings settings;
+        settings.ShadowMapSize = 1024;
+
+        ShadowCascades base;
+        base.SetSettings(settings);
+        const CascadeCamera camera = MakeCamera({ 12.3f, 20.0f, -7.9f }, 0.3f);
+        base.Fit(camera, LightDir, World);
+
+        // Turning in place keeps each slice's sphere, so the texel size holds.
+        ShadowCascades turned;
+        turned.SetSettings(settings);
+        turned.Fit(MakeCamera(camera.Position, 1.4f), LightDir, World);
+
+        // Light-space x in world space is the first column of the light view.
+        const Mat4& view = base.GetCascade(0).LightView;
+        const Vec3 lightRight = { view.m[0][0], view.m[1][0], view.m[2][0] };
+
+        for (uint32_t i = 0; i < base.CascadeCount(); ++i)
+        {
+            const Cascade& cs = base.GetCascade(i);
+            const float texel = cs.TexelWorldSize;
+            Check(std::fabs(turned.GetCascade(i).TexelWorldSize - texel) <= texel * 1e-4f, "texel size survives rotation",
+                  i, turned.GetCascade(i).TexelWorldSize - texel);
+
+            const float left = ProjLeft(cs.LightProj);
+            const float bottom = ProjBottom(cs.LightProj);
+            const float cellX = left / texel;
+            const float cellY = bottom / texel;
+            Check(std::fabs(cellX - std::round(cellX)) < 1e-2f && std::fabs(cellY - std::round(cellY)) < 1e-2f,
+                  "origin on the texel grid", cellX, cellY);
+
+            // A quarter texel either way: both stay within a texel, and at
+            // least one leaves the snapped origin where it was.
+            bool unmoved = false;
+            for (float dir : { 0.25f, -0.25f })
+            {
+                ShadowCascades moved;
+                moved.SetSettings(settings);
+                moved.Fit(MakeCamera(camera.Position + lightRight * (dir * texel), 0.3f), LightDir, World);
+                const Cascade& m = moved.GetCascade(i);
+                const float shift = (ProjLeft(m.LightProj) - left) / texel;
+                Check(std::fabs(shift) < 1e-2f || std::fabs(std::fabs(shift) - 1.0f) < 1e-2f, "origin moves in whole texels",
+                      i, shift);
+                Check(std::fabs(ProjBottom(m.LightProj) - bottom) < texel * 1e-2f, "no move across the light's y", i);
+                unmoved |= std::fabs(shift) < 1e-2f;
+            }
+            Check(unmoved, "sub-texel move leaves the origin", i);
+        }
+    }
+}
+
+int main()
+{
+    Splits(MakeCamera({ 0.0f, 5.0f, 0.0f }, 0.0f), 0.0f);
+    Splits(MakeCamera({ 0.0f, 5.0f, 0.0f }, 0.0f), 150.0f);
+
+    const float yaws[] = { 0.0f, 0.7f, 2.1f, -2.8f };
+    for (float yaw : yaws)
+    {
+        Containment(MakeCamera({ 30.0f, 12.0f, -45.0f }, yaw), true);
+        Containment(MakeCamera({ 30.0f, 12.0f, -45.0f }, yaw), false);
+    }
+    Stability();
+
+    printf("%s\n", gFailures == 0 ? "passed" : "FAILED");
+    return gFailures == 0 ? 0 : 1;
+}
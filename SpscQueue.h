@@ -0,0 +1,65 @@
+// SpscQueue.h
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. Each side caches the other's index and only reloads it when the
+// queue looks full or empty, so the shared cache lines move rarely.
+template <typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(uint32_t capacity) // power of two
+        : mItems(new T[capacity])
+        , mMask(capacity - 1)
+    {
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer. False when full; the item is not queued.
+    bool TryPush(const T& item)
+    {
+        const uint64_t tail = mTail.load(std::memory_order_relaxed);
+        if (tail - mCachedHead > mMask)
+        {
+            mCachedHead = mHead.load(std::memory_order_acquire);
+            if (tail - mCachedHead > mMask)
+                return false;
+        }
+        mItems[tail & mMask] = item;
+        mTail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer. The oldest item, or null when empty; valid until Pop.
+    const T* Front()
+    {
+        const uint64_t head = mHead.load(std::memory_order_relaxed);
+        if (head == mCachedTail)
+        {
+            mCachedTail = mTail.load(std::memory_order_acquire);
+            if (head == mCachedTail)
+                return nullptr;
+        }
+        return &mItems[head & mMask];
+    }
+
+    // Consumer, after a non-null Front.
+    void Pop()
+    {
+        mHead.store(mHead.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+private:
+    std::unique_ptr<T[]> mItems;
+    const uint64_t mMask;
+
+    alignas(64) std::atomic<uint64_t> mHead{ 0 };  // consumer writes
+    uint64_t mCachedTail = 0;                       // consumer's view of mTail
+    alignas(64) std::atomic<uint64_t> mTail{ 0 };  // producer writes
+    uint64_t mCachedHead = 0;                       // producer's view of mHead
+};
@@ -24,6 +24,18 @@ float GameTimer::TotalTime() const
         return (float)(((mCurrTime - mPausedTime) - mBaseTime) * mSecondsPerCount);
 }
 
+__int64 GameTimer::Counter()
+{
+    __int64 counter;
+    QueryPerformanceCounter((LARGE_INTEGER*)&counter);
+    return counter;
+}
+
+double GameTimer::TimeAt(__int64 counter) const
+{
+    return ((counter - mPausedTime) - mBaseTime) * mSecondsPerCount;
+}
+
 float GameTimer::DeltaTime() const
 {
     return (float)mDeltaTime;
@@ -15,6 +15,13 @@ public:
     void Stop();  
     void Tick();  
 
+    // Performance counter, callable from any thread, for stamping events
+    // that happen between ticks.
+    static __int64 Counter();
+    // The counter value of the last Tick, and TotalTime at a Counter() value.
+    __int64 TickCounter() const { return mCurrTime; }
+    double  TimeAt(__int64 counter) const;
+
 private:
     double      mSecondsPerCount;
     double      mDeltaTime;
@@ -0,0 +1,345 @@
+// TlsfAllocator.cpp
+#include "TlsfAllocator.h"
+#include <stdexcept>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static uint32_t Fls64(uint64_t v)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, v);
+    return (uint32_t)index;
+#else
+    return 63u - (uint32_t)__builtin_clzll(v);
+#endif
+}
+
+static uint32_t Ffs32(uint32_t v)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, v);
+    return (uint32_t)index;
+#else
+    return (uint32_t)__builtin_ctz(v);
+#endif
+}
+
+static uint32_t Ffs64(uint64_t v)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, v);
+    return (uint32_t)index;
+#else
+    return (uint32_t)__builtin_ctzll(v);
+#endif
+}
+
+static uint64_t AlignUp(uint64_t v, uint64_t a)
+{
+    return (v + a - 1) / a * a;
+}
+
+const TlsfAllocator::Handle TlsfAllocator::InvalidHandle;
+
+TlsfAllocator::TlsfAllocator(uint64_t capacity, uint64_t granularity)
+    : mCapacity(capacity / granularity * granularity)
+    , mGranularity(granularity)
+{
+    for (auto& row : mHeads)
+        for (uint32_t& h : row)
+            h = Null;
+
+    if (mCapacity == 0)
+        return;
+
+    uint32_t b = NewBlock();
+    mBlocks[b].Offset = 0;
+    mBlocks[b].Size = mCapacity;
+    InsertFree(b);
+}
+
+void TlsfAllocator::Mapping(uint64_t size, uint32_t& fl, uint32_t& sl)
+{
+    if (size < SlCount)
+    {
+        fl = 0;
+        sl = (uint32_t)size;
+        return;
+    }
+    fl = Fls64(size);
+    sl = (uint32_t)(size >> (fl - SlLog2)) ^ SlCount;
+    fl -= SlLog2 - 1;
+}
+
+uint32_t TlsfAllocator::NewBlock()
+{
+    uint32_t b;
+    if (!mFreeSlots.empty())
+    {
+        b = mFreeSlots.back();
+        mFreeSlots.pop_back();
+        mBlocks[b] = Block();
+    }
+    else
+    {
+        b = (uint32_t)mBlocks.size();
+        mBlocks.emplace_back();
+    }
+    mBlocks[b].Live = true;
+    return b;
+}
+
+void TlsfAllocator::ReleaseBlock(uint32_t b)
+{
+    mBlocks[b].Live = false;
+    mFreeSlots.push_back(b);
+}
+
+void TlsfAllocator::InsertFree(uint32_t b)
+{
+    Block& blk = mBlocks[b];
+    uint32_t fl, sl;
+    Mapping(blk.Size, fl, sl);
+
+    blk.Free = true;
+    blk.PrevFree = Null;
+    blk.NextFree = mHeads[fl][sl];
+    if (blk.NextFree != Null)
+        mBlocks[blk.NextFree].PrevFree = b;
+    mHeads[fl][sl] = b;
+
+    mFlBitmap |= 1ULL << fl;
+    mSlBitmap[fl] |= 1u << sl;
+}
+
+void TlsfAllocator::RemoveFree(uint32_t b)
+{
+    Block& blk = mBlocks[b];
+    uint32_t fl, sl;
+    Mapping(blk.Size, fl, sl);
+
+    if (blk.PrevFree != Null)
+        mBlocks[blk.PrevFree].NextFree = blk.NextFree;
+    else
+        mHeads[fl][sl] = blk.NextFree;
+    if (blk.NextFree != Null)
+        mBlocks[blk.NextFree].PrevFree = blk.PrevFree;
+
+    if (mHeads[fl][sl] == Null)
+    {
+        mSlBitmap[fl] &= ~(1u << sl);
+        if (mSlBitmap[fl] == 0)
+            mFlBitmap &= ~(1ULL << fl);
+    }
+
+    blk.Free = false;
+    blk.PrevFree = blk.NextFree = Null;
+}
+
+uint32_t TlsfAllocator::FindFree(uint64_t size)
+{
+    // Round up to the next list boundary so any block found is big enough.
+    if (size >= SlCount)
+        size += (1ULL << (Fls64(size) - SlLog2)) - 1;
+
+    uint32_t fl, sl;
+    Mapping(size, fl, sl);
+    if (fl >= FlCount)
+        return Null;
+
+    uint32_t slMap = mSlBitmap[fl] & (~0u << sl);
+    if (slMap == 0)
+    {
+        uint64_t flMap = (fl + 1 < FlCount) ? (mFlBitmap & (~0ULL << (fl + 1))) : 0;
+        if (flMap == 0)
+            return Null;
+        fl = Ffs64(flMap);
+        slMap = mSlBitmap[fl];
+    }
+    sl = Ffs32(slMap);
+    return mHeads[fl][sl];
+}
+
+uint32_t TlsfAllocator::SplitFront(uint32_t b, uint64_t frontSize)
+{
+    // Cuts [offset, offset + frontSize) off b into a new block that precedes it.
+    uint32_t f = NewBlock();
+    Block& blk = mBlocks[b];
+    Block& front = mBlocks[f];
+
+    front.Offset = blk.Offset;
+    front.Size = frontSize;
+    front.PrevPhys = blk.PrevPhys;
+    front.NextPhys = b;
+    if (front.PrevPhys != Null)
+        mBlocks[front.PrevPhys].NextPhys = f;
+
+    blk.Offset += frontSize;
+    blk.Size -= frontSize;
+    blk.PrevPhys = f;
+    return f;
+}
+
+uint32_t TlsfAllocator::MergeWithNeighbours(uint32_t b)
+{
+    uint32_t prev = mBlocks[b].PrevPhys;
+    if (prev != Null && mBlocks[prev].Free)
+    {
+        RemoveFree(prev);
+        mBlocks[prev].Size += mBlocks[b].Size;
+        mBlocks[prev].NextPhys = mBlocks[b].NextPhys;
+        if (mBlocks[b].NextPhys != Null)
+            mBlocks[mBlocks[b].NextPhys].PrevPhys = prev;
+        ReleaseBlock(b);
+        b = prev;
+    }
+
+    uint32_t next = mBlocks[b].NextPhys;
+    if (next != Null && mBlocks[next].Free)
+    {
+        RemoveFree(next);
+        mBlocks[b].Size += mBlocks[next].Size;
+        mBlocks[b].NextPhys = mBlocks[next].NextPhys;
+        if (mBlocks[next].NextPhys != Null)
+            mBlocks[mBlocks[next].NextPhys].PrevPhys = b;
+        ReleaseBlock(next);
+    }
+    return b;
+}
+
+TlsfAllocator::Handle TlsfAllocator::Allocate(uint64_t size, uint64_t alignment)
+{
+    if (size == 0)
+        size = 1;
+    size = AlignUp(size, mGranularity);
+    alignment = alignment > mGranularity ? AlignUp(alignment, mGranularity) : mGranularity;
+
+    const uint64_t search = size + (alignment > mGranularity ? alignment - mGranularity : 0);
+    uint32_t b = FindFree(search);
+    if (b == Null)
+        return InvalidHandle;
+
+    RemoveFree(b);
+
+    uint64_t pad = AlignUp(mBlocks[b].Offset, alignment) - mBlocks[b].Offset;
+    if (pad > 0)
+    {
+        uint32_t front = SplitFront(b, pad);
+        InsertFree(front);
+    }
+
+    if (mBlocks[b].Size > size)
+    {
+        // Keep the allocation at the front and return the tail to the free lists.
+        uint32_t used = SplitFront(b, size);
+        InsertFree(b);
+        b = used;
+    }
+
+    mBlocks[b].Free = false;
+    mBlocks[b].Alignment = alignment;
+    mUsed += mBlocks[b].Size;
+    mAllocations++;
+    return b;
+}
+
+void TlsfAllocator::Free(Handle handle)
+{
+    if (handle >= mBlocks.size() || !mBlocks[handle].Live || mBlocks[handle].Free)
+        throw std::logic_error("TlsfAllocator::Free on an invalid handle");
+
+    mUsed -= mBlocks[handle].Size;
+    mAllocations--;
+
+    uint32_t b = MergeWithNeighbours(handle);
+    InsertFree(b);
+}
+
+TlsfStats TlsfAllocator::GetStats() const
+{
+    TlsfStats s;
+    s.Capacity = mCapacity;
+    s.Used = mUsed;
+    s.Allocations = mAllocations;
+
+    for (const Block& b : mBlocks)
+    {
+        if (b.Live && b.Free)
+        {
+            s.FreeBlocks++;
+            if (b.Size > s.LargestFree)
+                s.LargestFree = b.Size;
+        }
+    }
+    return s;
+}
+
+uint32_t TlsfAllocator::Defragment(const std::function<void(Handle, uint64_t, uint64_t, uint64_t)>& move,
+                                   uint32_t maxMoves)
+{
+    if (mBlocks.empty())
+        return 0;
+
+    // Find the physically first block.
+    uint32_t b = 0;
+    while (!mBlocks[b].Live)
+        ++b;
+    while (mBlocks[b].PrevPhys != Null)
+        b = mBlocks[b].PrevPhys;
+
+    uint32_t moves = 0;
+    while (b != Null && moves < maxMoves)
+    {
+        uint32_t next = mBlocks[b].NextPhys;
+        uint32_t prev = mBlocks[b].PrevPhys;
+
+        if (!mBlocks[b].Free && prev != Null && mBlocks[prev].Free &&
+            AlignUp(mBlocks[prev].Offset, mBlocks[b].Alignment) + mBlocks[b].Size <= mBlocks[b].Offset)
+        {
+            const uint64_t size = mBlocks[b].Size;
+            const uint64_t from = mBlocks[b].Offset;
+            const uint64_t to = AlignUp(mBlocks[prev].Offset, mBlocks[b].Alignment);
+
+            // Swap roles: the allocation moves to the first aligned offset in
+            // the free block, the space it leaves behind joins whatever was
+            // free after it. Padding below the new offset stays free.
+            RemoveFree(prev);
+            if (to > mBlocks[prev].Offset)
+            {
+                uint32_t pad = SplitFront(prev, to - mBlocks[prev].Offset);
+                InsertFree(pad);
+            }
+            uint64_t freeSize = mBlocks[prev].Size;
+
+            mBlocks[b].Offset = to;
+            mBlocks[prev].Offset = to + size;
+            mBlocks[prev].Size = freeSize;
+
+            // Relink physical order: [b][prev]
+            uint32_t before = mBlocks[prev].PrevPhys;
+            mBlocks[b].PrevPhys = before;
+            mBlocks[b].NextPhys = prev;
+            if (before != Null)
+                mBlocks[before].NextPhys = b;
+            mBlocks[prev].PrevPhys = b;
+            mBlocks[prev].NextPhys = next;
+            if (next != Null)
+                mBlocks[next].PrevPhys = prev;
+
+            uint32_t merged = MergeWithNeighbours(prev);
+            InsertFree(merged);
+
+            move(b, from, to, size);
+            ++moves;
+            next = mBlocks[merged].NextPhys;
+        }
+
+        b = next;
+    }
+    return moves;
+}
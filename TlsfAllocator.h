@@ -0,0 +1,98 @@
+// TlsfAllocator.h
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+struct TlsfStats
+{
+    uint64_t Capacity = 0;
+    uint64_t Used = 0;
+    uint64_t LargestFree = 0;
+    uint32_t Allocations = 0;
+    uint32_t FreeBlocks = 0;
+
+    // 0 when all free space is one block, towards 1 as it splinters
+    float Fragmentation() const
+    {
+        uint64_t freeBytes = Capacity - Used;
+        return freeBytes > 0 ? 1.0f - (float)((double)LargestFree / (double)freeBytes) : 0.0f;
+    }
+};
+
+// Two-level segregated fit allocator over an abstract address range
+// [0, capacity). It never touches memory: offsets are handed to the caller,
+// which places resources in a heap, a buffer, or nothing at all. Allocate
+// and Free are O(1): one bitmap scan per level plus constant list work.
+class TlsfAllocator
+{
+public:
+    using Handle = uint32_t;
+    static const Handle InvalidHandle = 0xFFFFFFFFu;
+
+    explicit TlsfAllocator(uint64_t capacity, uint64_t granularity = 256);
+
+    Handle   Allocate(uint64_t size, uint64_t alignment);
+    void     Free(Handle handle);
+
+    uint64_t GetOffset(Handle handle) const { return mBlocks[handle].Offset; }
+    uint64_t GetSize(Handle handle) const { return mBlocks[handle].Size; }
+    uint64_t GetAlignment(Handle handle) const { return mBlocks[handle].Alignment; }
+    uint64_t Capacity() const { return mCapacity; }
+    bool     IsEmpty() const { return mUsed == 0; }
+
+    TlsfStats GetStats() const;
+
+    // Defragmentation hook. Walks allocations in address order and moves
+    // each one into the free block directly below it when that block can
+    // hold it, at the alignment it was allocated with, without overlap.
+    // move(handle, oldOffset, newOffset, size) must relocate the caller's
+    // data; the handle stays valid with its new offset.
+    // Returns the number of moves performed.
+    uint32_t Defragment(const std::function<void(Handle, uint64_t, uint64_t, uint64_t)>& move,
+                        uint32_t maxMoves);
+
+private:
+    static const uint32_t SlLog2 = 4;
+    static const uint32_t SlCount = 1u << SlLog2;
+    static const uint32_t FlCount = 64;
+    static const uint32_t Null = 0xFFFFFFFFu;
+
+    struct Block
+    {
+        uint64_t Offset = 0;
+        uint64_t Size = 0;
+        uint64_t Alignment = 0;   // allocations: what Allocate was asked for
+        uint32_t PrevPhys = Null;
+        uint32_t NextPhys = Null;
+        uint32_t PrevFree = Null;
+        uint32_t NextFree = Null;
+        bool     Free = false;
+        bool     Live = false;
+    };
+
+    static void Mapping(uint64_t size, uint32_t& fl, uint32_t& sl);
+
+    uint32_t NewBlock();
+    void     ReleaseBlock(uint32_t b);
+
+    void     InsertFree(uint32_t b);
+    void     RemoveFree(uint32_t b);
+    uint32_t FindFree(uint64_t size);
+
+    uint32_t SplitFront(uint32_t b, uint64_t frontSize);
+    uint32_t MergeWithNeighbours(uint32_t b);
+
+private:
+    uint64_t mCapacity;
+    uint64_t mGranularity;
+    uint64_t mUsed = 0;
+    uint32_t mAllocations = 0;
+
+    std::vector<Block>    mBlocks;
+    std::vector<uint32_t> mFreeSlots;
+
+    uint64_t mFlBitmap = 0;
+    uint32_t mSlBitmap[FlCount] = {};
+    uint32_t mHeads[FlCount][SlCount];
+};
@@ -0,0 +1,187 @@
+// TlsfAllocatorFuzz.cpp
+// Fuzz test and benchmark: TlsfAllocatorFuzz [iterations] [seed]
+// Random allocates and frees against a shadow list of live ranges, checking
+// bounds, alignment and overlap after every step, then defragments and checks
+// that every allocation kept its alignment. Times Allocate/Free pairs last.
+// Standard library only; on Linux:
+//   g++ -O2 -std=c++17 TlsfAllocatorFuzz.cpp TlsfAllocator.cpp -o TlsfAllocatorFuzz
+#include "TlsfAllocator.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace
+{
+    struct Live
+    {
+        TlsfAllocator::Handle Handle;
+        uint64_t Size;        // as requested
+        uint64_t Alignment;   // as requested
+    };
+
+    int gFailures = 0;
+
+    void Check(bool ok, const char* what, uint64_t a = 0, uint64_t b = 0)
+    {
+        if (!ok)
+        {
+            if (gFailures++ < 10)
+                printf("FAIL: %s (%llu, %llu)\n", what, (unsigned long long)a, (unsigned long long)b);
+        }
+    }
+
+    void Validate(const TlsfAllocator& tlsf, const std::vector<Live>& live)
+    {
+        struct Range { uint64_t Begin, End; };
+        std::vector<Range> ranges;
+        ranges.reserve(live.size());
+        uint64_t used = 0;
+        for (const Live& l : live)
+        {
+            const uint64_t offset = tlsf.GetOffset(l.Handle);
+            const uint64_t size = tlsf.GetSize(l.Handle);
+            Check(size >= l.Size, "block smaller than requested", size, l.Size);
+            Check(offset % l.Alignment == 0, "misaligned", offset, l.Alignment);
+            Check(offset + size <= tlsf.Capacity(), "out of bounds", offset, size);
+            ranges.push_back({ offset, offset + size });
+            used += size;
+        }
+
+        std::sort(ranges.begin(), ranges.end(), [](const Range& a, const Range& b) { return a.Begin < b.Begin; });
+        for (size_t i = 1; i < ranges.size(); ++i)
+            Check(ranges[i - 1].End <= ranges[i].Begin, "overlap", ranges[i - 1].End, ranges[i].Begin);
+
+        TlsfStats s = tlsf.GetStats();
+        Check(s.Used == used, "used bytes", s.Used, used);
+        Check(s.Allocations == live.size(), "allocation count", s.Allocations, live.size());
+        Check(s.LargestFree <= s.Capacity - s.Used, "largest free", s.LargestFree, s.Capacity - s.Used);
+    }
+
+    void Fuzz(uint32_t iterations, uint32_t seed)
+    {
+        const uint64_t granularity = 256;
+        TlsfAllocator tlsf(64ull << 20, granularity);
+        std::vector<Live> live;
+        std::mt19937 rng(seed);
+        uint32_t failedAllocs = 0;
+        uint32_t moves = 0;
+
+        for (uint32_t i = 0; i < iterations; ++i)
+        {
+            const uint32_t op = rng() % 100;
+            if (op < 55 || live.empty())
+            {
+                // Mostly small, sometimes large; alignments 1 byte to 1 MB.
+                const uint64_t size = (rng() % 8 == 0) ? 1 + rng() % (4u << 20) : 1 + rng() % (64u << 10);
+                const uint64_t alignment = 1ull << (rng() % 21);
+                TlsfAllocator::Handle h = tlsf.Allocate(size, alignment);
+                if (h == TlsfAllocator::InvalidHandle)
+                    failedAllocs++;
+                else
+                    live.push_back({ h, size, alignment });
+            }
+            else if (op < 97)
+            {
+                const size_t k = rng() % live.size();
+                tlsf.Free(live[k].Handle);
+                live[k] = live.back();
+                live.pop_back();
+            }
+            else
+            {
+                moves += tlsf.Defragment([&](TlsfAllocator::Handle h, uint64_t from, uint64_t to, uint64_t size)
+                    {
+                        Check(to < from, "defragment moved up", from, to);
+                        Check(tlsf.GetOffset(h) == to, "handle offset after move", tlsf.GetOffset(h), to);
+                        Check(size == tlsf.GetSize(h), "moved size", size, tlsf.GetSize(h));
+                    }, 64);
+            }
+
+            if (i % 64 == 0 || i + 1 == iterations)
+                Validate(tlsf, live);
+        }
+
+        // Drain to a single block: freeing everything must coalesce fully.
+        moves += tlsf.Defragment([](TlsfAllocator::Handle, uint64_t, uint64_t, uint64_t) {}, 0xFFFFFFFFu);
+        Validate(tlsf, live);
+        for (const Live& l : live)
+            tlsf.Free(l.Handle);
+        live.clear();
+        TlsfStats s = tlsf.GetStats();
+        Check(s.Used == 0 && s.FreeBlocks == 1 && s.LargestFree == s.Capacity, "not coalesced", s.FreeBlocks, s.LargestFree);
+
+        printf("fuzz: %u iterations, %u failed allocations, %u defragment moves\n", iterations, failedAllocs, moves);
+    }
+
+    void Directed()
+    {
+        // A range whose size is not a size class: the whole range must still
+        // be allocatable once, e.g. a dedicated heap sized to its resource.
+        {
+            const uint64_t size = (64ull << 20) + (64 << 10);
+            TlsfAllocator tlsf(size, 64 << 10);
+            TlsfAllocator::Handle h = tlsf.Allocate(size, 64 << 10);
+            printf("whole range %llu: %s\n", (unsigned long long)size,
+                   h == TlsfAllocator::InvalidHandle ? "fails (size classes round up)" : "ok");
+        }
+
+        // Defragment must not pull an aligned allocation down to a free
+        // block's unaligned start.
+        {
+            TlsfAllocator tlsf(16 << 20, 256);
+            TlsfAllocator::Handle a = tlsf.Allocate(256, 256);
+            TlsfAllocator::Handle hole = tlsf.Allocate(3 << 20, 256);
+            TlsfAllocator::Handle big = tlsf.Allocate(1 << 20, 1 << 20);
+            tlsf.Free(hole);
+            tlsf.Defragment([](TlsfAllocator::Handle, uint64_t, uint64_t, uint64_t) {}, 16);
+            Check(tlsf.GetOffset(big) % (1 << 20) == 0, "defragment lost alignment", tlsf.GetOffset(big), 1 << 20);
+            Check(tlsf.GetOffset(big) == 1 << 20, "defragment did not move to the aligned slot", tlsf.GetOffset(big), 1 << 20);
+            Check(tlsf.GetAlignment(big) == 1 << 20, "recorded alignment", tlsf.GetAlignment(big), 1 << 20);
+            tlsf.Free(a);
+            tlsf.Free(big);
+            Check(tlsf.GetStats().FreeBlocks == 1, "directed: not coalesced", tlsf.GetStats().FreeBlocks);
+        }
+    }
+
+    void Bench(uint32_t seed)
+    {
+        const uint32_t pairs = 1u << 20;
+        const uint32_t window = 4096;
+        TlsfAllocator tlsf(1ull << 30, 256);
+        std::vector<TlsfAllocator::Handle> ring(window, TlsfAllocator::InvalidHandle);
+        std::vector<uint32_t> sizes(pairs);
+        std::mt19937 rng(seed);
+        for (uint32_t& s : sizes)
+            s = 256 + rng() % (256u << 10);
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < pairs; ++i)
+        {
+            TlsfAllocator::Handle& slot = ring[i % window];
+            if (slot != TlsfAllocator::InvalidHandle)
+                tlsf.Free(slot);
+            slot = tlsf.Allocate(sizes[i], 256);
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        TlsfStats s = tlsf.GetStats();
+        printf("bench: %u allocate/free pairs, %u live, %.1f ns per pair, fragmentation %.3f\n",
+               pairs, window, ms * 1e6 / pairs, s.Fragmentation());
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t iterations = argc > 1 ? (uint32_t)atoi(argv[1]) : 200000;
+    uint32_t seed = argc > 2 ? (uint32_t)atoi(argv[2]) : 1;
+
+    Directed();
+    Fuzz(iterations, seed);
+    Bench(seed);
+
+    printf("%s\n", gFailures == 0 ? "passed" : "FAILED");
+    return gFailures == 0 ? 0 : 1;
+}
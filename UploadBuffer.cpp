@@ -0,0 +1,30 @@
+// UploadBuffer.cpp
+#include "UploadBuffer.h"
+
+D3D12UploadRing::D3D12UploadRing(ID3D12Device* device, UINT64 size)
+{
+    CD3DX12_HEAP_PROPERTIES uploadHeapProps(D3D12_HEAP_TYPE_UPLOAD);
+    CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Buffer(size);
+
+    ThrowIfFailed(device->CreateCommittedResource(
+        &uploadHeapProps,
+        D3D12_HEAP_FLAG_NONE,
+        &desc,
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr,
+        IID_PPV_ARGS(&mBuffer)));
+
+    // Upload heaps may stay mapped; the CPU never reads back.
+    D3D12_RANGE noRead = { 0, 0 };
+    void* mapped = nullptr;
+    ThrowIfFailed(mBuffer->Map(0, &noRead, &mapped));
+
+    UploadMemory memory = { static_cast<uint8_t*>(mapped), mBuffer->GetGPUVirtualAddress(), size };
+    mRing = std::make_unique<UploadRing>(memory);
+}
+
+D3D12UploadRing::~D3D12UploadRing()
+{
+    if (mBuffer)
+        mBuffer->Unmap(0, nullptr);
+}
@@ -0,0 +1,19 @@
+// UploadBuffer.h
+#pragma once
+#include "Common.h"
+#include "UploadRing.h"
+
+// Upload-heap buffer mapped once for its whole lifetime, sub-allocated by an UploadRing.
+class D3D12UploadRing
+{
+public:
+    D3D12UploadRing(ID3D12Device* device, UINT64 size);
+    ~D3D12UploadRing();
+
+    UploadRing&     Ring() { return *mRing; }
+    ID3D12Resource* GetResource() const { return mBuffer.Get(); }
+
+private:
+    ComPtr<ID3D12Resource>      mBuffer;
+    std::unique_ptr<UploadRing> mRing;
+};
@@ -0,0 +1,130 @@
+// UploadManager.cpp
+#include "UploadManager.h"
+#include <algorithm>
+
+UploadManager::UploadManager(ID3D12Device* device, UINT64 stagingSize)
+    : mDevice(device)
+{
+    D3D12_COMMAND_QUEUE_DESC desc = {};
+    desc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+    ThrowIfFailed(mDevice->CreateCommandQueue(&desc, IID_PPV_ARGS(&mQueue)));
+
+    mCopyQueue = std::make_unique<D3D12GpuQueue>(mDevice, mQueue.Get());
+    mStaging = std::make_unique<D3D12UploadRing>(mDevice, stagingSize);
+
+    // Large uploads go through in pieces so one asset never needs the whole
+    // ring. At least a byte, or a tiny ring would never advance the copy loop.
+    mChunkSize = (std::max)(stagingSize / 4, (UINT64)1);
+}
+
+UploadManager::~UploadManager()
+{
+    Flush();
+    mCopyQueue->WaitForValue(mLastSubmitted);
+}
+
+void UploadManager::BeginList()
+{
+    if (mRecording)
+        return;
+
+    if (!mAllocators.empty() && IsComplete(mAllocators.front().first))
+    {
+        mOpenAllocator = mAllocators.front().second;
+        mAllocators.pop_front();
+        ThrowIfFailed(mOpenAllocator->Reset());
+    }
+    else
+    {
+        mOpenAllocator.Reset();
+        ThrowIfFailed(mDevice->CreateCommandAllocator(
+            D3D12_COMMAND_LIST_TYPE_COPY,
+            IID_PPV_ARGS(&mOpenAllocator)));
+    }
+
+    if (!mCmdList)
+    {
+        ThrowIfFailed(mDevice->CreateCommandList(
+            0,
+            D3D12_COMMAND_LIST_TYPE_COPY,
+            mOpenAllocator.Get(),
+            nullptr,
+            IID_PPV_ARGS(&mCmdList)));
+    }
+    else
+    {
+        ThrowIfFailed(mCmdList->Reset(mOpenAllocator.Get(), nullptr));
+    }
+    mRecording = true;
+}
+
+UploadAllocation UploadManager::AllocateStaging(UINT64 size)
+{
+    UploadRing& ring = mStaging->Ring();
+
+    UploadAllocation a;
+    if (ring.TryAllocate(size, 4, a))
+        return a;
+
+    // Full: submit what is recorded, wait for the copies already in flight,
+    // and give their staging bytes back.
+    mStats.StagingStalls++;
+    Flush();
+    mCopyQueue->WaitForValue(mLastSubmitted);
+    Reclaim();
+    BeginList();
+    return ring.Allocate(size, 4);
+}
+
+void UploadManager::UploadBuffer(ID3D12Resource* dst, UINT64 dstOffset, const void* data, UINT64 size)
+{
+    const uint8_t* src = static_cast<const uint8_t*>(data);
+
+    while (size > 0)
+    {
+        UINT64 chunk = (std::min)(size, mChunkSize);
+
+        BeginList();
+        UploadAllocation staging = AllocateStaging(chunk);
+        memcpy(staging.Cpu, src, (size_t)chunk);
+
+        mCmdList->CopyBufferRegion(dst, dstOffset, mStaging->GetResource(), staging.Offset, chunk);
+
+        mStats.Bytes += chunk;
+        mStats.Copies++;
+
+        src += chunk;
+        dstOffset += chunk;
+        size -= chunk;
+    }
+}
+
+uint64_t UploadManager::Flush()
+{
+    if (!mRecording)
+        return 0;
+
+    ThrowIfFailed(mCmdList->Close());
+    ID3D12CommandList* lists[] = { mCmdList.Get() };
+    mQueue->ExecuteCommandLists(1, lists);
+
+    mLastSubmitted = mCopyQueue->Signal();
+    mStaging->Ring().EndBatch(mLastSubmitted);
+    mAllocators.emplace_back(mLastSubmitted, mOpenAllocator);
+    mOpenAllocator.Reset();
+
+    mRecording = false;
+    mStats.Submits++;
+    return mLastSubmitted;
+}
+
+void UploadManager::WaitOnQueue(ID3D12CommandQueue* queue, uint64_t fence) const
+{
+    if (fence != 0)
+        ThrowIfFailed(queue->Wait(mCopyQueue->GetFence(), fence));
+}
+
+void UploadManager::Reclaim()
+{
+    mStaging->Ring().Reclaim(mCopyQueue->CompletedValue());
+}
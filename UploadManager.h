@@ -0,0 +1,64 @@
+// UploadManager.h
+#pragma once
+#include "Common.h"
+#include "GpuQueue.h"
+#include "UploadBuffer.h"
+#include <deque>
+
+struct UploadStats
+{
+    uint64_t Bytes = 0;
+    uint64_t Copies = 0;
+    uint64_t Submits = 0;
+    uint64_t StagingStalls = 0; // the ring was full and the CPU waited on the copy queue
+};
+
+// Streams buffer data through a shared staging ring on its own copy queue.
+// Copies are batched into one command list until Flush, which submits them
+// and tags their staging bytes with the copy fence; the bytes are reused as
+// soon as that fence completes. Destinations must be in the COMMON state:
+// they promote to COPY_DEST on the copy queue, decay back when the copy
+// completes, and promote to their read state on first use by the graphics
+// queue, so no barriers are recorded.
+class UploadManager
+{
+public:
+    UploadManager(ID3D12Device* device, UINT64 stagingSize);
+    ~UploadManager();
+
+    void UploadBuffer(ID3D12Resource* dst, UINT64 dstOffset, const void* data, UINT64 size);
+
+    // Submits pending copies; returns their fence, or 0 when nothing was pending.
+    uint64_t Flush();
+
+    // Makes queue wait on the GPU for fence without blocking the CPU.
+    void WaitOnQueue(ID3D12CommandQueue* queue, uint64_t fence) const;
+
+    // Frees staging memory and allocators of completed submissions.
+    void Reclaim();
+
+    bool IsComplete(uint64_t fence) const { return mCopyQueue->CompletedValue() >= fence; }
+    const UploadStats& GetStats() const { return mStats; }
+
+private:
+    void BeginList();
+    UploadAllocation AllocateStaging(UINT64 size);
+
+private:
+    ID3D12Device* mDevice;
+
+    ComPtr<ID3D12CommandQueue>        mQueue;
+    std::unique_ptr<D3D12GpuQueue>    mCopyQueue;
+    ComPtr<ID3D12GraphicsCommandList> mCmdList;
+    bool     mRecording = false;
+    uint64_t mLastSubmitted = 0;
+
+    // Allocators wait here until the submission that used them completes
+    std::deque<std::pair<uint64_t, ComPtr<ID3D12CommandAllocator>>> mAllocators;
+    ComPtr<ID3D12CommandAllocator> mOpenAllocator;
+
+    std::unique_ptr<D3D12UploadRing> mStaging;
+    UINT64 mChunkSize;
+
+    UploadStats mStats;
+};
@@ -0,0 +1,46 @@
+// UploadRing.cpp
+#include "UploadRing.h"
+#include <stdexcept>
+
+UploadRing::UploadRing(const UploadMemory& memory)
+    : mMemory(memory)
+    , mRing(memory.Size)
+{
+    mStats.Capacity = memory.Size;
+}
+
+bool UploadRing::TryAllocate(uint64_t size, uint64_t alignment, UploadAllocation& out)
+{
+    const uint64_t offset = mRing.Allocate(size, alignment);
+    if (offset == RingAllocator::InvalidOffset)
+        return false;
+
+    mStats.BatchBytes += size;
+    mStats.BatchAllocations++;
+    mStats.PeakUsed = mRing.PeakUsed();
+
+    out.Cpu = mMemory.CpuBase + offset;
+    out.Gpu = mMemory.GpuBase + offset;
+    out.Offset = offset;
+    return true;
+}
+
+UploadAllocation UploadRing::Allocate(uint64_t size, uint64_t alignment)
+{
+    UploadAllocation a;
+    if (!TryAllocate(size, alignment, a))
+        throw std::runtime_error("Upload ring exhausted");
+    return a;
+}
+
+void UploadRing::EndBatch(uint64_t fence)
+{
+    mRing.EndBatch(fence);
+    mStats.BatchBytes = 0;
+    mStats.BatchAllocations = 0;
+}
+
+void UploadRing::Reclaim(uint64_t completedFence)
+{
+    mRing.Reclaim(completedFence);
+}
@@ -0,0 +1,55 @@
+// UploadRing.h
+#pragma once
+#include <cstdint>
+#include "RingAllocator.h"
+
+// Persistently mapped memory the ring sub-allocates from. For D3D12 this is
+// an upload-heap buffer; any CPU block with a made-up GPU base works too.
+struct UploadMemory
+{
+    uint8_t* CpuBase;
+    uint64_t GpuBase;
+    uint64_t Size;
+};
+
+struct UploadAllocation
+{
+    void*    Cpu;
+    uint64_t Gpu;
+    uint64_t Offset;
+};
+
+struct UploadRingStats
+{
+    uint64_t BatchBytes = 0;     // bytes handed out since the last EndBatch
+    uint64_t BatchAllocations = 0;
+    uint64_t PeakUsed = 0;
+    uint64_t Capacity = 0;
+};
+
+// Linear sub-allocation in a ring of bytes. Allocations between two
+// EndBatch calls form a batch tagged with a fence value; Reclaim frees every
+// batch whose fence has completed. Allocating is an align and a bump of the
+// head; the bookkeeping is a RingAllocator counted in bytes.
+class UploadRing
+{
+public:
+    static const uint64_t ConstantAlignment = 256; // D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT
+
+    explicit UploadRing(const UploadMemory& memory);
+
+    // Throws std::runtime_error when the in-flight batches leave no room.
+    UploadAllocation Allocate(uint64_t size, uint64_t alignment = ConstantAlignment);
+    bool TryAllocate(uint64_t size, uint64_t alignment, UploadAllocation& out);
+
+    void EndBatch(uint64_t fence);
+    void Reclaim(uint64_t completedFence);
+
+    uint64_t Used() const { return mRing.Used(); }
+    const UploadRingStats& GetStats() const { return mStats; }
+
+private:
+    UploadMemory    mMemory;
+    RingAllocator   mRing;
+    UploadRingStats mStats;
+};
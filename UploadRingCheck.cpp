@@ -0,0 +1,141 @@
+// UploadRingCheck.cpp
+// Checks for UploadRing over plain CPU memory: UploadRingCheck [frames]
+// Directed checks for alignment, wrap, retire and exhaustion, then a run of
+// frames with two in flight that fills each allocation with its frame's
+// byte pattern and verifies nothing was overwritten before its frame retired.
+// Standard library only; on Linux:
+//   g++ -O2 -std=c++17 UploadRingCheck.cpp UploadRing.cpp RingAllocator.cpp -o UploadRingCheck
+#include "UploadRing.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    int gFailures = 0;
+
+    void Check(bool ok, const char* what, long long a = 0, long long b = 0)
+    {
+        if (!ok && gFailures++ < 10)
+            printf("FAIL: %s (%lld, %lld)\n", what, a, b);
+    }
+
+    void Directed()
+    {
+        std::vector<uint8_t> memory(4096);
+        const uint64_t gpuBase = 0x100000;
+        UploadRing ring({ memory.data(), gpuBase, memory.size() });
+
+        // Constant buffers land on 256-byte boundaries; CPU and GPU addresses agree.
+        UploadAllocation a = ring.Allocate(100);
+        UploadAllocation b = ring.Allocate(100);
+        Check(a.Offset == 0 && b.Offset == 256, "constant alignment", a.Offset, b.Offset);
+        Check(b.Gpu == gpuBase + 256 && b.Cpu == memory.data() + 256, "addresses match offset", b.Gpu);
+        UploadAllocation c = ring.Allocate(8, 4);
+        Check(c.Offset == 356, "small alignment packs", c.Offset);
+        Check(ring.GetStats().BatchAllocations == 3 && ring.GetStats().BatchBytes == 208, "batch stats",
+              ring.GetStats().BatchAllocations, ring.GetStats().BatchBytes);
+
+        // Frame 1 ends at 2048.
+        ring.Allocate(2048 - 364, 4);
+        ring.EndBatch(1);
+        Check(ring.GetStats().BatchBytes == 0, "batch stats reset");
+
+        // Frame 2 fills to 3072. A 2048 request fits neither at the end nor
+        // at the start, which frame 1 still holds.
+        ring.Allocate(1024);
+        ring.EndBatch(2);
+        UploadAllocation d;
+        Check(!ring.TryAllocate(2048, 256, d), "no room while frame 1 is in flight");
+
+        bool threw = false;
+        try { ring.Allocate(2048); } catch (const std::runtime_error&) { threw = true; }
+        Check(threw, "Allocate throws when exhausted");
+
+        // Frame 1 retires: the request wraps whole to 0, and the skipped tail
+        // stays used until the frame that skipped it retires.
+        ring.Reclaim(1);
+        Check(ring.TryAllocate(2048, 256, d) && d.Offset == 0, "wraps to start", d.Offset);
+        Check(ring.Used() == 4096, "skipped tail counted", ring.Used());
+        ring.EndBatch(3);
+
+        ring.Reclaim(2);
+        Check(ring.Used() == 3072, "frame 2 retired", ring.Used());
+        ring.Reclaim(3);
+        Check(ring.Used() == 0, "all retired", ring.Used());
+        Check(ring.GetStats().PeakUsed == 4096, "peak", ring.GetStats().PeakUsed);
+    }
+
+    void Frames(uint32_t frames)
+    {
+        struct Live { uint64_t Offset, Size; uint8_t Pattern; };
+
+        std::vector<uint8_t> memory(64 << 10);
+        UploadRing ring({ memory.data(), 0, memory.size() });
+        std::deque<std::vector<Live>> inFlight;
+        std::mt19937 rng(1);
+        uint64_t allocations = 0, refused = 0;
+
+        for (uint32_t f = 1; f <= frames; ++f)
+        {
+            std::vector<Live> frame;
+            const uint8_t pattern = (uint8_t)f;
+            const uint32_t count = rng() % 64;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const uint64_t size = 1 + rng() % 1024;
+                const uint64_t alignment = 1ull << (rng() % 9);
+                UploadAllocation a;
+                if (!ring.TryAllocate(size, alignment, a))
+                {
+                    refused++;
+                    continue;
+                }
+                Check(a.Offset % alignment == 0, "aligned", a.Offset, alignment);
+                Check(a.Offset + size <= memory.size(), "in bounds", a.Offset, size);
+                memset(a.Cpu, pattern, size);
+                frame.push_back({ a.Offset, size, pattern });
+                allocations++;
+            }
+            ring.EndBatch(f);
+            inFlight.push_back(std::move(frame));
+
+            // Two frames in flight: the oldest retires once a third is queued.
+            if (inFlight.size() > 2)
+            {
+                for (const Live& l : inFlight.front())
+                {
+                    for (uint64_t i = 0; i < l.Size; ++i)
+                    {
+                        if (memory[l.Offset + i] != l.Pattern)
+                        {
+                            Check(false, "overwritten before retire", l.Offset + i, l.Pattern);
+                            break;
+                        }
+                    }
+                }
+                inFlight.pop_front();
+                ring.Reclaim(f - 2);
+            }
+        }
+
+        printf("frames: %u frames, %llu allocations, %llu refused, peak %llu of %zu bytes\n", frames,
+               (unsigned long long)allocations, (unsigned long long)refused,
+               (unsigned long long)ring.GetStats().PeakUsed, memory.size());
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t frames = argc > 1 ? (uint32_t)atoi(argv[1]) : 20000;
+
+    Directed();
+    Frames(frames);
+
+    printf("%s\n", gFailures == 0 ? "passed" : "FAILED");
+    return gFailures == 0 ? 0 : 1;
+}